@@ -279,7 +279,8 @@ name = ""
 function Funscript:hasSelection() end
 
 --- Commit the changes
--- @treturn nil
+-- Nothing is committed if two actions share a timestamp, check the result.
+-- @treturn bool false if nothing was committed
 function Funscript:commit() end
 
 --- Sort the actions array
@@ -10,15 +10,22 @@
 
 #include <map>
 #include <cmath>
+#include <cstring>
 #include <array>
+#include <charconv>
 #include <string>
 #include <vector>
 #include <limits>
 #include <utility>
 #include <algorithm>
+#include <cstddef>
 #include <string_view>
 #include <type_traits>
 
+#if defined(OFS_AVX2_ENABLED)
+#include <immintrin.h>
+#endif
+
 // FUNSCRIPT SPEC
 //{
 //	"version": "1.0",
@@ -58,6 +65,226 @@ namespace
 		.error_on_unknown_keys = false,
 		.error_on_missing_keys = true,
 	};
+
+	static inline constexpr auto METADATA_JSON_OPTS = glz::opts{
+		.format = glz::JSON,
+		.error_on_unknown_keys = false,
+		.error_on_missing_keys = false,
+	};
+
+	// Forward only JSON reader used to stream the actions array
+	// straight out of the file without building a document first.
+	struct JsonCursor
+	{
+		std::string_view json;
+		std::size_t pos = 0;
+
+		inline char peek() const noexcept { return pos < json.size() ? json[pos] : '\0'; }
+
+		inline void skipWhitespace() noexcept
+		{
+			while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\n' || json[pos] == '\r' || json[pos] == '\t')) ++pos;
+		}
+
+		inline bool consume(char c) noexcept
+		{
+			skipWhitespace();
+			if (peek() != c) return false;
+			++pos;
+			return true;
+		}
+
+		// returns the raw contents between the quotes, escape sequences are left as is
+		inline bool readString(std::string_view& out) noexcept
+		{
+			if (!consume('"')) return false;
+			auto start = pos;
+			for (;;) {
+				auto end = json.find('"', pos);
+				if (end == std::string_view::npos) return false;
+				// the quote is escaped when it follows an odd number of backslashes
+				std::size_t backslashes = 0;
+				while (end - backslashes > start && json[end - backslashes - 1] == '\\') ++backslashes;
+				pos = end + 1;
+				if ((backslashes & 1) == 0) {
+					out = json.substr(start, end - start);
+					return true;
+				}
+			}
+		}
+
+		inline bool skipValue() noexcept
+		{
+			skipWhitespace();
+			std::string_view str;
+			switch (peek()) {
+				case '"':
+					return readString(str);
+				case '{':
+				case '[': {
+					int depth = 0;
+					while (pos < json.size()) {
+						char c = json[pos];
+						if (c == '"') {
+							if (!readString(str)) return false;
+							continue;
+						}
+						else if (c == '{' || c == '[') {
+							++depth;
+						}
+						else if ((c == '}' || c == ']') && --depth == 0) {
+							++pos;
+							return true;
+						}
+						++pos;
+					}
+					return false;
+				}
+				default: {
+					// numbers, true, false and null
+					auto start = pos;
+					while (pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']'
+						&& json[pos] != ' ' && json[pos] != '\n' && json[pos] != '\r' && json[pos] != '\t') ++pos;
+					return pos != start;
+				}
+			}
+		}
+
+		// reads an integer, fractional numbers get rounded
+		inline bool readNumber(std::int64_t& out) noexcept
+		{
+			skipWhitespace();
+			const char* begin = json.data() + pos;
+			const char* end = json.data() + json.size();
+			auto [ptr, ec] = std::from_chars(begin, end, out);
+			if (ec != std::errc{} || (ptr != end && (*ptr == '.' || *ptr == 'e' || *ptr == 'E'))) {
+				double value = 0.0;
+				auto [doublePtr, doubleEc] = std::from_chars(begin, end, value);
+				if (doubleEc != std::errc{} || std::isnan(value)) return false;
+				constexpr double limit = (double)std::numeric_limits<std::int32_t>::max() * 4.0;
+				out = std::llround(std::clamp(value, -limit, limit));
+				ptr = doublePtr;
+			}
+			pos = ptr - json.data();
+			return true;
+		}
+	};
+
+	template<typename OnAction>
+	inline bool scanActions(JsonCursor& cursor, OnAction& onAction) noexcept
+	{
+		if (!cursor.consume('[')) return false;
+		cursor.skipWhitespace();
+		if (cursor.peek() == ']') {
+			++cursor.pos;
+			return true;
+		}
+
+		do {
+			if (!cursor.consume('{')) return false;
+			std::int64_t at = 0;
+			std::int64_t pos = 0;
+			bool hasAt = false;
+			bool hasPos = false;
+			cursor.skipWhitespace();
+			if (cursor.peek() != '}') {
+				do {
+					std::string_view key;
+					if (!cursor.readString(key) || !cursor.consume(':')) return false;
+					if (key == "at") {
+						if (!cursor.readNumber(at)) return false;
+						hasAt = true;
+					}
+					else if (key == "pos") {
+						if (!cursor.readNumber(pos)) return false;
+						hasPos = true;
+					}
+					else if (!cursor.skipValue()) {
+						return false;
+					}
+				} while (cursor.consume(','));
+			}
+			if (!cursor.consume('}')) return false;
+			if (hasAt && hasPos) onAction(at, pos);
+		} while (cursor.consume(','));
+
+		return cursor.consume(']');
+	}
+
+	// Streams a funscript document.
+	// onAction(at, pos) gets called for every action in file order.
+	// The metadata object and any other top level field are handed back as raw json slices.
+	template<typename OnAction>
+	inline bool scanFunscript(std::string_view json, OnAction&& onAction, 
+		std::string_view& metadataJson, std::map<std::string, std::string>& unknownFields) noexcept
+	{
+		OFS_PROFILE(__FUNCTION__);
+		JsonCursor cursor{ json };
+		if (!cursor.consume('{')) return false;
+
+		bool foundActions = false;
+		cursor.skipWhitespace();
+		if (cursor.peek() != '}') {
+			do {
+				std::string_view key;
+				if (!cursor.readString(key) || !cursor.consume(':')) return false;
+				cursor.skipWhitespace();
+				auto valueStart = cursor.pos;
+				if (key == "actions") {
+					if (!scanActions(cursor, onAction)) return false;
+					foundActions = true;
+				}
+				else {
+					if (!cursor.skipValue()) return false;
+					auto value = json.substr(valueStart, cursor.pos - valueStart);
+					if (key == "metadata")
+						metadataJson = value;
+					else
+						unknownFields.insert_or_assign(std::string(key), std::string(value));
+				}
+			} while (cursor.consume(','));
+		}
+		return cursor.consume('}') && foundActions;
+	}
+
+	// every action is an object so this is a close upper bound of the action count
+	inline std::size_t estimateActionCount(std::string_view json) noexcept
+	{
+		return std::count(json.begin(), json.end(), '{');
+	}
+
+	constexpr auto DigitPairs = [] {
+		std::array<char, 200> pairs{};
+		for (int i = 0; i < 100; ++i) {
+			pairs[i * 2] = static_cast<char>('0' + i / 10);
+			pairs[i * 2 + 1] = static_cast<char>('0' + i % 10);
+		}
+		return pairs;
+	}();
+
+	// Writes the decimal digits of value and returns the end, two digits per division.
+	// out needs room for 10 characters.
+	inline char* writeUInt(char* out, std::uint32_t value) noexcept
+	{
+		char digits[10];
+		char* end = digits + sizeof(digits);
+		char* first = end;
+		while (value >= 100) {
+			auto pair = (value % 100) * 2;
+			value /= 100;
+			*--first = DigitPairs[pair + 1];
+			*--first = DigitPairs[pair];
+		}
+		if (value >= 10) {
+			*--first = DigitPairs[value * 2 + 1];
+			*--first = DigitPairs[value * 2];
+		}
+		else {
+			*--first = static_cast<char>('0' + value);
+		}
+		std::memcpy(out, first, end - first);
+		return out + (end - first);
+	}
 }
 
 namespace OFS::util
@@ -67,12 +294,6 @@ namespace OFS::util
 	{
 		std::map<std::string_view, glz::raw_json_view> unknownFields;
 	};
-
-	struct FunscriptSerializeDummy
-	{
-		std::vector<OFS::v2::FunscriptAction> actions;
-		UnknownFieldProxy<OFS::v2::FunscriptMetadata> metadata;
-	};
 }
 
 namespace glz
@@ -81,34 +302,8 @@ namespace glz
 	{
 		template <typename T> inline constexpr auto count_members<::OFS::util::UnknownFieldProxy<T> > = [] { return count_members<T>; }();
 		template <typename T> inline constexpr auto count_members<::OFS::util::UnknownFieldProxy<T>&> = [] { return count_members<T>; }();
-
-		template <class T>
-		struct allow_missing_t
-		{
-			static constexpr bool glaze_wrapper = true;
-			static constexpr auto glaze_reflect = false;
-			T& val;
-		};
-		template <class T>
-		struct from<JSON, allow_missing_t<T>>
-		{
-			template <auto Opts>
-			GLZ_ALWAYS_INLINE static void op(auto&& value, auto&&... args)
-			{
-				read<JSON>::op<opt_false<Opts, &opts::error_on_missing_keys>>(value.val, args...);
-			}
-		};
-
-		template <auto MemPtr>
-		GLZ_ALWAYS_INLINE constexpr decltype(auto) allow_missing_impl() noexcept
-		{
-			return [](auto&& val) { return allow_missing_t<std::remove_reference_t<decltype(val.*MemPtr)>>{val.*MemPtr}; };
-		}
 	}
 
-	template <auto MemPtr>
-	constexpr auto allow_missing = detail::allow_missing_impl<MemPtr>();
-
 	template <>
 	struct meta<OFS::v2::FunscriptAction>
 	{
@@ -116,15 +311,6 @@ namespace glz
 		static constexpr auto value = object("at", &T::at, "pos", &T::pos);
 	};
 
-	template <>
-	struct meta<OFS::util::FunscriptSerializeDummy>
-	{
-		static constexpr auto value = object(
-			"actions", &::OFS::util::FunscriptSerializeDummy::actions
-		,	"metadata", allow_missing<&::OFS::util::FunscriptSerializeDummy::metadata>
-		);
-	};
-
 	template <typename T>
 	struct meta<OFS::util::UnknownFieldProxy<T>>
 	{
@@ -172,26 +358,40 @@ std::string OFS::v2::Funscript::serialize(void) const
 
 bool OFS::v2::Funscript::deserialize(std::string_view rawJson)
 {
-	OFS::util::UnknownFieldProxy<OFS::util::FunscriptSerializeDummy> proxy{};
-
-	if (auto const err = glz::read<JSON_OPTS>(proxy, rawJson); err)
-	{
-		FUN_ASSERT(false, glz::format_error(err));
+	OFS_PROFILE(__FUNCTION__);
+	std::vector<FunscriptAction> parsedActions;
+	parsedActions.reserve(estimateActionCount(rawJson));
+	std::string_view metadataJson;
+	std::map<std::string, std::string> unknownFields;
+
+	bool success = scanFunscript(rawJson, [&parsedActions](std::int64_t at, std::int64_t pos) noexcept {
+		if (at < 0) return;
+		parsedActions.push_back(FunscriptAction{
+			static_cast<std::uint32_t>(std::min<std::int64_t>(at, std::numeric_limits<std::uint32_t>::max())),
+			static_cast<std::uint8_t>(std::clamp<std::int64_t>(pos, 0, 100)) });
+	}, metadataJson, unknownFields);
+	if (!success) {
+		FUN_ASSERT(false, "Funscript deserialization failed.");
 		return false;
 	}
 
+	OFS::util::UnknownFieldProxy<FunscriptMetadata> proxy{};
+	if (!metadataJson.empty()) {
+		if (auto const err = glz::read<METADATA_JSON_OPTS>(proxy, metadataJson); err) {
+			FUN_ASSERT(false, glz::format_error(err, metadataJson));
+			return false;
+		}
+	}
+
 	// Save unknown fields
+	unknownFieldsJSON = std::move(unknownFields);
 	for (auto&& [key, value] : proxy.unknownFields)
-	{
-		unknownFieldsJSON.try_emplace(unknownFieldsJSON.end(), std::string(key), std::string(value.str));
-	}
-	for (auto&& [key, value] : proxy.metadata.unknownFields)
 	{
 		unknownMetadataFieldsJSON.try_emplace(unknownMetadataFieldsJSON.end(), std::string(key), std::string(value.str));
 	}
 
-	actions  = std::move(proxy.actions);
-	metadata = std::move(proxy.metadata);
+	actions  = std::move(parsedActions);
+	metadata = std::move(proxy);
 	return true;
 }
 
@@ -234,21 +434,235 @@ void Funscript::saveMetadata(/*nlohmann::json& outMetadataObj, */const Funscript
 	//OFS::Serializer<false>::Serialize(inMetadata, outMetadataObj);
 }
 
-void Funscript::notifyActionsChanged(bool isEdit) noexcept
+void Funscript::notifyActionsChanged(bool isEdit, std::uint32_t fromMs, std::uint32_t toMs) noexcept
 {
 	funscriptChanged = true;
+	changedFromMs = std::min(changedFromMs, fromMs);
+	changedToMs = std::max(changedToMs, toMs);
+	timeIndex.Invalidate();
+	if (fromMs == 0 && toMs == std::numeric_limits<std::uint32_t>::max()) {
+		ScriptSpline.InvalidateAll();
+		strokeIndex.InvalidateAll();
+		actionStore.InvalidateAll();
+	}
+	else {
+		ScriptSpline.Invalidate(fromMs, toMs);
+		strokeIndex.Invalidate(fromMs, toMs);
+		actionStore.Invalidate(fromMs, toMs);
+	}
 	if (isEdit && !unsavedEdits) {
 		unsavedEdits = true;
 		editTime = std::chrono::system_clock::now();
 	}
 }
 
+namespace
+{
+	struct PackedDeltaHeader
+	{
+		std::uint32_t removedCount;
+		std::uint32_t insertedCount;
+		std::uint32_t flipCount;
+	};
+
+	// Timestamps are stored as the distance to the previous action which deflates a lot better.
+	void packActions(std::vector<std::uint8_t>& out, const FunscriptArray& actions) noexcept
+	{
+		std::uint32_t previousAt = 0;
+		for (auto action : actions) {
+			auto at = action.at;
+			action.at -= previousAt;
+			previousAt = at;
+			auto offset = out.size();
+			out.resize(offset + sizeof(FunscriptAction));
+			std::memcpy(out.data() + offset, &action, sizeof(FunscriptAction));
+		}
+	}
+
+	const std::uint8_t* unpackActions(const std::uint8_t* in, std::uint32_t count, FunscriptArray& actions) noexcept
+	{
+		actions.reserve(count);
+		std::uint32_t previousAt = 0;
+		for (std::uint32_t i = 0; i < count; ++i) {
+			FunscriptAction action;
+			std::memcpy(&action, in, sizeof(FunscriptAction));
+			in += sizeof(FunscriptAction);
+			action.at += previousAt;
+			previousAt = action.at;
+			actions.emplace_back_unsorted(action);
+		}
+		return in;
+	}
+}
+
+std::vector<std::uint8_t> Funscript::FunscriptDelta::Pack() const noexcept
+{
+	PackedDeltaHeader header{ (std::uint32_t)Removed.size(), (std::uint32_t)Inserted.size(), (std::uint32_t)SelectionFlips.size() };
+	std::vector<std::uint8_t> out;
+	out.reserve(sizeof(header) 
+		+ (Removed.size() + Inserted.size()) * sizeof(FunscriptAction) 
+		+ SelectionFlips.size() * sizeof(SelectionFlips[0]));
+	out.resize(sizeof(header));
+	std::memcpy(out.data(), &header, sizeof(header));
+	packActions(out, Removed);
+	packActions(out, Inserted);
+	auto offset = out.size();
+	out.resize(offset + SelectionFlips.size() * sizeof(SelectionFlips[0]));
+	if (!SelectionFlips.empty()) {
+		std::memcpy(out.data() + offset, SelectionFlips.data(), SelectionFlips.size() * sizeof(SelectionFlips[0]));
+	}
+	return out;
+}
+
+bool Funscript::FunscriptDelta::Unpack(std::span<const std::uint8_t> in, FunscriptDelta& delta) noexcept
+{
+	PackedDeltaHeader header;
+	if (in.size() < sizeof(header)) return false;
+	std::memcpy(&header, in.data(), sizeof(header));
+	std::size_t expectedSize = sizeof(header)
+		+ ((std::size_t)header.removedCount + header.insertedCount) * sizeof(FunscriptAction)
+		+ (std::size_t)header.flipCount * sizeof(delta.SelectionFlips[0]);
+	if (in.size() != expectedSize) return false;
+
+	auto ptr = in.data() + sizeof(header);
+	ptr = unpackActions(ptr, header.removedCount, delta.Removed);
+	ptr = unpackActions(ptr, header.insertedCount, delta.Inserted);
+	delta.SelectionFlips.resize(header.flipCount);
+	if (header.flipCount > 0) {
+		std::memcpy(delta.SelectionFlips.data(), ptr, header.flipCount * sizeof(delta.SelectionFlips[0]));
+	}
+	return true;
+}
+
+Funscript::FunscriptDelta Funscript::DiffTo(const FunscriptSnapshot& target) const noexcept
+{
+	actionStore.Update(data.Actions);
+	return diff(actionStore, data.Selection, target);
+}
+
+Funscript::FunscriptDelta Funscript::Diff(const FunscriptSnapshot& from, const FunscriptSnapshot& to) noexcept
+{
+	return diff(from.Actions, from.Selection, to);
+}
+
+Funscript::FunscriptDelta Funscript::diff(const FunscriptActionStore& fromActions, const bit_set& fromSelection, const FunscriptSnapshot& target) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	const auto& current = fromActions.Blocks();
+	const auto& wanted = target.Actions.Blocks();
+
+	FunscriptDelta delta;
+	auto flip = [&delta](std::uint32_t idx) noexcept {
+		if (!delta.SelectionFlips.empty() && delta.SelectionFlips.back().second == idx) {
+			delta.SelectionFlips.back().second += 1;
+		}
+		else {
+			delta.SelectionFlips.emplace_back(idx, idx + 1);
+		}
+	};
+
+	// block index, offset into the block and index into the whole array for both sides
+	std::size_t curBlock = 0, curOffset = 0, curIdx = 0;
+	std::size_t tgtBlock = 0, tgtOffset = 0, tgtIdx = 0;
+	auto advanceCurrent = [&]() noexcept {
+		++curIdx;
+		if (++curOffset == current[curBlock]->size()) { curOffset = 0; ++curBlock; }
+	};
+	auto advanceTarget = [&]() noexcept {
+		++tgtIdx;
+		if (++tgtOffset == wanted[tgtBlock]->size()) { tgtOffset = 0; ++tgtBlock; }
+	};
+
+	while (curBlock < current.size() || tgtBlock < wanted.size()) {
+		bool hasCurrent = curBlock < current.size();
+		bool hasTarget = tgtBlock < wanted.size();
+		if (hasCurrent && hasTarget && curOffset == 0 && tgtOffset == 0 && current[curBlock] == wanted[tgtBlock]) {
+			// shared block, only the selection can differ
+			std::size_t count = current[curBlock]->size();
+			for (std::size_t i = 0; i < count; ++i) {
+				if (fromSelection.test(curIdx + i) != target.Selection.test(tgtIdx + i)) flip(tgtIdx + i);
+			}
+			curIdx += count; tgtIdx += count;
+			++curBlock; ++tgtBlock;
+			continue;
+		}
+
+		auto currentAction = hasCurrent ? (*current[curBlock])[curOffset] : FunscriptAction();
+		auto targetAction = hasTarget ? (*wanted[tgtBlock])[tgtOffset] : FunscriptAction();
+		if (!hasTarget || (hasCurrent && currentAction.at < targetAction.at)) {
+			delta.Removed.emplace_back_unsorted(currentAction);
+			advanceCurrent();
+		}
+		else if (!hasCurrent || targetAction.at < currentAction.at) {
+			delta.Inserted.emplace_back_unsorted(targetAction);
+			if (target.Selection.test(tgtIdx)) flip(tgtIdx);
+			advanceTarget();
+		}
+		else {
+			bool changed = currentAction != targetAction
+				|| currentAction.tag != targetAction.tag
+				|| currentAction.flags != targetAction.flags;
+			if (changed) {
+				// inserts come in unselected
+				delta.Inserted.emplace_back_unsorted(targetAction);
+				if (target.Selection.test(tgtIdx)) flip(tgtIdx);
+			}
+			else if (fromSelection.test(curIdx) != target.Selection.test(tgtIdx)) {
+				flip(tgtIdx);
+			}
+			advanceCurrent();
+			advanceTarget();
+		}
+	}
+
+	delta.Removed.shrink_to_fit();
+	delta.Inserted.shrink_to_fit();
+	delta.SelectionFlips.shrink_to_fit();
+	return delta;
+}
+
+void Funscript::ApplyDelta(const FunscriptDelta& delta) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	// Deltas of position edits only replace existing actions, those are patched in place.
+	// Just like the batch below changed actions come in unselected before the flips.
+	bool inPlace = delta.Removed.empty() && std::all_of(delta.Inserted.begin(), delta.Inserted.end(),
+		[this](FunscriptAction action) noexcept { return GetActionAtMs(action.at) != nullptr; });
+	if (inPlace) {
+		for (auto action : delta.Inserted) {
+			auto idx = timeIndex.LowerBound(data.Actions, action.at);
+			data.Actions[idx] = action;
+			if (data.Selection.test(idx)) {
+				data.Selection.reset(idx);
+				notifySelectionChanged();
+			}
+		}
+		if (!delta.Inserted.empty()) {
+			notifyActionsChanged(true, delta.Inserted.front().at, delta.Inserted.back().at);
+		}
+	}
+	else {
+		EditBatch batch(*this);
+		batch.Reserve(delta.Inserted.size(), delta.Removed.size());
+		for (auto action : delta.Removed) batch.Remove(action);
+		for (auto action : delta.Inserted) batch.Add(action);
+	}
+
+	for (auto [first, last] : delta.SelectionFlips) {
+		FUN_ASSERT(last <= data.Selection.size(), "selection flip out of bounds");
+		data.Selection.flip(first, last);
+	}
+	if (!delta.SelectionFlips.empty()) notifySelectionChanged();
+}
+
 void Funscript::Update() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
 	if (funscriptChanged) {
 		funscriptChanged = false;
-		EV::Enqueue<FunscriptActionsChangedEvent>(this);
+		EV::Enqueue<FunscriptActionsChangedEvent>(this, changedFromMs, changedToMs);
+		changedFromMs = std::numeric_limits<std::uint32_t>::max();
+		changedToMs = 0;
 	}
 	if (selectionChanged) {
 		selectionChanged = false;
@@ -256,49 +670,118 @@ void Funscript::Update() noexcept
 	}
 }
 
-float Funscript::GetPositionAtTime(float time) const noexcept
+namespace
 {
-	OFS_PROFILE(__FUNCTION__);
-	if (data.Actions.size() == 0) {	return 0; } 
-	else if (data.Actions.size() == 1) return data.Actions[0].pos;
+	// Interpolation inputs for a chunk of samples laid out for vector loads.
+	struct SampleChunk
+	{
+		static constexpr std::size_t Size = 64;
+		alignas(32) float p0[Size];
+		alignas(32) float dp[Size];
+		alignas(32) float dt[Size];
+		alignas(32) float duration[Size];
+	};
 
-	int i = 0;
-	auto it = data.Actions.lower_bound(FunscriptAction(time, 0));
-	if (it != data.Actions.end()) {
-		i = std::distance(data.Actions.begin(), it);
-		if (i > 0) --i;
+	// Walks the sorted times and the actions together.
+	// Returns the action index to continue from with the next chunk.
+	inline std::size_t findSampleSegments(const FunscriptArray& actions, std::size_t actionIdx, 
+		std::span<const float> times, SampleChunk& chunk) noexcept
+	{
+		const auto lastIdx = actions.size() - 1;
+		for (std::size_t i = 0; i < times.size(); ++i) {
+			const double timeMs = times[i] * 1000.0;
+			while (actionIdx < lastIdx && actions[actionIdx + 1].at <= timeMs) ++actionIdx;
+
+			auto a0 = actions[actionIdx];
+			chunk.p0[i] = a0.pos;
+			if (timeMs <= a0.at || actionIdx == lastIdx) {
+				// before the first action, exactly on an action or after the last action
+				chunk.dp[i] = 0.f;
+				chunk.dt[i] = 0.f;
+				chunk.duration[i] = 1.f;
+			}
+			else {
+				auto a1 = actions[actionIdx + 1];
+				chunk.dp[i] = (float)a1.pos - (float)a0.pos;
+				chunk.dt[i] = static_cast<float>(timeMs - a0.at);
+				chunk.duration[i] = static_cast<float>(a1.at - a0.at);
+			}
+		}
+		return actionIdx;
 	}
 
-	for (; i < data.Actions.size()-1; i++) {
-		auto& action = data.Actions[i];
-		auto& next = data.Actions[i + 1];
-
-		if (time > action.atS && time < next.atS) {
-			// interpolate position
-			int32_t lastPos = action.pos;
-			float diff = next.pos - action.pos;
-			float progress = (float)(time - action.atS) / (next.atS - action.atS);
-			
-			float interp = lastPos + (progress * (float)diff);
-			return interp;
+	inline void interpolateScalar(const SampleChunk& chunk, std::size_t from, std::size_t to, float* out) noexcept
+	{
+		for (std::size_t i = from; i < to; ++i) {
+			float progress = std::clamp(chunk.dt[i] / chunk.duration[i], 0.f, 1.f);
+			out[i] = chunk.p0[i] + chunk.dp[i] * progress;
 		}
-		else if (action.atS == time) {
-			return action.pos;
+	}
+
+#if defined(OFS_AVX2_ENABLED)
+	// Interpolates 8 samples at a time. Returns the first index which wasn't processed.
+	inline std::size_t interpolateAVX2(const SampleChunk& chunk, std::size_t count, float* out) noexcept
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.f);
+		std::size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 progress = _mm256_div_ps(_mm256_load_ps(chunk.dt + i), _mm256_load_ps(chunk.duration + i));
+			progress = _mm256_min_ps(_mm256_max_ps(progress, zero), one);
+			__m256 pos = _mm256_fmadd_ps(_mm256_load_ps(chunk.dp + i), progress, _mm256_load_ps(chunk.p0 + i));
+			_mm256_storeu_ps(out + i, pos);
 		}
+		return i;
+	}
+#endif
+}
+
+float Funscript::GetPositionAtTime(float time) const noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	float pos = 0.f;
+	SamplePositions(std::span<const float>(&time, 1), std::span<float>(&pos, 1));
+	return pos;
+}
+
+void Funscript::SamplePositions(std::span<const float> times, std::span<float> out) const noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	FUN_ASSERT(out.size() >= times.size(), "output span is too small");
+	if (data.Actions.empty()) {
+		std::fill_n(out.begin(), times.size(), 0.f);
+		return;
+	}
+
+	// start the walk at the first relevant action instead of the beginning
+	std::size_t actionIdx = 0;
+	if (!times.empty()) {
+		auto it = data.Actions.lower_bound(FunscriptAction::FromMs(FunscriptAction::ToMs(times.front()), 0));
+		actionIdx = it != data.Actions.begin() ? std::distance(data.Actions.begin(), it) - 1 : 0;
 	}
 
-	return data.Actions.back().pos;
+	SampleChunk chunk;
+	for (std::size_t offset = 0; offset < times.size(); offset += SampleChunk::Size) {
+		auto count = std::min(SampleChunk::Size, times.size() - offset);
+		actionIdx = findSampleSegments(data.Actions, actionIdx, times.subspan(offset, count), chunk);
+
+		std::size_t i = 0;
+#if defined(OFS_AVX2_ENABLED)
+		i = interpolateAVX2(chunk, count, out.data() + offset);
+#endif
+		interpolateScalar(chunk, i, count, out.data() + offset);
+	}
 }
 
 void Funscript::AddMultipleActions(const FunscriptArray& actions) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
+	EditBatch batch(*this);
+	batch.Reserve(actions.size(), 0);
 	for(auto& action : actions)
 	{
-		data.Actions.emplace(action);
+		batch.Add(action);
 	}
-	sortActions(data.Actions);
-	notifyActionsChanged(true);
 }
 
 
@@ -308,121 +791,93 @@ bool Funscript::EditAction(FunscriptAction oldAction, FunscriptAction newAction)
 	// update action
 	auto act = getAction(oldAction);
 	if (act != nullptr) {
-		act->atS = newAction.atS;
-		act->pos = newAction.pos;
-		checkForInvalidatedActions();
-		notifyActionsChanged(true);
-		sortActions(data.Actions);
-		return true;
+		EditBatch batch(*this);
+		batch.Move(*act, newAction, IsSelected(*act));
+		return batch.Commit() == 0;
 	}
 	return false;
 }
 
+void Funscript::addAction(FunscriptAction newAction) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	auto it = data.Actions.lower_bound(newAction);
+	if (it != data.Actions.end() && !(newAction < *it)) return;
+	auto idx = std::distance(data.Actions.begin(), it);
+	data.Actions.insert(it, newAction);
+	data.Selection.insert(idx, false);
+	notifyActionsChanged(true, newAction.at, newAction.at);
+}
+
 void Funscript::AddEditAction(FunscriptAction action, float frameTime) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	auto close = getActionAtTime(data.Actions, action.atS, frameTime);
+	auto close = getActionAtTime(action.atS(), frameTime);
 	if (close != nullptr) {
+		if (*close != action) {
+			// the edited action is no longer the one which was selected
+			data.Selection.reset(std::distance(data.Actions.data(), close));
+			notifySelectionChanged();
+		}
+		auto fromMs = std::min(close->at, action.at);
+		auto toMs = std::max(close->at, action.at);
 		*close = action;
-		notifyActionsChanged(true);
-		checkForInvalidatedActions();
+		notifyActionsChanged(true, fromMs, toMs);
 	}
 	else {
 		AddAction(action);
 	}
 }
 
-void Funscript::checkForInvalidatedActions() noexcept
-{
-	OFS_PROFILE(__FUNCTION__);
-	auto it = std::remove_if(data.Selection.begin(), data.Selection.end(), 
-		[this](auto selected) {
-			auto found = getAction(selected);
-			return !found;
-		});
-		
-	if (it != data.Selection.end()) {
-		data.Selection.erase(it, data.Selection.end());
-		notifySelectionChanged();
-	}
-}
-
-void Funscript::RemoveAction(FunscriptAction action, bool checkInvalidSelection) noexcept
+void Funscript::RemoveAction(FunscriptAction action) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
 	auto it = data.Actions.find(action);
 	if (it != data.Actions.end()) {
+		auto idx = std::distance(data.Actions.begin(), it);
+		if (data.Selection.test(idx)) notifySelectionChanged();
 		data.Actions.erase(it);
-		notifyActionsChanged(true);
-
-		if (checkInvalidSelection) { checkForInvalidatedActions(); }
+		data.Selection.erase(idx);
+		notifyActionsChanged(true, action.at, action.at);
 	}
 }
 
 void Funscript::RemoveActions(const FunscriptArray& removeActions) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	auto it = std::remove_if(data.Actions.begin(), data.Actions.end(),
-		[&removeActions, end = removeActions.end()](auto action) {
-			if (removeActions.find(action) != end) {
-				return true;
-			}
-			return false;
-		});
-	data.Actions.erase(it, data.Actions.end());
+	bit_set remove(data.Actions.size());
+	data.Actions.for_each_match(removeActions.begin(), removeActions.end(), 
+		[&remove](std::size_t idx) noexcept { remove.set(idx); });
+	if (remove.none()) return;
 
-	notifyActionsChanged(true);
-	checkForInvalidatedActions();
+	std::size_t idx = 0;
+	removeActionsIf([&remove, &idx](auto) { return remove.test(idx++); });
 }
 
 std::vector<FunscriptAction> Funscript::GetLastStroke(float time) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	// TODO: refactor...
-	// assuming "*it" is a peak bottom or peak top
-	// if you went up it would return a down stroke and if you went down it would return a up stroke
-	auto it = std::min_element(data.Actions.begin(), data.Actions.end(),
-		[time](auto a, auto b) {
-			return std::abs(a.atS - time) < std::abs(b.atS - time);
-		});
-	if (it == data.Actions.end() || it-1 == data.Actions.begin()) return std::vector<FunscriptAction>(0);
-
-	std::vector<FunscriptAction> stroke;
-	stroke.reserve(5);
-
-	// search previous stroke
-	bool goingUp = (it - 1)->pos > it->pos;
-	int32_t prevPos = (it-1)->pos;
-	for (auto searchIt = it-1; searchIt != data.Actions.begin(); searchIt--) {
-		if ((searchIt - 1)->pos > prevPos != goingUp) {
-			break;
-		}
-		else if ((searchIt - 1)->pos == prevPos && (searchIt-1)->pos != searchIt->pos) {
-			break;
-		}
-		prevPos = (searchIt - 1)->pos;
-		it = searchIt;
-	}
+	if (data.Actions.empty()) return std::vector<FunscriptAction>(0);
 
-	it--;
-	if (it == data.Actions.begin()) return std::vector<FunscriptAction>(0);
-	goingUp = !goingUp;
-	prevPos = it->pos;
-	stroke.emplace_back(*it);
-	it--;
-	for (;; it--) {
-		bool up = it->pos > prevPos;
-		if (up != goingUp) {
-			break;
-		}
-		else if (it->pos == prevPos) {
-			break;
-		}
-		stroke.emplace_back(*it);
-		prevPos = it->pos;
-		if (it == data.Actions.begin()) break;
+	const std::int64_t timeMs = FunscriptAction::ToMs(time);
+	auto closest = data.Actions.lower_bound(FunscriptAction::FromMs(timeMs, 0));
+	if (closest == data.Actions.end() 
+		|| (closest != data.Actions.begin() && timeMs - (closest - 1)->at <= (std::int64_t)closest->at - timeMs)) {
+		--closest;
 	}
-	return stroke;
+
+	auto& strokes = Strokes();
+	// holds are treated as part of the stroke before them
+	auto current = strokes.StrokeAt(closest->at);
+	while (current && current->IsHold()) current = strokes.PreviousStroke(*current);
+	if (!current) return std::vector<FunscriptAction>(0);
+	auto previous = strokes.PreviousStroke(*current);
+	while (previous && previous->IsHold()) previous = strokes.PreviousStroke(*previous);
+	if (!previous) return std::vector<FunscriptAction>(0);
+
+	auto first = data.Actions.lower_bound(FunscriptAction::FromMs(previous->fromMs, 0));
+	auto last = data.Actions.upper_bound(FunscriptAction::FromMs(previous->toMs, 0));
+	return std::vector<FunscriptAction>(std::make_reverse_iterator(last), std::make_reverse_iterator(first));
 }
 
 void Funscript::SetActions(const FunscriptArray& override_with) noexcept
@@ -432,20 +887,26 @@ void Funscript::SetActions(const FunscriptArray& override_with) noexcept
 	//data.Actions.assign(override_with.begin(), override_with.end());
 	//sortActions(data.Actions);
 	data.Actions = override_with;
+	data.Selection.assign(data.Actions.size(), false);
 	notifyActionsChanged(true);
+	notifySelectionChanged();
 }
 
 void Funscript::RemoveActionsInInterval(float fromTime, float toTime) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	data.Actions.erase(
-		std::remove_if(data.Actions.begin(), data.Actions.end(),
-			[fromTime, toTime](auto action) {
-				return action.atS >= fromTime && action.atS <= toTime;
-			}), data.Actions.end()
-	);
-	checkForInvalidatedActions();
-	notifyActionsChanged(true);
+	auto first = data.Actions.lower_bound(FunscriptAction(fromTime, 0));
+	auto last = data.Actions.upper_bound(FunscriptAction(toTime, 0));
+	if (first >= last) return;
+
+	auto firstIdx = std::distance(data.Actions.begin(), first);
+	auto lastIdx = std::distance(data.Actions.begin(), last);
+	auto fromMs = first->at;
+	auto toMs = (last - 1)->at;
+	data.Actions.erase(first, last);
+	data.Selection.erase(firstIdx, lastIdx);
+	notifyActionsChanged(true, fromMs, toMs);
+	notifySelectionChanged();
 }
 
 void Funscript::RangeExtendSelection(int32_t rangeExtend) noexcept
@@ -523,106 +984,118 @@ void Funscript::RangeExtendSelection(int32_t rangeExtend) noexcept
 	};
 	std::vector<FunscriptAction*> rangeExtendSelection;
 	rangeExtendSelection.reserve(SelectionSize());
-	int selectionOffset = 0;
-	for (auto&& act : data.Actions) {
-		for (int i = selectionOffset; i < data.Selection.size(); i++) {
-			if (data.Selection[i] == act) {
-				rangeExtendSelection.push_back(&act);
-				selectionOffset = i;
-				break;
-			}
-		}
-	}
+	data.Selection.forEachSet([this, &rangeExtendSelection](std::size_t idx) noexcept {
+		rangeExtendSelection.push_back(&data.Actions[idx]);
+	});
 	if (rangeExtendSelection.size() == 0) { return; }
+	auto fromMs = rangeExtendSelection.front()->at;
+	auto toMs = rangeExtendSelection.back()->at;
 	ClearSelection();
 	ExtendRange(rangeExtendSelection, rangeExtend);
+	notifyActionsChanged(true, fromMs, toMs);
 }
 
 bool Funscript::ToggleSelection(FunscriptAction action) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	auto it = data.Selection.find(action);
-	bool isSelected = it != data.Selection.end();
-	if (isSelected) {
-		data.Selection.erase(it);
-	}
-	else {
-		data.Selection.emplace(action);
-	}
+	auto idx = actionIndex(action);
+	if (idx == bit_set::npos) return false;
+	data.Selection.flip(idx);
 	notifySelectionChanged();
-	return !isSelected;
+	return data.Selection.test(idx);
 }
 
 void Funscript::SetSelected(FunscriptAction action, bool selected) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	auto it = data.Selection.find(action); 
-	bool isSelected = it != data.Selection.end();
-	if(isSelected && !selected) {
-		data.Selection.erase(it);
+	auto idx = actionIndex(action);
+	if (idx == bit_set::npos) return;
+	data.Selection.set(idx, selected);
+	notifySelectionChanged();
+}
+
+bit_set Funscript::selectionExtremaMask(bool top) const noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	// looks at each selected action together with its selected neighbours
+	// and marks the one or two which aren't part of the wanted extreme
+	bit_set mask(data.Actions.size());
+	auto prevIdx = data.Selection.findFirst();
+	auto currentIdx = prevIdx != bit_set::npos ? data.Selection.findNext(prevIdx + 1) : bit_set::npos;
+	auto nextIdx = currentIdx != bit_set::npos ? data.Selection.findNext(currentIdx + 1) : bit_set::npos;
+	while (nextIdx != bit_set::npos) {
+		auto prev = data.Actions[prevIdx];
+		auto current = data.Actions[currentIdx];
+		auto next = data.Actions[nextIdx];
+
+		std::size_t idx1, idx2;
+		if (top) {
+			idx1 = prev.pos < current.pos ? prevIdx : currentIdx;
+			idx2 = data.Actions[idx1].pos < next.pos ? idx1 : nextIdx;
+		}
+		else {
+			idx1 = prev.pos > current.pos ? prevIdx : currentIdx;
+			idx2 = data.Actions[idx1].pos > next.pos ? idx1 : nextIdx;
+		}
+		mask.set(idx1);
+		mask.set(idx2);
+
+		prevIdx = currentIdx;
+		currentIdx = nextIdx;
+		nextIdx = data.Selection.findNext(nextIdx + 1);
 	}
-	else if(!isSelected && selected) {
-		data.Selection.emplace(action);
+	return mask;
+}
+
+bool Funscript::filterSelectionByExtremum(bool keepPeaks, bool keepValleys, bool keepOthers) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	auto firstIdx = data.Selection.findFirst();
+	auto lastIdx = data.Selection.findLast();
+	if (firstIdx == bit_set::npos || SelectionSize() != lastIdx - firstIdx + 1) return false;
+
+	// the turning points are looked up in the stroke index instead of walking the selection
+	using ExtremumType = FunscriptStrokeIndex::ExtremumType;
+	auto extrema = Strokes().ExtremaInRange(data.Actions[firstIdx].at, data.Actions[lastIdx].at);
+	data.Selection.set(firstIdx, lastIdx + 1, keepOthers);
+	auto it = data.Actions.begin() + firstIdx;
+	for (auto& extremum : extrema) {
+		it = std::lower_bound(it, data.Actions.end(), FunscriptAction::FromMs(extremum.at, 0));
+		bool keep = extremum.type == ExtremumType::Peak ? keepPeaks
+			: extremum.type == ExtremumType::Valley ? keepValleys
+			: keepOthers;
+		data.Selection.set(std::distance(data.Actions.begin(), it), keep);
 	}
-	notifySelectionChanged();
+	return true;
 }
 
 void Funscript::SelectTopActions() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	if (data.Selection.size() < 3) return;
-	std::vector<FunscriptAction> deselect;
-	for (int i = 1; i < data.Selection.size() - 1; i++) {
-		auto& prev = data.Selection[i - 1];
-		auto& current = data.Selection[i];
-		auto& next = data.Selection[i + 1];
-
-		auto& min1 = prev.pos < current.pos ? prev : current;
-		auto& min2 = min1.pos < next.pos ? min1 : next;
-		deselect.emplace_back(min1);
-		if (min1.atS != min2.atS) deselect.emplace_back(min2);
-	}
-	for (auto& act : deselect) SetSelected(act, false);
+	if (SelectionSize() < 3) return;
+	if (!filterSelectionByExtremum(true, false, false))
+		data.Selection.subtract(selectionExtremaMask(true));
 	notifySelectionChanged();
 }
 
 void Funscript::SelectBottomActions() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	if (data.Selection.size() < 3) return;
-	std::vector<FunscriptAction> deselect;
-	for (int i = 1; i < data.Selection.size() - 1; i++) {
-		auto& prev = data.Selection[i - 1];
-		auto& current = data.Selection[i];
-		auto& next = data.Selection[i + 1];
-
-		auto& max1 = prev.pos > current.pos ? prev : current;
-		auto& max2 = max1.pos > next.pos ? max1 : next;
-		deselect.emplace_back(max1);
-		if (max1.atS != max2.atS) deselect.emplace_back(max2);
-	}
-	for (auto& act : deselect) SetSelected(act, false);
+	if (SelectionSize() < 3) return;
+	if (!filterSelectionByExtremum(false, true, false))
+		data.Selection.subtract(selectionExtremaMask(false));
 	notifySelectionChanged();
 }
 
 void Funscript::SelectMidActions() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	if (data.Selection.size() < 3) return;
-	auto selectionCopy = data.Selection;
-	SelectTopActions();
-	auto topPoints = data.Selection;
-	data.Selection = selectionCopy;
-	SelectBottomActions();
-	auto bottomPoints = data.Selection;
-	
-	selectionCopy.erase(std::remove_if(selectionCopy.begin(), selectionCopy.end(),
-		[&topPoints, &bottomPoints](auto val) {
-			return std::any_of(topPoints.begin(), topPoints.end(), [val](auto a) { return a == val; })
-				|| std::any_of(bottomPoints.begin(), bottomPoints.end(), [val](auto a) { return a == val; });
-		}), selectionCopy.end());
-	data.Selection = selectionCopy;
-	sortSelection();
+	if (SelectionSize() < 3) return;
+	if (!filterSelectionByExtremum(false, false, true)) {
+		// mid actions are the ones which would be deselected by both top and bottom
+		data.Selection &= selectionExtremaMask(true);
+		data.Selection &= selectionExtremaMask(false);
+	}
 	notifySelectionChanged();
 }
 
@@ -630,18 +1103,16 @@ void Funscript::SelectTime(float fromTime, float toTime, bool clear) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
 	if(clear)
-		ClearSelection();
-
-	for (auto& action : data.Actions) {
-		if (action.atS >= fromTime && action.atS <= toTime) {
-			ToggleSelection(action);
-		}
-		else if (action.atS > toTime)
-			break;
-	}
-
-	if (!clear)
-		sortSelection();
+		data.Selection.resetAll();
+
+	auto first = data.Actions.lower_bound(FunscriptAction(fromTime, 0));
+	auto last = std::max(first, data.Actions.upper_bound(FunscriptAction(toTime, 0)));
+	auto firstIdx = std::distance(data.Actions.begin(), first);
+	auto lastIdx = std::distance(data.Actions.begin(), last);
+	if (clear) 
+		data.Selection.set(firstIdx, lastIdx, true);
+	else
+		data.Selection.flip(firstIdx, lastIdx);
 	notifySelectionChanged();
 }
 
@@ -651,12 +1122,7 @@ FunscriptArray Funscript::GetSelection(float fromTime, float toTime) noexcept
 	if (!data.Actions.empty()) {
 		auto start = data.Actions.lower_bound(FunscriptAction(fromTime, 0));
 		auto end = data.Actions.upper_bound(FunscriptAction(toTime, 0));
-		for (; start != end; ++start) {
-			auto action = *start;
-			if (action.atS >= fromTime && action.atS <= toTime) {
-				selection.emplace_back_unsorted(action);
-			}
-		}
+		if (start < end) selection.assign(start, end);
 	}
 	return selection;
 }
@@ -664,67 +1130,47 @@ FunscriptArray Funscript::GetSelection(float fromTime, float toTime) noexcept
 void Funscript::SelectAction(FunscriptAction select) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	auto action = GetAction(select);
-	if (action != nullptr) {
-		if (ToggleSelection(select)) {
-			// keep selection ordered for rendering purposes
-			sortSelection();
-		}
-		notifySelectionChanged();
-	}
+	ToggleSelection(select);
 }
 
 void Funscript::DeselectAction(FunscriptAction deselect) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	auto action = GetAction(deselect);
-	if (action != nullptr)
-		SetSelected(*action, false);
-	notifySelectionChanged();
+	SetSelected(deselect, false);
 }
 
 void Funscript::SelectAll() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	ClearSelection();
-	data.Selection.assign(data.Actions.begin(), data.Actions.end());
+	data.Selection.setAll();
 	notifySelectionChanged();
 }
 
 void Funscript::RemoveSelectedActions() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	if (data.Selection.size() == data.Actions.size()) {
-		// assume data.selection == data.Actions
-		// aslong as we don't fuck up the selection this is safe 
+	if (data.Selection.all()) {
 		data.Actions.clear();
+		data.Selection.clear();
+		notifyActionsChanged(true);
+		notifySelectionChanged();
 	}
 	else {
-		RemoveActions(data.Selection);
+		std::size_t idx = 0;
+		removeActionsIf([this, &idx](auto) { return data.Selection.test(idx++); });
+		data.Selection.resetAll();
 	}
-
-	ClearSelection();
-	notifyActionsChanged(true);
-	notifySelectionChanged();
 }
 
 void Funscript::moveAllActionsTime(float timeOffset)
 {
 	OFS_PROFILE(__FUNCTION__);
-	ClearSelection();
+	if (data.Actions.empty()) return;
+	// clamped once so the order and spacing of the actions is kept
+	const std::int64_t offsetMs = std::clamp<std::int64_t>(std::llround(timeOffset * 1000.0),
+		-(std::int64_t)data.Actions.front().at, (std::int64_t)FunscriptAction::MaxTimeMs - data.Actions.back().at);
 	for (auto& move : data.Actions) {
-		move.atS += timeOffset;
-	}
-	notifyActionsChanged(true);
-}
-
-void Funscript::moveActionsPosition(std::vector<FunscriptAction*> moving, int32_t posOffset)
-{
-	OFS_PROFILE(__FUNCTION__);
-	ClearSelection();
-	for (auto move : moving) {
-		move->pos += posOffset;
-		move->pos = Util::Clamp<int16_t>(move->pos, 0, 100);
+		move.at = (std::uint32_t)(move.at + offsetMs);
 	}
 	notifyActionsChanged(true);
 }
@@ -735,131 +1181,325 @@ void Funscript::MoveSelectionTime(float timeOffset, float frameTime) noexcept
 	if (!HasSelection()) return;
 
 	// faster path when everything is selected
-	if (data.Selection.size() == data.Actions.size()) {
+	if (data.Selection.all()) {
 		moveAllActionsTime(timeOffset);
-		SelectAll();
 		return;
 	}
 
-	auto prev = GetPreviousActionBehind(data.Selection.front().atS);
-	auto next = GetNextActionAhead(data.Selection.back().atS);
+	auto firstIdx = data.Selection.findFirst();
+	auto lastIdx = data.Selection.findLast();
+	auto first = data.Actions[firstIdx];
+	auto last = data.Actions[lastIdx];
 
-	auto min_bound = 0.f;
-	auto max_bound = std::numeric_limits<float>::max();
+	std::int64_t offsetMs = std::llround(timeOffset * 1000.0);
+	const std::int64_t frameMs = std::llround(frameTime * 1000.0);
 
-	if (timeOffset > 0) {
-		if (next != nullptr) {
-			max_bound = next->atS - frameTime;
-			timeOffset = std::min(timeOffset, max_bound - data.Selection.back().atS);
+	if (offsetMs > 0) {
+		if (lastIdx + 1 < data.Actions.size()) {
+			std::int64_t maxBound = (std::int64_t)data.Actions[lastIdx + 1].at - frameMs;
+			offsetMs = std::min(offsetMs, maxBound - (std::int64_t)last.at);
 		}
 	}
 	else {
-		if (prev != nullptr) {
-			min_bound = prev->atS + frameTime;
-			timeOffset = std::max(timeOffset, min_bound - data.Selection.front().atS);
+		if (firstIdx > 0) {
+			std::int64_t minBound = (std::int64_t)data.Actions[firstIdx - 1].at + frameMs;
+			offsetMs = std::max(offsetMs, minBound - (std::int64_t)first.at);
 		}
 	}
-
-	FunscriptArray newSelection;
-	newSelection.reserve(data.Selection.size());
-	for (auto selected : data.Selection) {
-		auto move = getAction(selected);
-		if (move) {
-			FunscriptAction newAction = *move;
-			newAction.atS += timeOffset;
-			newSelection.emplace(newAction);
-			RemoveAction(*move, false);
-			AddAction(newAction);
-		}
-	}
-	ClearSelection();
-	data.Selection = std::move(newSelection);
-	notifyActionsChanged(true);
+	// clamping every action on its own would stack them at the ends of the valid range
+	offsetMs = std::clamp<std::int64_t>(offsetMs, -(std::int64_t)first.at, (std::int64_t)FunscriptAction::MaxTimeMs - last.at);
+
+	auto selectionSize = SelectionSize();
+	EditBatch batch(*this);
+	batch.Reserve(selectionSize, selectionSize);
+	data.Selection.forEachSet([this, &batch, offsetMs](std::size_t idx) noexcept {
+		FunscriptAction newAction = data.Actions[idx];
+		newAction.at = (std::uint32_t)(newAction.at + offsetMs);
+		batch.Move(data.Actions[idx], newAction, true);
+	});
 }
 
 void Funscript::MoveSelectionPosition(int32_t pos_offset) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
 	if (!HasSelection()) return;
-	std::vector<FunscriptAction*> moving;
-	
-	// faster path when everything is selected
-	if (data.Selection.size() == data.Actions.size()) {
-		for (auto& action : data.Actions)
-			moving.push_back(&action);
-		moveActionsPosition(moving, pos_offset);
-		SelectAll();
-		return;
-	}
-
-	for (auto& find : data.Selection) {
-		auto m = getAction(find);
-		if (m != nullptr)
-			moving.push_back(m);
-	}
-
-	ClearSelection();
-	for (auto move : moving) {
-		move->pos += pos_offset;
-		move->pos = Util::Clamp<int16_t>(move->pos, 0, 100);
-		data.Selection.emplace_back_unsorted(*move);
-	}
-	sortSelection();
-	notifyActionsChanged(true);
+	// positions don't affect the order so the selection stays valid
+	data.Selection.forEachSet([this, pos_offset](std::size_t idx) noexcept {
+		auto& move = data.Actions[idx];
+		move.pos = Util::Clamp<int32_t>(move.pos + pos_offset, 0, 100);
+	});
+	notifyActionsChanged(true, FirstSelected()->at, LastSelected()->at);
 }
 
 void Funscript::SetSelection(const FunscriptArray& actionsToSelect) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	ClearSelection();
-	for(auto& action : actionsToSelect) {
-		data.Selection.emplace(action);
-	}
+	data.Selection.resetAll();
+	data.Actions.for_each_match(actionsToSelect.begin(), actionsToSelect.end(),
+		[this](std::size_t idx) noexcept { data.Selection.set(idx); });
 	notifySelectionChanged();
 }
 
-bool Funscript::IsSelected(FunscriptAction action) noexcept
+bool Funscript::IsSelected(FunscriptAction action) const noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	auto idx = actionIndex(action);
+	return idx != bit_set::npos && data.Selection.test(idx);
+}
+
+FunscriptArray Funscript::SelectedActions() const noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	auto it = data.Selection.find(action);
-	return it != data.Selection.end();
+	FunscriptArray selection;
+	selection.reserve(SelectionSize());
+	data.Selection.forEachSet([this, &selection](std::size_t idx) noexcept {
+		selection.emplace_back_unsorted(data.Actions[idx]);
+	});
+	return selection;
+}
+
+const FunscriptAction* Funscript::GetClosestActionSelection(float time) const noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	if (!HasSelection()) return nullptr;
+	auto idx = std::distance(data.Actions.begin(), data.Actions.lower_bound(FunscriptAction(time, 0)));
+	auto nextIdx = data.Selection.findNext(idx);
+	auto prevIdx = idx > 0 ? data.Selection.findPrev(idx - 1) : bit_set::npos;
+	if (nextIdx == bit_set::npos) return &data.Actions[prevIdx];
+	if (prevIdx == bit_set::npos) return &data.Actions[nextIdx];
+	const std::int64_t timeMs = FunscriptAction::ToMs(time);
+	return std::abs((std::int64_t)data.Actions[prevIdx].at - timeMs) < std::abs((std::int64_t)data.Actions[nextIdx].at - timeMs)
+		? &data.Actions[prevIdx]
+		: &data.Actions[nextIdx];
 }
 
 void Funscript::EqualizeSelection() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	if (data.Selection.size() < 3) return;
-	sortSelection(); // might be unnecessary
-	auto first = data.Selection.front();
-	auto last = data.Selection.back();
-	float duration = last.atS - first.atS;
-	float stepTime = duration / (float)(data.Selection.size()-1);
-		
-	auto copySelection = data.Selection;
-	RemoveSelectedActions(); // clears selection
-
-	for (int i = 1; i < copySelection.size()-1; i++) {
-		auto& newAction = copySelection[i];
-		newAction.atS = first.atS + i * stepTime;
+	auto selectionSize = SelectionSize();
+	if (selectionSize < 3) return;
+	auto first = *FirstSelected();
+	auto last = *LastSelected();
+	double duration = last.at - first.at;
+	double stepTime = duration / (double)(selectionSize - 1);
+
+	EditBatch batch(*this);
+	batch.Reserve(selectionSize, selectionSize);
+	int i = 0;
+	data.Selection.forEachSet([&](std::size_t idx) noexcept {
+		auto action = data.Actions[idx];
+		if (i != 0 && i != selectionSize - 1) {
+			auto newAction = action;
+			newAction.at = first.at + (std::uint32_t)std::llround(i * stepTime);
+			batch.Move(action, newAction, true);
+		}
+		++i;
+	});
+}
+
+void Funscript::InvertSelection() noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	if (!HasSelection()) return;
+	auto selectionSize = SelectionSize();
+	EditBatch batch(*this);
+	batch.Reserve(selectionSize, selectionSize);
+	data.Selection.forEachSet([this, &batch](std::size_t idx) noexcept {
+		auto act = data.Actions[idx];
+		auto inverted = act;
+		inverted.pos = std::abs(act.pos - 100);
+		batch.Move(act, inverted, true);
+	});
+}
+
+std::size_t Funscript::EditBatch::rejectCollisions() noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	const auto& oldActions = script.data.Actions;
+	std::vector<bool> restored(removals.size(), false);
+
+	auto findOld = [&oldActions](std::uint32_t atMs) noexcept -> const FunscriptAction* {
+		auto it = std::lower_bound(oldActions.begin(), oldActions.end(), atMs,
+			[](auto action, std::uint32_t ms) noexcept { return action.at < ms; });
+		return it != oldActions.end() && it->at == atMs ? &*it : nullptr;
+	};
+	auto isKept = [&](FunscriptAction action) noexcept {
+		if (removeAll) return false;
+		for (auto [from, to] : intervals) {
+			if (from <= action.at && action.at <= to) return false;
+		}
+		auto it = std::lower_bound(removals.begin(), removals.end(), action);
+		for (; it != removals.end() && it->at == action.at; ++it) {
+			if (*it == action && !restored[std::distance(removals.begin(), it)]) return false;
+		}
+		return true;
+	};
+
+	// Rejecting a move puts its action back, which can block the insert at that timestamp in turn.
+	std::vector<std::uint32_t> blocked;
+	std::size_t rejectedCount = 0;
+	auto reject = [&](Insert& insert) noexcept {
+		insert.rejected = true;
+		rejectedCount += 1;
+		if (!insert.isMove) return;
+		auto it = std::lower_bound(removals.begin(), removals.end(), insert.from);
+		for (; it != removals.end() && it->at == insert.from.at; ++it) {
+			auto idx = std::distance(removals.begin(), it);
+			if (*it == insert.from && !restored[idx]) {
+				restored[idx] = true;
+				auto old = findOld(insert.from.at);
+				if (old && *old == insert.from && isKept(*old)) blocked.emplace_back(old->at);
+				break;
+			}
+		}
+	};
+
+	for (std::size_t i = 0; i < inserts.size(); ++i) {
+		bool duplicate = i + 1 < inserts.size() && inserts[i + 1].action.at == inserts[i].action.at;
+		if (duplicate) {
+			reject(inserts[i]);
+			continue;
+		}
+		auto old = findOld(inserts[i].action.at);
+		if (old && isKept(*old)) reject(inserts[i]);
+	}
+	while (!blocked.empty()) {
+		auto atMs = blocked.back();
+		blocked.pop_back();
+		// only the last insert of a timestamp can still be pending
+		auto it = std::upper_bound(inserts.begin(), inserts.end(), atMs,
+			[](std::uint32_t ms, const Insert& insert) noexcept { return ms < insert.action.at; });
+		if (it != inserts.begin() && (it - 1)->action.at == atMs && !(it - 1)->rejected) reject(*(it - 1));
+	}
+
+	if (rejectedCount > 0) {
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < removals.size(); ++i) {
+			if (!restored[i]) removals[kept++] = removals[i];
+		}
+		removals.resize(kept);
+		inserts.erase(std::remove_if(inserts.begin(), inserts.end(),
+			[](const Insert& insert) noexcept { return insert.rejected; }), inserts.end());
+	}
+	return rejectedCount;
+}
+
+std::size_t Funscript::EditBatch::Commit() noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	if (Empty()) return 0;
+	auto& data = script.data;
+
+	// Only the k pending operations get sorted, the existing arrays are already ordered.
+	std::stable_sort(inserts.begin(), inserts.end(),
+		[](const Insert& a, const Insert& b) { return a.action.at < b.action.at; });
+	std::sort(removals.begin(), removals.end());
+	std::sort(intervals.begin(), intervals.end());
+	auto rejectedCount = rejectCollisions();
+	if (rejectedCount > 0) {
+		LOGF_WARN("Rejected {:d} actions because their timestamp was already taken.", rejectedCount);
 	}
 
-	for (auto& action : copySelection)
-		AddAction(action);
+	const auto& oldActions = data.Actions;
+	const auto& oldSelection = data.Selection;
+
+	FunscriptArray newActions;
+	bit_set newSelection;
+	newActions.reserve(oldActions.size() + inserts.size());
+	newSelection.reserve(oldActions.size() + inserts.size());
+
+	auto removalIt = removals.begin();
+	auto intervalIt = intervals.begin();
+
+	auto isRemoved = [&](FunscriptAction action) noexcept {
+		if (removeAll) return true;
+		while (removalIt != removals.end() && removalIt->at < action.at) ++removalIt;
+		for (auto it = removalIt; it != removals.end() && it->at == action.at; ++it) {
+			if (*it == action) return true;
+		}
+		while (intervalIt != intervals.end() && intervalIt->second < action.at) ++intervalIt;
+		// intervals are sorted by start so any overlapping one is found before the first one starting after the action
+		for (auto it = intervalIt; it != intervals.end() && it->first <= action.at; ++it) {
+			if (action.at <= it->second) return true;
+		}
+		return false;
+	};
 
-	data.Selection = std::move(copySelection);
+	std::size_t actionIdx = 0;
+	auto insertIt = inserts.begin();
+	while (actionIdx < oldActions.size() || insertIt != inserts.end()) {
+		if (insertIt == inserts.end() 
+			|| (actionIdx < oldActions.size() && oldActions[actionIdx].at < insertIt->action.at)) {
+			bool selected = !clearSelection && oldSelection.test(actionIdx);
+			auto action = oldActions[actionIdx++];
+			if (isRemoved(action)) continue;
+			newActions.emplace_back_unsorted(action);
+			newSelection.push_back(selected);
+		}
+		else {
+			if (actionIdx < oldActions.size() && oldActions[actionIdx].at == insertIt->action.at) {
+				// removed by the batch, inserts colliding with kept actions were rejected
+				++actionIdx;
+			}
+			newActions.emplace_back_unsorted(insertIt->action);
+			newSelection.push_back(insertIt->select);
+			++insertIt;
+		}
+	}
+
+	if (!(newSelection == oldSelection)) {
+		script.notifySelectionChanged();
+	}
+	data.Actions = std::move(newActions);
+	data.Selection = std::move(newSelection);
+	if (removeAll) {
+		script.notifyActionsChanged(true);
+	}
+	else {
+		// all operations are sorted so the changed range is bounded by their ends
+		std::uint32_t fromMs = std::numeric_limits<std::uint32_t>::max();
+		std::uint32_t toMs = 0;
+		if (!inserts.empty()) {
+			fromMs = std::min(fromMs, inserts.front().action.at);
+			toMs = std::max(toMs, inserts.back().action.at);
+		}
+		if (!removals.empty()) {
+			fromMs = std::min(fromMs, removals.front().at);
+			toMs = std::max(toMs, removals.back().at);
+		}
+		for (auto [intervalFrom, intervalTo] : intervals) {
+			fromMs = std::min(fromMs, intervalFrom);
+			toMs = std::max(toMs, intervalTo);
+		}
+		if (fromMs <= toMs) script.notifyActionsChanged(true, fromMs, toMs);
+	}
+
+	inserts.clear();
+	removals.clear();
+	intervals.clear();
+	removeAll = false;
+	clearSelection = false;
+	return rejectedCount;
 }
 
-void Funscript::InvertSelection() noexcept
+void Funscript::binaryLoaded() noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	if (data.Selection.empty()) return;
-	auto copySelection = data.Selection;
-	RemoveSelectedActions();
-	for (auto& act : copySelection)	{
-		act.pos = std::abs(act.pos - 100);
-		AddAction(act);
+	auto unordered = std::adjacent_find(data.Actions.begin(), data.Actions.end(),
+		[](auto a, auto b) noexcept { return a.at >= b.at; });
+	if (unordered != data.Actions.end()) {
+		LOG_WARN("Actions in the project weren't sorted.");
+		data.Actions.sort();
+		auto last = std::unique(data.Actions.begin(), data.Actions.end(),
+			[](auto a, auto b) noexcept { return a.at == b.at; });
+		data.Actions.erase(last, data.Actions.end());
+		data.Selection.clear();
+	}
+	if (data.Selection.size() != data.Actions.size() || !data.Selection.IsConsistent()) {
+		data.Selection.assign(data.Actions.size(), false);
 	}
-	data.Selection = copySelection;
+	notifyActionsChanged(false);
+	notifySelectionChanged();
 }
 
 void Funscript::UpdateRelativePath(std::filesystem::path const& path) noexcept
@@ -873,40 +1513,68 @@ void Funscript::UpdateRelativePath(std::filesystem::path const& path) noexcept
 	title = currentPathRelative.stem() .string();
 }
 
-// QQQ
-bool Funscript::Deserialize(/*const nlohmann::json& json, */Funscript::Metadata* outMetadata, bool loadChapters) noexcept
+bool Funscript::Deserialize(std::string_view json, Funscript::Metadata* outMetadata, bool loadChapters, LoadIssues* outIssues) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
+	FunscriptArray actions;
+	actions.reserve(estimateActionCount(json));
+	std::string_view metadataJson;
+	std::map<std::string, std::string> unknownFields;
+
+	LoadIssues issues;
+	bool sorted = true;
+	bool success = scanFunscript(json, [&actions, &sorted, &issues](std::int64_t at, std::int64_t pos) noexcept {
+		if (at < 0) {
+			issues.NegativeTimes += 1;
+			return;
+		}
+		if (pos < 0 || pos > 100) issues.PositionsOutOfRange += 1;
+		auto action = FunscriptAction::FromMs(
+			static_cast<std::uint32_t>(std::min<std::int64_t>(at, FunscriptAction::MaxTimeMs)),
+			static_cast<std::int32_t>(std::clamp<std::int64_t>(pos, 0, 100)));
+		if (!actions.empty() && actions.back().at >= action.at) {
+			sorted = false;
+			issues.UnsortedActions += actions.back().at > action.at;
+		}
+		actions.emplace_back_unsorted(action);
+	}, metadataJson, unknownFields);
 
-	//if (!json.is_object() || !json["actions"].is_array()) {
-	//	LOG_ERROR("Failed to load Funscript. No action array found.");
-	//	return false;
-	////}
-	//
-	//auto& jsonActions = json["actions"];
-	//data.Actions.clear();
-	//
-	//for (auto& action : jsonActions) 
-	//{
-	//	float time = action["at"].get<double>() / 1000.0;
-	//	int32_t pos = action["pos"];
-	//	if (time >= 0.f) {
-	//		data.Actions.emplace(time, Util::Clamp(pos, 0, 100));
-	//	}
-	//}
-	//
-	//if(outMetadata)
-	//{
-	//	if(json.contains("metadata"))
-	//	{
-	//		loadMetadata(json["metadata"], *outMetadata);
-	//	}
-	//	else
-	//	{
-	//		*outMetadata = Funscript::Metadata();
-	//	}
-	//}
-	//
+	if (!success) {
+		LOG_ERROR("Failed to load Funscript. No action array found.");
+		return false;
+	}
+
+	if (!sorted) {
+		// the first action wins when timestamps are duplicated
+		std::stable_sort(actions.begin(), actions.end());
+		auto last = std::unique(actions.begin(), actions.end(), 
+			[](auto a, auto b) noexcept { return a.at == b.at; });
+		issues.DuplicateTimes = std::distance(last, actions.end());
+		actions.erase(last, actions.end());
+	}
+	if (outIssues) *outIssues = issues;
+
+	OFS::util::UnknownFieldProxy<Funscript::Metadata> metadata{};
+	if (!metadataJson.empty()) {
+		if (auto const err = glz::read<METADATA_JSON_OPTS>(metadata, metadataJson); err) {
+			LOGF_WARN("Failed to read funscript metadata. {:s}", glz::format_error(err, metadataJson));
+			metadata = {};
+		}
+	}
+	if (outMetadata) {
+		*outMetadata = static_cast<Funscript::Metadata&>(metadata);
+	}
+
+	unknownFieldsJSON = std::move(unknownFields);
+	unknownMetadataFieldsJSON.clear();
+	for (auto&& [key, value] : metadata.unknownFields) {
+		unknownMetadataFieldsJSON.try_emplace(unknownMetadataFieldsJSON.end(), std::string(key), std::string(value.str));
+	}
+
+	data.Actions = std::move(actions);
+	data.Selection.assign(data.Actions.size(), false);
+
+	// QQQ
 	//if(loadChapters && json.contains("metadata"))
 	//{
 	//	auto& chapterState = ChapterState::StaticStateSlow();
@@ -994,74 +1662,60 @@ bool Funscript::Deserialize(/*const nlohmann::json& json, */Funscript::Metadata*
 	return true;
 }
 
-// QQQ
-void Funscript::Serialize(/*nlohmann::json& json, */const FunscriptData& funscriptData, const Funscript::Metadata& metadata, bool includeChapters) noexcept
+std::string Funscript::Serialize(const Funscript::Metadata& metadata, bool includeChapters) const noexcept
+{
+	// QQQ: chapters and bookmarks aren't written yet
+	std::string json;
+	Serialize(json, TakeSaveSnapshot(), metadata);
+	return json;
+}
+
+void Funscript::Serialize(std::string& out, const SaveSnapshot& script, const Funscript::Metadata& metadata) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	//json = nlohmann::json::object();
-	//json["actions"] = nlohmann::json::array();
-	//json["metadata"] = nlohmann::json::object();
-	//json["version"] = "1.0";
-	//json["inverted"] = false;
-	//json["range"] = 100;
-	//
-	//auto& jsonMetadata = json["metadata"];
-	////QQQ
-	////OFS::Serializer<false>::Serialize(metadata, jsonMetadata);
-	//if(includeChapters)
-	//{
-	//	auto& chapters = ChapterState::StaticStateSlow();
-	//	{
-	//		auto jsonBookmarks = nlohmann::json::array();
-	//		for(auto& bookmark : chapters.bookmarks)
-	//		{
-	//			nlohmann::json jsonBookmark = 
-	//			{
-	//				{"name", bookmark.name },
-	//				{"time", std::move(bookmark.TimeToString()) }
-	//			};
-	//			jsonBookmarks.emplace_back(std::move(jsonBookmark));
-	//		}
-	//		jsonMetadata["bookmarks"] = std::move(jsonBookmarks);
-	//	}
-	//	{
-	//		auto jsonChapters = nlohmann::json::array();
-	//		for(auto& chapter : chapters.chapters)
-	//		{
-	//			nlohmann::json jsonChapter = 
-	//			{
-	//				{"name", chapter.name },
-	//				{"startTime", std::move(chapter.StartTimeToString()) },
-	//				{"endTime", std::move(chapter.EndTimeToString()) },
-	//			};
-	//			jsonChapters.emplace_back(std::move(jsonChapter));
-	//		}
-	//		jsonMetadata["chapters"] = std::move(jsonChapters);
-	//	}
-	//}
-	//
-	//auto& jsonActions = json["actions"];
-	//jsonActions.clear();
-	//
-	//int64_t lastTimestamp = -1;
-	//for (auto action : funscriptData.Actions) {
-	//	// a little validation just in case
-	//	if (action.atS < 0.f)
-	//		continue;
-	//		
-	//	int64_t ts = (int64_t)std::round(action.atS*1000.0);
-	//	// make sure timestamps are unique
-	//	if(ts != lastTimestamp) { 
-	//		nlohmann::json actionObj = {
-	//			{ "at",  ts },
-	//			{ "pos", Util::Clamp<int32_t>(action.pos, 0, 100) }
-	//		};
-	//		jsonActions.emplace_back(std::move(actionObj));
-	//		lastTimestamp = ts;
-	//	}
-	//	else 
-	//	{
-	//		LOG_WARN("Action was ignored since it had the same millisecond timestamp as the previous one.");
-	//	}
-	//}
+	constexpr std::string_view ActionPrefix = "{\"at\":";
+	constexpr std::string_view ActionInfix = ",\"pos\":";
+	// {"at":4294967295,"pos":100},
+	constexpr std::size_t MaxActionSize = ActionPrefix.size() + 10 + ActionInfix.size() + 3 + 2;
+
+	out.clear();
+	out += "{\"actions\":[";
+	// sized for the longest possible action so the loop never reallocates
+	auto offset = out.size();
+	out.resize(offset + script.State.Actions.Size() * MaxActionSize);
+	char* ptr = out.data() + offset;
+	script.State.Actions.ForEach([&ptr, ActionPrefix, ActionInfix](FunscriptAction action) noexcept {
+		std::memcpy(ptr, ActionPrefix.data(), ActionPrefix.size());
+		ptr = writeUInt(ptr + ActionPrefix.size(), action.at);
+		std::memcpy(ptr, ActionInfix.data(), ActionInfix.size());
+		ptr = writeUInt(ptr + ActionInfix.size(), std::min<std::uint32_t>(action.pos, 100));
+		*ptr++ = '}';
+		*ptr++ = ',';
+	});
+	if (ptr != out.data() + offset) --ptr; // trailing comma
+	out.resize(ptr - out.data());
+	out += "],\"metadata\":";
+
+	thread_local std::string metadataJson;
+	auto metadataOutput = glz::merge{
+		metadata,
+		glz::detail::opts_wrapper_t<decltype(script.UnknownMetadataFieldsJSON) const&, &glz::opts::raw>{ script.UnknownMetadataFieldsJSON }
+	};
+	if (auto const err = glz::write<JSON_OPTS>(metadataOutput, metadataJson); err) [[unlikely]] {
+		FUN_ASSERT(false, "Funscript metadata serialization failed.");
+		metadataJson = "{}";
+	}
+	out += metadataJson;
+
+	// fields written by other programs are passed through as they were read
+	for (auto& [key, value] : script.UnknownFieldsJSON) {
+		out += ",\"";
+		out += key;
+		out += "\":";
+		out += value;
+	}
+	if (!script.UnknownFieldsJSON.contains("version")) out += ",\"version\":\"1.0\"";
+	if (!script.UnknownFieldsJSON.contains("inverted")) out += ",\"inverted\":false";
+	if (!script.UnknownFieldsJSON.contains("range")) out += ",\"range\":100";
+	out += '}';
 }
@@ -1,19 +1,27 @@
 #pragma once
 #include "OFS_Util.h"
+#include "OFS_BitSet.h"
 #include "OFS_Profiling.h"
 #include "OFS_Reflection.h"
 #include "event/OFS_Event.h"
 #include "io/OFS_Serialization.h"
 #include "io/OFS_BinarySerialization.h"
 #include "funscript/FunscriptAction.h"
+#include "funscript/FunscriptActionStore.h"
 #include "funscript/FunscriptSpline.h"
+#include "funscript/FunscriptStrokeIndex.h"
+#include "funscript/FunscriptTimeIndex.h"
 
 #include <map>
+#include <span>
 #include <chrono>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstring>
+#include <utility>
 #include <filesystem>
 
 class FunscriptUndoSystem;
@@ -73,7 +81,36 @@ namespace OFS
 
 			struct FunscriptData {
 				FunscriptArray Actions;
-				FunscriptArray Selection;
+				// one bit per action, always the same size as Actions
+				bit_set Selection;
+			};
+
+			// Cheap to copy state of a script, the actions are shared between snapshots.
+			struct FunscriptSnapshot {
+				FunscriptActionStore Actions;
+				bit_set Selection;
+			};
+
+			// Difference between two states of a script.
+			struct FunscriptDelta {
+				// actions whose timestamp no longer exists
+				FunscriptArray Removed;
+				// new or changed actions, an insert replaces the action with the same timestamp
+				FunscriptArray Inserted;
+				// [first, last) index runs of the resulting state whose selection toggles
+				std::vector<std::pair<std::uint32_t, std::uint32_t>> SelectionFlips;
+
+				inline bool Empty() const noexcept { return Removed.empty() && Inserted.empty() && SelectionFlips.empty(); }
+				inline bool HasActionChanges() const noexcept { return !Removed.empty() || !Inserted.empty(); }
+				inline std::size_t MemoryUsage() const noexcept
+				{
+					return (Removed.capacity() + Inserted.capacity()) * sizeof(FunscriptAction)
+						+ SelectionFlips.capacity() * sizeof(SelectionFlips[0]);
+				}
+
+				// compact binary form, timestamps are delta encoded
+				std::vector<std::uint8_t> Pack() const noexcept;
+				static bool Unpack(std::span<const std::uint8_t> in, FunscriptDelta& delta) noexcept;
 			};
 
 			struct Metadata {
@@ -90,30 +127,75 @@ namespace OFS
 				int64_t duration = 0;
 			};
 
-			template<typename S>
-			void serialize(S& s)
+			// Everything the binary project payload stores about a script.
+			// The actions are shared with the script so it's cheap to take and safe to write on another thread.
+			struct SaveSnapshot {
+				std::filesystem::path RelativePath;
+				bool Enabled = true;
+				std::map<std::string, std::string> UnknownFieldsJSON;
+				std::map<std::string, std::string> UnknownMetadataFieldsJSON;
+				FunscriptSnapshot State;
+
+				// write only, in the layout Funscript::serialize reads
+				constexpr static auto serialize(auto& archive, auto& self) noexcept
+				{
+					static_assert(std::remove_cvref_t<decltype(archive)>::kind() == zpp::bits::kind::out);
+					std::u8string relativePath = self.RelativePath.u8string();
+					auto result = archive(relativePath, self.Enabled, self.UnknownFieldsJSON, self.UnknownMetadataFieldsJSON);
+					if (zpp::bits::failure(result)) return result;
+
+					std::vector<std::byte> actionBytes(self.State.Actions.Size() * sizeof(FunscriptAction));
+					auto out = actionBytes.data();
+					for (auto& block : self.State.Actions.Blocks()) {
+						std::memcpy(out, block->data(), block->size() * sizeof(FunscriptAction));
+						out += block->size() * sizeof(FunscriptAction);
+					}
+					result = archive(actionBytes);
+					if (zpp::bits::failure(result)) return result;
+					return archive(self.State.Selection);
+				}
+			};
+
+			// Layout of a script inside the binary project payload, see OFS_Binary.
+			constexpr static auto serialize(auto& archive, auto& self) noexcept
 			{
-				s(*this);
-				//s.ext(*this, bitsery::ext::Growable{},
-				//	[](S& s, Funscript& o) {
-				//		s.container(o.data.Actions, std::numeric_limits<uint32_t>::max());
-				//		s.text1b(o.currentPathRelative, o.currentPathRelative.max_size());
-				//		s.text1b(o.title, o.title.max_size());
-				//		s.boolValue(o.Enabled);
-				//	});
+				using Archive = std::remove_cvref_t<decltype(archive)>;
+				if constexpr (Archive::kind() == zpp::bits::kind::out) {
+					auto snapshot = self.TakeSaveSnapshot();
+					return archive(snapshot);
+				}
+				else {
+					std::u8string relativePath;
+					auto result = archive(relativePath, self.Enabled, self.unknownFieldsJSON, self.unknownMetadataFieldsJSON);
+					if (zpp::bits::failure(result)) return result;
+					result = OFS_Binary::Block(archive, self.data.Actions);
+					if (zpp::bits::failure(result)) return result;
+					result = archive(self.data.Selection);
+					if (zpp::bits::failure(result)) return result;
+
+					self.UpdateRelativePath(std::filesystem::path(relativePath));
+					self.binaryLoaded();
+					return result;
+				}
 			}
 
 		private:
-			// FIXME: OFS should be able to retain metadata injected by other programs without overwriting it
-			//nlohmann::json JsonOther;
+			// fields injected by other programs, kept as raw json so they can be written back
+			std::map<std::string, std::string> unknownFieldsJSON;
+			std::map<std::string, std::string> unknownMetadataFieldsJSON;
 
 			std::chrono::system_clock::time_point editTime;
 			bool funscriptChanged = false; // used to fire only one event every frame a change occurs
 			bool unsavedEdits = false; // used to track if the script has unsaved changes
 			bool selectionChanged = false;
+			// time range of the actions changed since the last event
+			std::uint32_t changedFromMs = std::numeric_limits<std::uint32_t>::max();
+			std::uint32_t changedToMs = 0;
 			FunscriptData data;
-
-			void checkForInvalidatedActions() noexcept;
+			FunscriptStrokeIndex strokeIndex;
+			// kept up to date lazily when a snapshot is taken
+			mutable FunscriptActionStore actionStore;
+			mutable FunscriptTimeIndex timeIndex;
 
 			inline FunscriptAction* getAction(FunscriptAction action) noexcept
 			{
@@ -126,30 +208,32 @@ namespace OFS
 				return nullptr;
 			}
 
-		public:
-			static inline FunscriptAction* getActionAtTime(FunscriptArray& actions, float time, float maxErrorTime) noexcept
+			inline FunscriptAction* getActionAtTime(double time, float maxErrorTime) noexcept
 			{
 				OFS_PROFILE(__FUNCTION__);
+				auto& actions = data.Actions;
 				if (actions.empty()) return nullptr;
 				// gets an action at a time with a margin of error
-				float smallestError = std::numeric_limits<float>::max();
+				const std::int64_t timeMs = FunscriptAction::ToMs(time);
+				const std::int64_t maxErrorMs = FunscriptAction::ToMs(maxErrorTime);
+				std::int64_t smallestError = std::numeric_limits<std::int64_t>::max();
 				FunscriptAction* smallestErrorAction = nullptr;
 
 				int i = 0;
-				auto it = actions.lower_bound(FunscriptAction(time - maxErrorTime, 0));
-				if (it != actions.end()) {
-					i = std::distance(actions.begin(), it);
+				auto idx = timeIndex.LowerBound(actions, FunscriptAction::OffsetMs(timeMs, -maxErrorMs));
+				if (idx != actions.size()) {
+					i = idx;
 					if (i > 0) --i;
 				}
 
 				for (; i < actions.size(); i++) {
 					auto& action = actions[i];
 
-					if (action.atS > (time + (maxErrorTime / 2)))
+					if (action.at > timeMs + (maxErrorMs / 2))
 						break;
 
-					auto error = std::abs(time - action.atS);
-					if (error <= maxErrorTime) {
+					auto error = std::abs(timeMs - (std::int64_t)action.at);
+					if (error <= maxErrorMs) {
 						if (error <= smallestError) {
 							smallestError = error;
 							smallestErrorAction = &action;
@@ -161,37 +245,76 @@ namespace OFS
 				}
 				return smallestErrorAction;
 			}
-		private:
-			inline FunscriptAction* getNextActionAhead(float time) noexcept
+
+			// first action after atMs
+			inline FunscriptAction* getNextActionAheadMs(std::uint32_t atMs) noexcept
 			{
 				OFS_PROFILE(__FUNCTION__);
 				if (data.Actions.empty()) return nullptr;
-				auto it = data.Actions.upper_bound(FunscriptAction(time, 0));
-				return it != data.Actions.end() ? &*it : nullptr;
+				auto idx = timeIndex.UpperBound(data.Actions, atMs);
+				return idx != data.Actions.size() ? &data.Actions[idx] : nullptr;
 			}
 
-			inline FunscriptAction* getPreviousActionBehind(float time) noexcept
+			// last action before atMs
+			inline FunscriptAction* getPreviousActionBehindMs(std::uint32_t atMs) noexcept
 			{
 				OFS_PROFILE(__FUNCTION__);
 				if (data.Actions.empty()) return nullptr;
-				auto it = data.Actions.lower_bound(FunscriptAction(time, 0));
-				if (it != data.Actions.begin()) {
-					return &*(--it);
+				auto idx = timeIndex.LowerBound(data.Actions, atMs);
+				return idx != 0 ? &data.Actions[idx - 1] : nullptr;
+			}
+
+			inline FunscriptAction* getNextActionAhead(double time) noexcept { return getNextActionAheadMs(FunscriptAction::ToMs(time)); }
+			inline FunscriptAction* getPreviousActionBehind(double time) noexcept { return getPreviousActionBehindMs(FunscriptAction::ToMs(time)); }
+
+			inline std::size_t actionIndex(FunscriptAction action) const noexcept
+			{
+				auto it = data.Actions.find(action);
+				return it != data.Actions.end() ? std::distance(data.Actions.begin(), it) : bit_set::npos;
+			}
+
+			// removes all actions matching the predicate and keeps the selection aligned
+			template<typename Pred>
+			inline void removeActionsIf(Pred&& pred) noexcept
+			{
+				std::size_t out = 0;
+				std::uint32_t fromMs = std::numeric_limits<std::uint32_t>::max();
+				std::uint32_t toMs = 0;
+				for (std::size_t i = 0, size = data.Actions.size(); i < size; ++i) {
+					if (pred(data.Actions[i])) {
+						fromMs = std::min(fromMs, data.Actions[i].at);
+						toMs = std::max(toMs, data.Actions[i].at);
+						continue;
+					}
+					data.Actions[out] = data.Actions[i];
+					data.Selection.set(out, data.Selection.test(i));
+					++out;
+				}
+				if (out != data.Actions.size()) {
+					data.Actions.resize(out);
+					data.Selection.resize(out);
+					notifyActionsChanged(true, fromMs, toMs);
+					notifySelectionChanged();
 				}
-				return nullptr;
 			}
 
+			// returns a mask of the selected actions which are not local maxima (top = true) or minima (top = false)
+			bit_set selectionExtremaMask(bool top) const noexcept;
+			// keeps the selected actions by their turning point type, only works for a selection without gaps
+			bool filterSelectionByExtremum(bool keepPeaks, bool keepValleys, bool keepOthers) noexcept;
+
 			void moveAllActionsTime(float timeOffset);
-			void moveActionsPosition(std::vector<FunscriptAction*> moving, int32_t posOffset);
-			inline void sortSelection() noexcept { sortActions(data.Selection); }
-			inline void sortActions(FunscriptArray& actions) noexcept { std::sort(actions.begin(), actions.end()); }
-			inline void addAction(FunscriptArray& actions, FunscriptAction newAction) noexcept { actions.emplace(newAction); notifyActionsChanged(true); }
+			void addAction(FunscriptAction newAction) noexcept;
+			// repairs what a corrupted payload could break and rebuilds the indices
+			void binaryLoaded() noexcept;
 			inline void notifySelectionChanged() noexcept { selectionChanged = true; }
 
 			static void loadMetadata(/*const nlohmann::json& metadataObj, */Funscript::Metadata& outMetadata) noexcept;
 			static void saveMetadata(/*nlohmann::json& outMetadataObj, */const Funscript::Metadata& inMetadata) noexcept;
+			static FunscriptDelta diff(const FunscriptActionStore& fromActions, const bit_set& fromSelection, const FunscriptSnapshot& target) noexcept;
 
-			void notifyActionsChanged(bool isEdit) noexcept;
+			// fromMs/toMs is the time range of the actions which changed, defaults to everything
+			void notifyActionsChanged(bool isEdit, std::uint32_t fromMs = 0, std::uint32_t toMs = std::numeric_limits<std::uint32_t>::max()) noexcept;
 			std::filesystem::path currentPathRelative;
 			std::string title;
 		public:
@@ -208,45 +331,82 @@ namespace OFS
 			inline const std::filesystem::path& RelativePath() const noexcept { return currentPathRelative; }
 			inline const std::string& Title() const noexcept { return title; }
 
-			inline void Rollback(FunscriptData&& data) noexcept { this->data = std::move(data); notifyActionsChanged(true); }
-			inline void Rollback(const FunscriptData& data) noexcept { this->data = data; notifyActionsChanged(true); }
-			void Update() noexcept;
-
-			// QQQ
-			bool Deserialize(/*const nlohmann::json& json,*/ Funscript::Metadata* outMetadata, bool loadChapters) noexcept;
-			std::string Serialize(const Funscript::Metadata& metadata, bool includeChapters) const noexcept
+			// only the blocks touched since the last snapshot get copied
+			inline FunscriptSnapshot TakeSnapshot() const noexcept 
+			{ 
+				actionStore.Update(data.Actions);
+				return FunscriptSnapshot{ actionStore, data.Selection };
+			}
+			// Delta which turns the current state into target.
+			// Blocks shared with the target are skipped so the cost follows the size of the edit.
+			FunscriptDelta DiffTo(const FunscriptSnapshot& target) const noexcept;
+			static FunscriptDelta Diff(const FunscriptSnapshot& from, const FunscriptSnapshot& to) noexcept;
+			void ApplyDelta(const FunscriptDelta& delta) noexcept;
+			inline SaveSnapshot TakeSaveSnapshot() const noexcept
 			{
-				return {};
+				return SaveSnapshot{ currentPathRelative, Enabled, unknownFieldsJSON, unknownMetadataFieldsJSON, TakeSnapshot() };
 			}
-			//inline nlohmann::json Serialize(const Funscript::Metadata& metadata, bool includeChapters) const noexcept 
-			//{ 
-			//	nlohmann::json json;
-			//	Serialize(json, data, metadata, includeChapters); 
-			//	return json;
-			//}
-			static void Serialize(/*nlohmann::json& json, */const FunscriptData& funscriptData, const Funscript::Metadata& metadata, bool includeChapters) noexcept;
+			void Update() noexcept;
+
+			// What Deserialize had to repair in a file.
+			struct LoadIssues {
+				std::size_t NegativeTimes = 0;
+				std::size_t PositionsOutOfRange = 0;
+				std::size_t UnsortedActions = 0;
+				std::size_t DuplicateTimes = 0;
+				inline bool Any() const noexcept { return NegativeTimes || PositionsOutOfRange || UnsortedActions || DuplicateTimes; }
+			};
+
+			// Parses the funscript json, the actions are streamed directly into the action array.
+			// The json only has to stay alive for the duration of the call.
+			bool Deserialize(std::string_view json, Funscript::Metadata* outMetadata, bool loadChapters, LoadIssues* outIssues = nullptr) noexcept;
+			std::string Serialize(const Funscript::Metadata& metadata, bool includeChapters) const noexcept;
+			// Writes the funscript json of a snapshot into out, the capacity of out is reused.
+			// Only touches the snapshot so it can run on any thread.
+			static void Serialize(std::string& out, const SaveSnapshot& script, const Funscript::Metadata& metadata) noexcept;
 
 			inline const FunscriptData& Data() const noexcept { return data; }
-			inline const auto& Selection() const noexcept { return data.Selection; }
+			// one bit per action in Actions()
+			inline const bit_set& Selection() const noexcept { return data.Selection; }
 			inline const auto& Actions() const noexcept { return data.Actions; }
 
 			inline const FunscriptAction* GetAction(FunscriptAction action) noexcept { return getAction(action); }
-			inline const FunscriptAction* GetActionAtTime(float time, float errorTime) noexcept { return getActionAtTime(data.Actions, time, errorTime); }
-			inline const FunscriptAction* GetNextActionAhead(float time) noexcept { return getNextActionAhead(time); }
-			inline const FunscriptAction* GetPreviousActionBehind(float time) noexcept { return getPreviousActionBehind(time); }
-			inline const FunscriptAction* GetClosestAction(float time) noexcept { return getActionAtTime(data.Actions, time, std::numeric_limits<float>::max()); }
+			inline const FunscriptAction* GetActionAtTime(double time, float errorTime) noexcept { return getActionAtTime(time, errorTime); }
+			inline const FunscriptAction* GetNextActionAhead(double time) noexcept { return getNextActionAhead(time); }
+			inline const FunscriptAction* GetPreviousActionBehind(double time) noexcept { return getPreviousActionBehind(time); }
+			// same lookups relative to an action's exact timestamp, use these instead of converting through seconds
+			inline const FunscriptAction* GetNextActionAheadMs(std::uint32_t atMs) noexcept { return getNextActionAheadMs(atMs); }
+			inline const FunscriptAction* GetPreviousActionBehindMs(std::uint32_t atMs) noexcept { return getPreviousActionBehindMs(atMs); }
+			inline const FunscriptAction* GetClosestAction(double time) noexcept { return getActionAtTime(time, std::numeric_limits<float>::max()); }
+			// exact lookup by integer timestamp
+			inline const FunscriptAction* GetActionAtMs(std::uint32_t at) const noexcept
+			{
+				auto idx = timeIndex.LowerBound(data.Actions, at);
+				return idx != data.Actions.size() && data.Actions[idx].at == at ? &data.Actions[idx] : nullptr;
+			}
+			// index of the first action at or after atMs, Actions().size() if there is none
+			inline std::size_t LowerBoundIndex(std::uint32_t atMs) const noexcept { return timeIndex.LowerBound(data.Actions, atMs); }
 
 			float GetPositionAtTime(float time) const noexcept;
+			// Samples the linearly interpolated position (0-100) for every time in seconds.
+			// times must be sorted ascending and out at least as large as times.
+			void SamplePositions(std::span<const float> times, std::span<float> out) const noexcept;
 
-			inline void AddAction(FunscriptAction newAction) noexcept { addAction(data.Actions, newAction); }
+			inline void AddAction(FunscriptAction newAction) noexcept { addAction(newAction); }
 			void AddMultipleActions(const FunscriptArray& actions) noexcept;
 
 			bool EditAction(FunscriptAction oldAction, FunscriptAction newAction) noexcept;
 			void AddEditAction(FunscriptAction action, float frameTime) noexcept;
-			void RemoveAction(FunscriptAction action, bool checkInvalidSelection = true) noexcept;
+			void RemoveAction(FunscriptAction action) noexcept;
 			void RemoveActions(const FunscriptArray& actions) noexcept;
 
+			// returns the stroke before the one leading up to the closest action, newest action first
 			std::vector<FunscriptAction> GetLastStroke(float time) noexcept;
+			inline const FunscriptStrokeIndex& Strokes() noexcept 
+			{ 
+				strokeIndex.Update(data.Actions); 
+				return strokeIndex; 
+			}
 
 			void SetActions(const FunscriptArray& override_with) noexcept;
 
@@ -272,17 +432,91 @@ namespace OFS
 			void RemoveSelectedActions() noexcept;
 			void MoveSelectionTime(float time_offset, float frameTime) noexcept;
 			void MoveSelectionPosition(int32_t pos_offset) noexcept;
-			inline bool HasSelection() const noexcept { return !data.Selection.empty(); }
-			inline uint32_t SelectionSize() const noexcept { return data.Selection.size(); }
-			inline void ClearSelection() noexcept { data.Selection.clear(); }
-			inline const FunscriptAction* GetClosestActionSelection(float time) noexcept { return getActionAtTime(data.Selection, time, std::numeric_limits<float>::max()); }
+			inline bool HasSelection() const noexcept { return data.Selection.any(); }
+			inline uint32_t SelectionSize() const noexcept { return data.Selection.count(); }
+			inline void ClearSelection() noexcept { data.Selection.resetAll(); notifySelectionChanged(); }
+			const FunscriptAction* GetClosestActionSelection(float time) const noexcept;
+
+			inline const FunscriptAction* FirstSelected() const noexcept 
+			{
+				auto idx = data.Selection.findFirst();
+				return idx != bit_set::npos ? &data.Actions[idx] : nullptr;
+			}
+			inline const FunscriptAction* LastSelected() const noexcept
+			{
+				auto idx = data.Selection.findLast();
+				return idx != bit_set::npos ? &data.Actions[idx] : nullptr;
+			}
+			// copies the selected actions into a new array
+			FunscriptArray SelectedActions() const noexcept;
 
 			void SetSelection(const FunscriptArray& actions) noexcept;
-			bool IsSelected(FunscriptAction action) noexcept;
+			bool IsSelected(FunscriptAction action) const noexcept;
+			inline bool IsSelectedAt(std::size_t idx) const noexcept { return data.Selection.test(idx); }
 
 			void EqualizeSelection() noexcept;
 			void InvertSelection() noexcept;
 
+			// Collects inserts, removals and moves and applies all of them
+			// in a single sorted merge pass when committed.
+			// Fires one actions changed notification per commit.
+			// The caller is still responsible for taking the undo snapshot.
+			class EditBatch
+			{
+			public:
+				explicit EditBatch(Funscript& script) noexcept : script(script) {}
+				EditBatch(const EditBatch&) = delete;
+				EditBatch& operator=(const EditBatch&) = delete;
+				~EditBatch() noexcept { Commit(); }
+
+				// Adds an action. The insert is rejected when an action which the batch keeps has the same timestamp,
+				// of several inserts with the same timestamp the last one wins.
+				inline void Add(FunscriptAction action, bool select = false) noexcept { inserts.emplace_back(action, select); }
+				inline void Remove(FunscriptAction action) noexcept { removals.emplace_back(action); }
+				// A rejected move keeps the action at its old timestamp.
+				inline void Move(FunscriptAction from, FunscriptAction to, bool select = false) noexcept
+				{
+					removals.emplace_back(from);
+					inserts.emplace_back(to, select, from);
+				}
+				// Removes all actions in [fromMs, toMs]
+				inline void RemoveInterval(std::uint32_t fromMs, std::uint32_t toMs) noexcept { intervals.emplace_back(fromMs, toMs); }
+				inline void RemoveAll() noexcept { removeAll = true; }
+				inline void ClearSelection() noexcept { clearSelection = true; }
+
+				inline void Reserve(std::size_t inserts, std::size_t removals) noexcept 
+				{ 
+					this->inserts.reserve(inserts); 
+					this->removals.reserve(removals); 
+				}
+				inline bool Empty() const noexcept { return inserts.empty() && removals.empty() && intervals.empty() && !removeAll && !clearSelection; }
+
+				// Returns the number of rejected inserts, they are logged as well.
+				std::size_t Commit() noexcept;
+
+			private:
+				struct Insert
+				{
+					FunscriptAction action;
+					FunscriptAction from;
+					bool select;
+					bool isMove = false;
+					bool rejected = false;
+					Insert(FunscriptAction action, bool select) noexcept : action(action), select(select) {}
+					Insert(FunscriptAction action, bool select, FunscriptAction from) noexcept
+						: action(action), from(from), select(select), isMove(true) {}
+				};
+
+				std::size_t rejectCollisions() noexcept;
+
+				Funscript& script;
+				std::vector<Insert> inserts;
+				std::vector<FunscriptAction> removals;
+				std::vector<std::pair<std::uint32_t, std::uint32_t>> intervals;
+				bool removeAll = false;
+				bool clearSelection = false;
+			};
+
 			FunscriptSpline ScriptSpline;
 			inline const float Spline(float time) noexcept {
 				return ScriptSpline.Sample(data.Actions, time);
@@ -304,8 +538,13 @@ class FunscriptActionsChangedEvent : public OFS_Event<FunscriptActionsChangedEve
 	public:
 	// FIXME: get rid of this raw pointer
 	const Funscript* Script = nullptr;
+	// time range of the actions which changed
+	std::uint32_t FromMs = 0;
+	std::uint32_t ToMs = std::numeric_limits<std::uint32_t>::max();
 	FunscriptActionsChangedEvent(const Funscript* changedScript) noexcept
 		: Script(changedScript) {}
+	FunscriptActionsChangedEvent(const Funscript* changedScript, std::uint32_t fromMs, std::uint32_t toMs) noexcept
+		: Script(changedScript), FromMs(fromMs), ToMs(toMs) {}
 };
 
 class FunscriptSelectionChangedEvent : public OFS_Event<FunscriptSelectionChangedEvent>
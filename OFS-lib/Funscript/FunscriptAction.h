@@ -5,6 +5,7 @@
 #include <bit>
 #include <limits>
 #include <cstdint>
+#include <algorithm>
 
 namespace OFS
 {
@@ -23,47 +24,64 @@ namespace OFS
 
 	inline namespace v1
 	{
-		struct FunscriptAction
+		// Editing runs on the integer millisecond representation of v2.
+		// Float seconds are only a conversion layer for the UI and Lua.
+		struct FunscriptAction : public v2::FunscriptAction
 		{
 		public:
-			// timestamp as floating point seconds
-			// instead of integer milliseconds
-			float atS;
-			std::int8_t pos;
-			std::uint8_t flags; // unused
-			std::uint8_t tag;
+			static constexpr std::uint32_t MaxTimeMs = std::numeric_limits<std::uint32_t>::max();
 
-			//template <typename S>
-			//void serialize(S& s)
-			//{
-			//	s.ext(*this, bitsery::ext::Growable{},
-			//		[](S& s, FunscriptAction& o) {
-			//			s.value4b(o.atS);
-			//			s.value2b(o.pos);
-			//			s.value1b(o.flags);
-			//			s.value1b(o.tag);
-			//		});
-			//}
+			static constexpr std::uint32_t ToMs(double seconds) noexcept
+			{
+				double ms = seconds * 1000.0;
+				if (!(ms > 0.0)) return 0; // also catches NaN
+				if (ms >= (double)MaxTimeMs) return MaxTimeMs;
+				return static_cast<std::uint32_t>(ms + 0.5);
+			}
 
-			FunscriptAction(void) noexcept
-				: atS(std::numeric_limits<decltype(atS)>::min())
-				, pos(std::numeric_limits<decltype(pos)>::min())
-				, flags(0), tag(0)
+			// double holds every millisecond exactly, float doesn't past 2^24 ms (~4.66h)
+			static constexpr double ToSeconds(std::uint32_t ms) noexcept
 			{
+				return ms / 1000.0;
 			}
 
-			FunscriptAction(float at, std::int8_t pos) noexcept
+			// adds a signed millisecond offset clamped to the valid range
+			static constexpr std::uint32_t OffsetMs(std::uint32_t ms, std::int64_t offset) noexcept
+			{
+				std::int64_t result = static_cast<std::int64_t>(ms) + offset;
+				return static_cast<std::uint32_t>(std::clamp<std::int64_t>(result, 0, MaxTimeMs));
+			}
+
+			static constexpr FunscriptAction FromMs(std::uint32_t at, std::int32_t pos, std::uint8_t tag = 0) noexcept
+			{
+				FunscriptAction action;
+				action.at = at;
+				action.pos = static_cast<std::uint8_t>(std::clamp<std::int32_t>(pos, 0, 100));
+				action.tag = tag;
+				return action;
+			}
+
+			constexpr FunscriptAction(void) noexcept
+				: v2::FunscriptAction{ 0, 0, 0, 0 }
+			{
+			}
+
+			// at is in seconds
+			constexpr FunscriptAction(double at, std::int32_t pos) noexcept
 				: FunscriptAction(at, pos, 0)
 			{
 			}
 
-			FunscriptAction(float at, std::int8_t pos, std::uint8_t tag) noexcept
-				: atS(at), pos(pos), flags(0), tag(tag)
+			constexpr FunscriptAction(double at, std::int32_t pos, std::uint8_t tag) noexcept
+				: v2::FunscriptAction{ ToMs(at), static_cast<std::uint8_t>(std::clamp<std::int32_t>(pos, 0, 100)), tag, 0 }
 			{
 			}
 
-			inline bool operator <  (FunscriptAction b) const noexcept { return this->atS < b.atS; }
-			inline bool operator == (FunscriptAction b) const noexcept { return this->atS == b.atS && this->pos == b.pos; }
+			inline double atS() const noexcept { return ToSeconds(at); }
+			inline void setAtS(double seconds) noexcept { at = ToMs(seconds); }
+
+			inline bool operator <  (FunscriptAction b) const noexcept { return this->at < b.at; }
+			inline bool operator == (FunscriptAction b) const noexcept { return this->at == b.at && this->pos == b.pos; }
 			inline bool operator != (FunscriptAction b) const noexcept { return !(*this == b); }
 		};
 
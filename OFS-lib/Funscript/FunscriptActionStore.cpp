@@ -0,0 +1,86 @@
+#include "FunscriptActionStore.h"
+#include "OFS_Profiling.h"
+
+#include <algorithm>
+
+void FunscriptActionStore::appendBlocks(std::vector<BlockPtr>& out, FunscriptArray::const_iterator first, FunscriptArray::const_iterator last) noexcept
+{
+	// split evenly so a rebuilt range doesn't leave a tiny block behind
+	std::size_t count = std::distance(first, last);
+	if (count == 0) return;
+	std::size_t blockCount = (count + BlockSize - 1) / BlockSize;
+	for (std::size_t i = 0; i < blockCount; ++i) {
+		auto blockEnd = first + (count * (i + 1)) / blockCount - (count * i) / blockCount;
+		out.emplace_back(std::make_shared<const Block>(first, blockEnd));
+		first = blockEnd;
+	}
+}
+
+void FunscriptActionStore::Invalidate(std::uint32_t fromMs, std::uint32_t toMs) noexcept
+{
+	if (!dirty) {
+		dirtyFromMs = fromMs;
+		dirtyToMs = toMs;
+		dirty = true;
+	}
+	else {
+		dirtyFromMs = std::min(dirtyFromMs, fromMs);
+		dirtyToMs = std::max(dirtyToMs, toMs);
+	}
+}
+
+void FunscriptActionStore::Update(const FunscriptArray& actions) noexcept
+{
+	if (!dirty && !fullRebuild) return;
+	OFS_PROFILE(__FUNCTION__);
+
+	if (fullRebuild || blocks.empty()) {
+		blocks.clear();
+		appendBlocks(blocks, actions.begin(), actions.end());
+	}
+	else {
+		// Blocks ending before the changed range and blocks starting after it hold
+		// exactly the same actions as before, everything in between is rebuilt.
+		auto firstBlock = std::partition_point(blocks.begin(), blocks.end(),
+			[this](const BlockPtr& block) noexcept { return block->back().at < dirtyFromMs; });
+		auto lastBlock = std::partition_point(firstBlock, blocks.end(),
+			[this](const BlockPtr& block) noexcept { return block->front().at <= dirtyToMs; });
+
+		// pull in a neighbour when the rebuilt range would be small to keep blocks from fragmenting
+		auto countRange = [](auto first, auto last) noexcept {
+			std::size_t count = 0;
+			for (; first != last; ++first) count += (*first)->size();
+			return count;
+		};
+		if (countRange(firstBlock, lastBlock) < BlockSize / 2) {
+			if (firstBlock != blocks.begin()) --firstBlock;
+			else if (lastBlock != blocks.end()) ++lastBlock;
+		}
+
+		auto first = firstBlock != blocks.begin()
+			? actions.upper_bound((*(firstBlock - 1))->back())
+			: actions.begin();
+		auto last = lastBlock != blocks.end()
+			? actions.lower_bound((*lastBlock)->front())
+			: actions.end();
+
+		std::vector<BlockPtr> rebuilt;
+		appendBlocks(rebuilt, first, last);
+		auto it = blocks.erase(firstBlock, lastBlock);
+		blocks.insert(it, std::make_move_iterator(rebuilt.begin()), std::make_move_iterator(rebuilt.end()));
+	}
+
+	actionCount = actions.size();
+	dirty = false;
+	fullRebuild = false;
+}
+
+void FunscriptActionStore::CopyTo(FunscriptArray& out) const noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	out.clear();
+	out.reserve(actionCount);
+	for (auto& block : blocks) {
+		out.insert(out.end(), block->begin(), block->end());
+	}
+}
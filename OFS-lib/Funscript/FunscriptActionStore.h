@@ -0,0 +1,56 @@
+#pragma once
+#include "FunscriptAction.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Persistent copy of an action array split into immutable reference counted blocks.
+// Copying a store only copies the block pointers, the actions themselves are shared.
+// After an edit only the blocks overlapping the changed time range get rebuilt,
+// every other block stays shared with all previous copies.
+class FunscriptActionStore
+{
+public:
+	static constexpr std::size_t BlockSize = 1024;
+	using Block = std::vector<FunscriptAction>;
+	using BlockPtr = std::shared_ptr<const Block>;
+
+private:
+	std::vector<BlockPtr> blocks;
+	std::size_t actionCount = 0;
+
+	// actions in [dirtyFromMs, dirtyToMs] changed since the last update
+	std::uint32_t dirtyFromMs = 0;
+	std::uint32_t dirtyToMs = 0;
+	bool dirty = false;
+	bool fullRebuild = true;
+
+	static void appendBlocks(std::vector<BlockPtr>& out, FunscriptArray::const_iterator first, FunscriptArray::const_iterator last) noexcept;
+
+public:
+	// Marks the actions in [fromMs, toMs] as changed.
+	void Invalidate(std::uint32_t fromMs, std::uint32_t toMs) noexcept;
+	inline void InvalidateAll() noexcept
+	{
+		dirty = true;
+		fullRebuild = true;
+	}
+	// Brings the blocks in line with the actions reusing every untouched block.
+	void Update(const FunscriptArray& actions) noexcept;
+
+	inline std::size_t Size() const noexcept { return actionCount; }
+	inline bool Empty() const noexcept { return actionCount == 0; }
+	inline const std::vector<BlockPtr>& Blocks() const noexcept { return blocks; }
+
+	// copies all actions into a contiguous array
+	void CopyTo(FunscriptArray& out) const noexcept;
+
+	template<typename Fn>
+	inline void ForEach(Fn&& fn) const noexcept
+	{
+		for (auto& block : blocks) {
+			for (auto action : *block) fn(action);
+		}
+	}
+};
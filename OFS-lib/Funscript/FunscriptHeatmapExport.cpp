@@ -0,0 +1,115 @@
+#include "FunscriptHeatmapExport.h"
+#include "FunscriptHeatmapRender.h"
+#include "Funscript.h"
+#include "OFS_Util.h"
+#include "OFS_Profiling.h"
+#include "OFS_ThreadPool.h"
+
+#include <deque>
+#include <future>
+#include <thread>
+#include <algorithm>
+
+namespace
+{
+	std::vector<std::filesystem::path> findFunscripts(std::filesystem::path const& directory) noexcept
+	{
+		std::vector<std::filesystem::path> scripts;
+		std::error_code ec;
+		for (auto it = std::filesystem::recursive_directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, ec);
+			!ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+			if (it->is_regular_file(ec) && it->path().extension() == Funscript::Extension) {
+				scripts.emplace_back(it->path());
+			}
+		}
+		std::sort(scripts.begin(), scripts.end());
+		return scripts;
+	}
+
+	std::filesystem::path heatmapPath(OFS::funscript::HeatmapBatch const& batch, std::filesystem::path const& script) noexcept
+	{
+		auto name = script.stem();
+		name += OFS::funscript::HeatmapExtension;
+		if (batch.output.empty()) return script.parent_path() / name;
+		std::error_code ec;
+		auto relative = std::filesystem::relative(script.parent_path(), batch.directory, ec);
+		return ec ? batch.output / name : batch.output / relative / name;
+	}
+}
+
+bool OFS::funscript::renderHeatmapFile(std::filesystem::path const& script, std::filesystem::path const& png, std::uint32_t width, std::uint32_t height) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	if (width == 0 || height == 0) return false;
+
+	OFS::v2::Funscript parsed;
+	{
+		// the mapping is only needed while parsing
+		OFS::util::MappedFile file;
+		if (!file.open(script) || !parsed.deserialize(file.view())) {
+			LOGF_ERROR("Failed to load \"{:s}\" for its heatmap.", script.string());
+			return false;
+		}
+	}
+
+	// the parser keeps the file order, the speed profile needs sorted actions with unique timestamps
+	auto& parsedActions = parsed.getActions();
+	std::stable_sort(parsedActions.begin(), parsedActions.end(), [](auto a, auto b) noexcept { return a.at < b.at; });
+	thread_local FunscriptArray actions;
+	actions.clear();
+	actions.reserve(parsedActions.size());
+	for (auto action : parsedActions) {
+		if (!actions.empty() && actions.back().at == action.at) continue;
+		actions.emplace_back_unsorted(FunscriptAction::FromMs(action.at, action.pos));
+	}
+
+	// metadata duration is in seconds, scripts without it end with their last action
+	float duration = (float)std::min<std::uint64_t>(parsed.getMetadata().duration, FunscriptAction::MaxTimeMs / 1000);
+	if (!actions.empty()) duration = std::max(duration, (float)actions.back().atS());
+
+	// both stay allocated for the next script on this thread
+	thread_local SpeedProfile profile(HeatmapSpeedResolution, HeatmapMaxSpeedPerSecond);
+	thread_local std::vector<std::uint8_t> bitmap;
+	profile.Rebuild(duration, actions);
+	renderHeatmap(profile.Speeds(), width, height, bitmap);
+
+	if (png.has_parent_path() && !OFS::util::createDirectories(png.parent_path())) {
+		return false;
+	}
+	// renderHeatmap already writes the rows top to bottom
+	if (!OFS::util::savePNG(png.string(), bitmap.data(), (std::int32_t)width, (std::int32_t)height, 4, false)) {
+		LOGF_ERROR("Failed to write heatmap \"{:s}\".", png.string());
+		return false;
+	}
+	return true;
+}
+
+OFS::funscript::HeatmapBatchResult OFS::funscript::renderHeatmaps(HeatmapBatch const& batch, std::function<void(std::size_t done, std::size_t total)> const& progress) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	HeatmapBatchResult result;
+	auto scripts = findFunscripts(batch.directory);
+	if (progress) progress(0, scripts.size());
+
+	// at most jobs scripts are in flight so the queue stays short for libraries of any size
+	auto jobs = batch.jobs != 0 ? batch.jobs : std::max(1u, std::thread::hardware_concurrency());
+	auto& pool = OFS::ThreadPool::get();
+	std::deque<std::future<bool>> running;
+	std::size_t done = 0;
+	auto finishOldest = [&]() noexcept {
+		if (running.front().get()) result.written += 1;
+		else result.failed.emplace_back(scripts[done]);
+		running.pop_front();
+		done += 1;
+		if (progress) progress(done, scripts.size());
+	};
+
+	for (auto& script : scripts) {
+		if (running.size() >= jobs) finishOldest();
+		running.emplace_back(pool.queueTask([&batch, &script]() noexcept {
+			return renderHeatmapFile(script, heatmapPath(batch, script), batch.width, batch.height);
+		}));
+	}
+	while (!running.empty()) finishOldest();
+	return result;
+}
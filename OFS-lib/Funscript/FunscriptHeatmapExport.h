@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <filesystem>
+
+// Writes heatmap pngs for funscripts on disk, used by the editor for whole libraries and by ofs-cli.
+namespace OFS::funscript
+{
+	inline constexpr auto HeatmapExtension = ".heatmap.png";
+
+	struct HeatmapBatch
+	{
+		// searched recursively for funscripts
+		std::filesystem::path directory;
+		// pngs keep the layout below directory, next to each script when empty
+		std::filesystem::path output;
+		std::uint32_t width = 2000;
+		std::uint32_t height = 50;
+		// scripts in flight at once, 0 uses the number of hardware threads
+		unsigned jobs = 0;
+	};
+
+	struct HeatmapBatchResult
+	{
+		std::size_t written = 0;
+		std::vector<std::filesystem::path> failed;
+	};
+
+	// Loads a funscript and writes its heatmap. Safe to call on any thread.
+	bool renderHeatmapFile(std::filesystem::path const& script, std::filesystem::path const& png, std::uint32_t width, std::uint32_t height) noexcept;
+
+	// Renders every funscript in batch.directory on the thread pool and blocks until all are written.
+	// progress is called on the calling thread after every script with the number of finished scripts.
+	HeatmapBatchResult renderHeatmaps(HeatmapBatch const& batch, std::function<void(std::size_t done, std::size_t total)> const& progress) noexcept;
+}
@@ -0,0 +1,109 @@
+#include "FunscriptHeatmapRender.h"
+#include "OFS_Profiling.h"
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+#if defined(OFS_AVX2_ENABLED)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// same colors as the heatmap shader
+	constexpr std::array<std::array<float, 3>, 6> RampColors{{
+		{ 0.f, 0.f, 0.f },
+		{ 30.f / 255.f, 144.f / 255.f, 255.f / 255.f },
+		{ 0.f, 255.f / 255.f, 255.f / 255.f },
+		{ 0.f, 255.f / 255.f, 0.f },
+		{ 255.f / 255.f, 255.f / 255.f, 0.f },
+		{ 255.f / 255.f, 0.f, 0.f },
+	}};
+
+	inline float mix(float a, float b, float t) noexcept
+	{
+		return a * (1.f - t) + b * t;
+	}
+
+	// texture() with GL_LINEAR and GL_CLAMP_TO_EDGE on a one row texture
+	inline float sampleLinear(std::span<const float> speeds, float u) noexcept
+	{
+		float texel = u * (float)speeds.size() - 0.5f;
+		float base = std::floor(texel);
+		float fraction = texel - base;
+		int last = (int)speeds.size() - 1;
+		int idx = (int)base;
+		return mix(speeds[std::clamp(idx, 0, last)], speeds[std::clamp(idx + 1, 0, last)], fraction);
+	}
+
+	// RAMP() from the shader, the last color is used for x == 1 instead of reading past the array
+	inline void ramp(float x, float* rgb) noexcept
+	{
+		x = std::clamp(x, 0.f, 1.f) * (float)(RampColors.size() - 1);
+		int idx = std::min((int)x, (int)RampColors.size() - 2);
+		float t = x - (float)idx;
+		float smooth = t * t * (3.f - 2.f * t);
+		for (int c = 0; c < 3; ++c) {
+			rgb[c] = mix(RampColors[idx][c], RampColors[idx + 1][c], smooth);
+		}
+	}
+
+	// colors holds 4 floats per column already scaled to 0..255, fade is applied to rgb but not alpha
+	inline void fadeRowScalar(const float* colors, float fade, std::uint32_t from, std::uint32_t to, std::uint8_t* row) noexcept
+	{
+		for (std::uint32_t x = from; x < to; ++x) {
+			for (int c = 0; c < 4; ++c) {
+				float factor = c < 3 ? fade : 1.f;
+				row[x * 4 + c] = (std::uint8_t)(colors[x * 4 + c] * factor + 0.5f);
+			}
+		}
+	}
+
+#if defined(OFS_AVX2_ENABLED)
+	// Fades 4 columns at a time. Returns the first column which wasn't processed.
+	inline std::uint32_t fadeRowAVX2(const float* colors, float fade, std::uint32_t width, std::uint8_t* row) noexcept
+	{
+		const __m256 factor = _mm256_setr_ps(fade, fade, fade, 1.f, fade, fade, fade, 1.f);
+		const __m256 half = _mm256_set1_ps(0.5f);
+		std::uint32_t x = 0;
+		for (; x + 4 <= width; x += 4) {
+			__m256i a = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(colors + x * 4), factor), half));
+			__m256i b = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(colors + x * 4 + 8), factor), half));
+			// packus works per 128 bit lane, the permute restores the column order
+			__m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+			__m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+			_mm_storeu_si128((__m128i*)(row + x * 4), bytes);
+		}
+		return x;
+	}
+#endif
+}
+
+void OFS::funscript::renderHeatmap(std::span<const float> speeds, std::uint32_t width, std::uint32_t height, std::vector<std::uint8_t>& out) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	out.resize((std::size_t)width * height * 4);
+	if (out.empty()) return;
+
+	// the color only depends on the column, every row is the same colors faded towards black
+	std::vector<float> colors((std::size_t)width * 4);
+	for (std::uint32_t x = 0; x < width; ++x) {
+		float speed = speeds.empty() ? 0.f : sampleLinear(speeds, ((float)x + 0.5f) / (float)width);
+		float* color = colors.data() + x * 4;
+		ramp(speed, color);
+		for (int c = 0; c < 3; ++c) color[c] *= 255.f;
+		color[3] = 255.f;
+	}
+
+	for (std::uint32_t y = 0; y < height; ++y) {
+		// Frag_UV.y at the pixel center, 0 is the top
+		float fade = ((float)y + 0.5f) / (float)height;
+		auto row = out.data() + (std::size_t)y * width * 4;
+		std::uint32_t x = 0;
+#if defined(OFS_AVX2_ENABLED)
+		x = fadeRowAVX2(colors.data(), fade, width, row);
+#endif
+		fadeRowScalar(colors.data(), fade, x, width, row);
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "FunscriptSpeedProfile.h"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+// CPU version of the heatmap shader, needs no GL context so it can be used by ofs-cli and on worker threads.
+namespace OFS::funscript
+{
+	inline constexpr std::uint32_t HeatmapSpeedResolution = 2048;
+	// speed at which the heatmap reaches the last color
+	inline constexpr float HeatmapMaxSpeedPerSecond = 400.f;
+
+	// Rasterizes the speeds to width * height RGBA pixels with the rows ordered top to bottom.
+	// Matches the heatmap shader: linear filtering of the speeds, the same color ramp and the fade to black at the top.
+	void renderHeatmap(std::span<const float> speeds, std::uint32_t width, std::uint32_t height, std::vector<std::uint8_t>& out) noexcept;
+}
@@ -0,0 +1,166 @@
+#include "FunscriptProcessing.h"
+#include "OFS_Profiling.h"
+
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace
+{
+	inline float pointLineDistance(FunscriptAction pt, FunscriptAction lineStart, FunscriptAction lineEnd) noexcept
+	{
+		float dx = lineEnd.atS() - lineStart.atS();
+		float dy = lineEnd.pos - lineStart.pos;
+
+		// Normalize
+		float mag = std::sqrt(dx * dx + dy * dy);
+		if (mag > 0.0f) {
+			dx /= mag;
+			dy /= mag;
+		}
+		float pvx = pt.atS() - lineStart.atS();
+		float pvy = pt.pos - lineStart.pos;
+
+		// Get dot product (project pv onto normalized direction)
+		float pvdot = dx * pvx + dy * pvy;
+
+		// Scale line direction vector and subtract it from pv
+		float ax = pvx - pvdot * dx;
+		float ay = pvy - pvdot * dy;
+
+		return std::sqrt(ax * ax + ay * ay);
+	}
+
+	inline std::uint8_t lerpPosition(FunscriptAction a, FunscriptAction b, std::uint32_t timeMs) noexcept
+	{
+		if (b.at == a.at) return a.pos;
+		float t = (float)(timeMs - a.at) / (float)(b.at - a.at);
+		return (std::uint8_t)std::clamp((int)std::lround(a.pos + t * ((float)b.pos - (float)a.pos)), 0, 100);
+	}
+
+	inline bool actionBefore(FunscriptAction action, std::uint32_t timeMs) noexcept
+	{
+		return action.at < timeMs;
+	}
+}
+
+float OFS::funscript::averageDistance(const FunscriptArray& actions) noexcept
+{
+	if (actions.size() < 2) return 0.f;
+	float distance = 0.f;
+	for (std::size_t i = 0; i + 1 < actions.size(); ++i) {
+		float dx = actions[i].atS() - actions[i + 1].atS();
+		float dy = (float)actions[i].pos - (float)actions[i + 1].pos;
+		distance += std::sqrt((dx * dx) + (dy * dy));
+	}
+	return distance / (float)(actions.size() - 1);
+}
+
+void OFS::funscript::simplify(const FunscriptArray& actions, float epsilon, FunscriptArray& out) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	out.clear();
+	if (actions.size() < 3) {
+		out = actions;
+		return;
+	}
+
+	std::vector<bool> keep(actions.size(), true);
+	std::vector<std::pair<std::size_t, std::size_t>> stk;
+	stk.emplace_back(0, actions.size() - 1);
+
+	while (!stk.empty()) {
+		auto [startIndex, lastIndex] = stk.back();
+		stk.pop_back();
+
+		float dmax = 0.f;
+		std::size_t index = startIndex;
+		for (std::size_t i = startIndex + 1; i < lastIndex; ++i) {
+			if (keep[i]) {
+				float d = pointLineDistance(actions[i], actions[startIndex], actions[lastIndex]);
+				if (d > dmax) {
+					index = i;
+					dmax = d;
+				}
+			}
+		}
+
+		if (dmax > epsilon) {
+			stk.emplace_back(startIndex, index);
+			stk.emplace_back(index, lastIndex);
+		}
+		else {
+			for (std::size_t i = startIndex + 1; i < lastIndex; ++i) keep[i] = false;
+		}
+	}
+
+	out.reserve(actions.size());
+	for (std::size_t i = 0; i < actions.size(); ++i) {
+		// the input is sorted already
+		if (keep[i]) out.emplace_back_unsorted(actions[i]);
+	}
+}
+
+void OFS::funscript::resample(const FunscriptArray& actions, std::uint32_t intervalMs, FunscriptArray& out) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	out.clear();
+	if (actions.size() < 2 || intervalMs == 0) {
+		out = actions;
+		return;
+	}
+
+	auto first = actions.front().at;
+	auto last = actions.back().at;
+	out.reserve((last - first) / intervalMs + 2);
+
+	std::size_t next = 1;
+	for (std::uint64_t time = first; time < last; time += intervalMs) {
+		while (actions[next].at < time) ++next;
+		auto at = (std::uint32_t)time;
+		out.emplace_back_unsorted(FunscriptAction::FromMs(at, lerpPosition(actions[next - 1], actions[next], at)));
+	}
+	out.emplace_back_unsorted(actions.back());
+}
+
+void OFS::funscript::clip(const FunscriptArray& actions, std::uint32_t fromMs, std::uint32_t toMs, FunscriptArray& out) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	out.clear();
+	if (actions.empty() || fromMs > toMs) return;
+
+	auto begin = std::lower_bound(actions.begin(), actions.end(), fromMs, actionBefore);
+	auto end = std::lower_bound(begin, actions.end(), toMs, actionBefore);
+	bool endOnAction = end != actions.end() && end->at == toMs;
+
+	out.reserve(std::distance(begin, end) + 2);
+	if (begin != actions.begin() && begin != actions.end() && begin->at != fromMs) {
+		out.emplace_back_unsorted(FunscriptAction::FromMs(fromMs, lerpPosition(*(begin - 1), *begin, fromMs)));
+	}
+	for (auto it = begin; it != end; ++it) out.emplace_back_unsorted(*it);
+	if (endOnAction) {
+		out.emplace_back_unsorted(*end);
+	}
+	else if (end != actions.end() && end != actions.begin() && toMs > fromMs) {
+		out.emplace_back_unsorted(FunscriptAction::FromMs(toMs, lerpPosition(*(end - 1), *end, toMs)));
+	}
+}
+
+void OFS::funscript::merge(std::span<const FunscriptArray> scripts, FunscriptArray& out) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	out.clear();
+	std::size_t count = 0;
+	for (auto& script : scripts) count += script.size();
+	out.reserve(count);
+	for (auto& script : scripts) {
+		for (auto action : script) out.emplace_back_unsorted(action);
+	}
+
+	// stable so the first script wins on duplicated timestamps
+	std::stable_sort(out.begin(), out.end());
+	auto last = std::unique(out.begin(), out.end(),
+		[](auto a, auto b) noexcept { return a.at == b.at; });
+	out.erase(last, out.end());
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "FunscriptAction.h"
+
+#include <span>
+#include <cstdint>
+
+// Transformations on plain action arrays shared by the editor and ofs-cli.
+// None of them touch a Funscript so they can run on any thread.
+namespace OFS::funscript
+{
+	// average distance between neighbouring actions in (seconds, position) space
+	float averageDistance(const FunscriptArray& actions) noexcept;
+
+	// Ramer-Douglas-Peucker, drops every action closer than epsilon to the line through its kept neighbours.
+	// The distance is measured in (seconds, position) space.
+	void simplify(const FunscriptArray& actions, float epsilon, FunscriptArray& out) noexcept;
+
+	// Linearly interpolated actions every intervalMs from the first to the last action.
+	// The last action is always kept.
+	void resample(const FunscriptArray& actions, std::uint32_t intervalMs, FunscriptArray& out) noexcept;
+
+	// The actions inside [fromMs, toMs], the positions at both ends are interpolated when there is no action there.
+	void clip(const FunscriptArray& actions, std::uint32_t fromMs, std::uint32_t toMs, FunscriptArray& out) noexcept;
+
+	// Union of all scripts, on equal timestamps the earlier script wins.
+	void merge(std::span<const FunscriptArray> scripts, FunscriptArray& out) noexcept;
+}
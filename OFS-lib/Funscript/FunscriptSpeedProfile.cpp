@@ -0,0 +1,105 @@
+#include "FunscriptSpeedProfile.h"
+#include "OFS_Profiling.h"
+
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+#include <algorithm>
+
+OFS::funscript::SpeedProfile::SpeedProfile(std::uint32_t resolution, float maxSpeedPerSecond) noexcept
+	: maxSpeed(maxSpeedPerSecond),
+	speedSums(resolution, 0.0), coverage(resolution, 0.0),
+	speedSteps(resolution + 1, 0.0), coverageSteps(resolution + 1, 0.0),
+	averages(resolution, 0.f), speeds(resolution, 0.f)
+{
+}
+
+void OFS::funscript::SpeedProfile::addStroke(FunscriptAction prev, FunscriptAction next, std::uint32_t fromSample, std::uint32_t endSample) noexcept
+{
+	double start = std::max(samplePos(prev.at), (double)fromSample);
+	double end = std::min(samplePos(next.at), (double)endSample);
+	if (end <= start) return;
+
+	double speed = std::abs(prev.pos - next.pos) / ((next.at - prev.at) / 1000.0);
+	auto first = (std::uint32_t)start;
+	auto last = (std::uint32_t)end;
+	if (first == last) {
+		speedSums[first] += speed * (end - start);
+		coverage[first] += end - start;
+		return;
+	}
+
+	// partially covered samples at both ends are added directly, everything in between through the difference arrays
+	double head = (first + 1) - start;
+	speedSums[first] += speed * head;
+	coverage[first] += head;
+	speedSteps[first + 1] += speed;
+	speedSteps[last] -= speed;
+	coverageSteps[first + 1] += 1.0;
+	coverageSteps[last] -= 1.0;
+	if (last < endSample) {
+		double tail = end - last;
+		speedSums[last] += speed * tail;
+		coverage[last] += tail;
+	}
+}
+
+OFS::funscript::SpeedProfile::SampleRange OFS::funscript::SpeedProfile::Rebuild(float duration, const FunscriptArray& actions) noexcept
+{
+	totalDuration = duration;
+	if (duration <= 0.f) {
+		samplesPerMs = 0.0;
+		std::fill(speedSums.begin(), speedSums.end(), 0.0);
+		std::fill(coverage.begin(), coverage.end(), 0.0);
+		std::fill(averages.begin(), averages.end(), 0.f);
+		std::fill(speeds.begin(), speeds.end(), 0.f);
+		return { 0, Resolution() };
+	}
+	samplesPerMs = Resolution() / (duration * 1000.0);
+	return Update(actions, 0, std::numeric_limits<std::uint32_t>::max());
+}
+
+OFS::funscript::SpeedProfile::SampleRange OFS::funscript::SpeedProfile::Update(const FunscriptArray& actions, std::uint32_t fromMs, std::uint32_t toMs) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	auto resolution = Resolution();
+	if (samplesPerMs <= 0.0 || fromMs > toMs) return { 0, 0 };
+
+	// Every stroke which changed, before or after the edit, lies between
+	// the closest unchanged actions on both sides of the changed range.
+	auto before = std::lower_bound(actions.begin(), actions.end(), fromMs,
+		[](auto action, std::uint32_t ms) noexcept { return action.at < ms; });
+	auto after = std::upper_bound(before, actions.end(), toMs,
+		[](std::uint32_t ms, auto action) noexcept { return ms < action.at; });
+	double from = samplePos(before != actions.begin() ? (before - 1)->at : fromMs);
+	double to = samplePos(after != actions.end() ? after->at : toMs);
+	if (from >= resolution) return { 0, 0 };
+	auto fromSample = (std::uint32_t)from;
+	auto endSample = (std::uint32_t)std::min(to, (double)(resolution - 1)) + 1;
+
+	std::fill(speedSums.begin() + fromSample, speedSums.begin() + endSample, 0.0);
+	std::fill(coverage.begin() + fromSample, coverage.begin() + endSample, 0.0);
+	std::fill(speedSteps.begin() + fromSample, speedSteps.begin() + endSample + 1, 0.0);
+	std::fill(coverageSteps.begin() + fromSample, coverageSteps.begin() + endSample + 1, 0.0);
+
+	// strokes ending before fromSample don't touch the range
+	auto first = std::partition_point(actions.begin(), actions.end(),
+		[this, fromSample](auto action) noexcept { return samplePos(action.at) <= fromSample; });
+	std::size_t i = first != actions.begin() ? std::distance(actions.begin(), first) - 1 : 0;
+	for (std::size_t j = i + 1, size = actions.size(); j < size; i = j++) {
+		if (samplePos(actions[i].at) >= endSample) break;
+		addStroke(actions[i], actions[j], fromSample, endSample);
+	}
+
+	double speedStep = 0.0;
+	double coverageStep = 0.0;
+	for (std::uint32_t x = fromSample; x < endSample; x += 1) {
+		speedStep += speedSteps[x];
+		coverageStep += coverageSteps[x];
+		speedSums[x] += speedStep;
+		coverage[x] += coverageStep;
+		averages[x] = coverage[x] > 0.0 ? (float)(speedSums[x] / coverage[x]) : 0.f;
+		speeds[x] = std::clamp(averages[x] / maxSpeed, 0.f, 1.f);
+	}
+	return { fromSample, endSample };
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "FunscriptAction.h"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+namespace OFS::funscript
+{
+	// Time weighted average stroke speed for equally sized samples over [0, totalDuration].
+	// Every stroke counts for the exact fraction of a sample it covers, strokes reaching
+	// past either end are clipped instead of dropped. A full build is O(actions + samples).
+	// The per-sample sums are kept so an edit only recomputes the samples its strokes touch.
+	class SpeedProfile
+	{
+	private:
+		float totalDuration = 0.f;
+		float maxSpeed = 1.f;
+		double samplesPerMs = 0.0;
+
+		// speed * covered fraction and covered fraction per sample
+		std::vector<double> speedSums;
+		std::vector<double> coverage;
+		// difference arrays for the samples which are fully covered by a stroke
+		std::vector<double> speedSteps;
+		std::vector<double> coverageSteps;
+
+		std::vector<float> averages;
+		std::vector<float> speeds;
+
+		inline double samplePos(std::uint32_t timeMs) const noexcept { return timeMs * samplesPerMs; }
+		void addStroke(FunscriptAction prev, FunscriptAction next, std::uint32_t fromSample, std::uint32_t endSample) noexcept;
+	public:
+		// first sample and one past the last sample which were recomputed
+		using SampleRange = std::pair<std::uint32_t, std::uint32_t>;
+
+		// maxSpeedPerSecond is the speed which Speeds() maps to 1
+		SpeedProfile(std::uint32_t resolution, float maxSpeedPerSecond) noexcept;
+
+		// Recomputes every sample.
+		SampleRange Rebuild(float totalDuration, const FunscriptArray& actions) noexcept;
+		// Recomputes the samples touched by strokes into, out of or across [fromMs, toMs].
+		// actions is the script after the edit, the range has to cover every action which was added, moved or removed.
+		SampleRange Update(const FunscriptArray& actions, std::uint32_t fromMs, std::uint32_t toMs) noexcept;
+
+		// average speed in units per second, 0 where no stroke covers the sample
+		inline std::span<const float> Averages() const noexcept { return averages; }
+		// speed * covered fraction and covered fraction per sample, summing them up gives exact averages for coarser samples
+		inline std::span<const double> SpeedSums() const noexcept { return speedSums; }
+		inline std::span<const double> Coverage() const noexcept { return coverage; }
+		// averages divided by maxSpeed and clamped to 0..1
+		inline std::span<const float> Speeds() const noexcept { return speeds; }
+		inline float TotalDuration() const noexcept { return totalDuration; }
+		inline std::uint32_t Resolution() const noexcept { return (std::uint32_t)speeds.size(); }
+	};
+}
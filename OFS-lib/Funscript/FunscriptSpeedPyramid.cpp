@@ -0,0 +1,115 @@
+#include "FunscriptSpeedPyramid.h"
+#include "OFS_Profiling.h"
+
+#include <algorithm>
+
+OFS::funscript::SpeedPyramid::SpeedPyramid(std::uint32_t minResolution, float maxSpeedPerSecond) noexcept
+	: minResolution(minResolution), maxSpeed(maxSpeedPerSecond), base(minResolution, maxSpeedPerSecond)
+{
+	allocateLevels();
+}
+
+void OFS::funscript::SpeedPyramid::allocateLevels() noexcept
+{
+	levels.clear();
+	for (auto resolution = base.Resolution(); resolution > 1;) {
+		resolution = (resolution + 1) / 2;
+		auto& level = levels.emplace_back();
+		level.speedSums.resize(resolution, 0.0);
+		level.coverage.resize(resolution, 0.0);
+		level.means.resize(resolution, 0.f);
+		level.maxima.resize(resolution, 0.f);
+	}
+}
+
+void OFS::funscript::SpeedPyramid::updateLevels(SpeedProfile::SampleRange range) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	auto [first, last] = range;
+	if (first >= last) return;
+
+	for (std::size_t l = 0; l < levels.size(); ++l) {
+		first /= 2;
+		last = (last + 1) / 2;
+
+		auto childSums = l == 0 ? base.SpeedSums() : std::span<const double>(levels[l - 1].speedSums);
+		auto childCoverage = l == 0 ? base.Coverage() : std::span<const double>(levels[l - 1].coverage);
+		auto childMaxima = l == 0 ? base.Averages() : std::span<const float>(levels[l - 1].maxima);
+		auto& level = levels[l];
+		for (std::uint32_t i = first; i < last; ++i) {
+			std::size_t left = i * 2;
+			std::size_t right = std::min(left + 1, childSums.size() - 1);
+			double speedSum = childSums[left] + (right != left ? childSums[right] : 0.0);
+			double coverage = childCoverage[left] + (right != left ? childCoverage[right] : 0.0);
+			level.speedSums[i] = speedSum;
+			level.coverage[i] = coverage;
+			level.means[i] = coverage > 0.0 ? (float)(speedSum / coverage) : 0.f;
+			level.maxima[i] = std::max(childMaxima[left], childMaxima[right]);
+		}
+	}
+}
+
+float OFS::funscript::SpeedPyramid::sampleAt(std::span<const float> samples, std::uint32_t level, float time) const noexcept
+{
+	if (time < 0.f || time >= TotalDuration()) return 0.f;
+	auto idx = (std::size_t)(time / SampleDuration(level));
+	return samples[std::min(idx, samples.size() - 1)];
+}
+
+OFS::funscript::SpeedProfile::SampleRange OFS::funscript::SpeedPyramid::Rebuild(float totalDuration, const FunscriptArray& actions) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	std::uint32_t shift = 0;
+	while (shift < MaxBaseShift && totalDuration / (float)(minResolution << shift) > BaseSampleDuration) {
+		shift += 1;
+	}
+	if ((minResolution << shift) != base.Resolution()) {
+		base = SpeedProfile(minResolution << shift, maxSpeed);
+		allocateLevels();
+	}
+
+	auto range = base.Rebuild(totalDuration, actions);
+	updateLevels(range);
+	return range;
+}
+
+OFS::funscript::SpeedProfile::SampleRange OFS::funscript::SpeedPyramid::Update(const FunscriptArray& actions, std::uint32_t fromMs, std::uint32_t toMs) noexcept
+{
+	auto range = base.Update(actions, fromMs, toMs);
+	updateLevels(range);
+	return range;
+}
+
+std::span<const float> OFS::funscript::SpeedPyramid::Means(std::uint32_t level) const noexcept
+{
+	return level == 0 ? base.Averages() : std::span<const float>(levels[level - 1].means);
+}
+
+std::span<const float> OFS::funscript::SpeedPyramid::Maxima(std::uint32_t level) const noexcept
+{
+	return level == 0 ? base.Averages() : std::span<const float>(levels[level - 1].maxima);
+}
+
+std::uint32_t OFS::funscript::SpeedPyramid::LevelForResolution(std::uint32_t resolution) const noexcept
+{
+	std::uint32_t level = 0;
+	while (level + 1 < LevelCount() && Resolution(level) > resolution) level += 1;
+	return level;
+}
+
+std::uint32_t OFS::funscript::SpeedPyramid::LevelForPixel(float secondsPerPixel) const noexcept
+{
+	std::uint32_t level = 0;
+	while (level + 1 < LevelCount() && SampleDuration(level) < secondsPerPixel) level += 1;
+	return level;
+}
+
+OFS::funscript::SpeedProfile::SampleRange OFS::funscript::SpeedPyramid::LevelRange(std::uint32_t level, SpeedProfile::SampleRange baseRange) const noexcept
+{
+	auto [first, last] = baseRange;
+	for (std::uint32_t l = 0; l < level; ++l) {
+		first /= 2;
+		last = (last + 1) / 2;
+	}
+	return { first, last };
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "FunscriptSpeedProfile.h"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace OFS::funscript
+{
+	// Mean and maximum speed at every power of two resolution below a fine SpeedProfile.
+	// Level 0 is the profile itself, each level above halves the resolution. Zoomed views
+	// pick the level which has about one sample per pixel and read it in O(1) per pixel.
+	// Edits only recompute the changed samples on every level.
+	class SpeedPyramid
+	{
+	private:
+		struct Level
+		{
+			std::vector<double> speedSums;
+			std::vector<double> coverage;
+			std::vector<float> means;
+			std::vector<float> maxima;
+		};
+
+		std::uint32_t minResolution = 0;
+		float maxSpeed = 1.f;
+		SpeedProfile base;
+		// levels[0] is level 1, level 0 is read from the base profile
+		std::vector<Level> levels;
+
+		void allocateLevels() noexcept;
+		void updateLevels(SpeedProfile::SampleRange range) noexcept;
+		float sampleAt(std::span<const float> samples, std::uint32_t level, float time) const noexcept;
+	public:
+		// level 0 is made fine enough for samples of at most this many seconds
+		static constexpr float BaseSampleDuration = 0.1f;
+		// limits level 0 to minResolution << MaxBaseShift samples for very long videos
+		static constexpr std::uint32_t MaxBaseShift = 8;
+
+		// minResolution is the resolution of level 0 for short scripts, maxSpeedPerSecond is passed to the profile
+		SpeedPyramid(std::uint32_t minResolution, float maxSpeedPerSecond) noexcept;
+
+		// Recomputes every level, level 0 is resized when the duration needs a different resolution.
+		SpeedProfile::SampleRange Rebuild(float totalDuration, const FunscriptArray& actions) noexcept;
+		// Same as SpeedProfile::Update. Returns the changed samples on level 0, see LevelRange for the other levels.
+		SpeedProfile::SampleRange Update(const FunscriptArray& actions, std::uint32_t fromMs, std::uint32_t toMs) noexcept;
+
+		inline std::uint32_t LevelCount() const noexcept { return (std::uint32_t)levels.size() + 1; }
+		inline std::uint32_t Resolution(std::uint32_t level) const noexcept { return (std::uint32_t)Means(level).size(); }
+		inline float SampleDuration(std::uint32_t level) const noexcept { return base.TotalDuration() / (float)Resolution(level); }
+		inline float TotalDuration() const noexcept { return base.TotalDuration(); }
+
+		// time weighted mean speed in units per second
+		std::span<const float> Means(std::uint32_t level) const noexcept;
+		// fastest level 0 sample covered by each sample
+		std::span<const float> Maxima(std::uint32_t level) const noexcept;
+
+		// the finest level with at most resolution samples
+		std::uint32_t LevelForResolution(std::uint32_t resolution) const noexcept;
+		// the finest level whose samples are at least secondsPerPixel long
+		std::uint32_t LevelForPixel(float secondsPerPixel) const noexcept;
+		// the samples of level which cover a range of level 0 samples
+		SpeedProfile::SampleRange LevelRange(std::uint32_t level, SpeedProfile::SampleRange baseRange) const noexcept;
+
+		inline float MeanAt(std::uint32_t level, float time) const noexcept { return sampleAt(Means(level), level, time); }
+		inline float MaxAt(std::uint32_t level, float time) const noexcept { return sampleAt(Maxima(level), level, time); }
+	};
+}
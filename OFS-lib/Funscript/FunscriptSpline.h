@@ -2,92 +2,172 @@
 #include "OFS_Profiling.h"
 #include "FunscriptAction.h"
 
-//#include "glm/gtx/spline.hpp"
-
 #include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
 
 
-// QQQ
+// Catmull-Rom spline through the action positions.
+// The cubic coefficients of every segment are cached and only
+// the segments touched by an edit get recomputed on the next sample.
 class FunscriptSpline
 {
+	// p(t) = ((a * t + b) * t + c) * t + d with t in [0, 1] between two actions
+	struct Segment
+	{
+		float a, b, c, d;
+		inline float Evaluate(float t) const noexcept { return ((a * t + b) * t + c) * t + d; }
+	};
+
+	std::vector<Segment> segments;
 	int32_t cacheIdx = 0;
+
+	// actions in [dirtyFromMs, dirtyToMs] changed since the last rebuild
+	std::uint32_t dirtyFromMs = 0;
+	std::uint32_t dirtyToMs = 0;
+	bool dirty = true;
+	bool fullRebuild = true;
+
+	static inline Segment computeSegment(float v0, float v1, float v2, float v3) noexcept
+	{
+		Segment s;
+		s.a = 0.5f * (-v0 + 3.f * v1 - 3.f * v2 + v3);
+		s.b = 0.5f * (2.f * v0 - 5.f * v1 + 4.f * v2 - v3);
+		s.c = 0.5f * (-v0 + v2);
+		s.d = v1;
+		return s;
+	}
+
+	static inline Segment computeSegment(const FunscriptArray& actions, int32_t i, bool flat) noexcept
+	{
+		const int32_t last = (int32_t)actions.size() - 1;
+		int32_t i0 = std::clamp(i - 1, 0, last);
+		int32_t i1 = std::clamp(i, 0, last);
+		int32_t i2 = std::clamp(i + 1, 0, last);
+		int32_t i3 = std::clamp(i + 2, 0, last);
+
+		if (flat && actions[i1].pos == actions[i2].pos) {
+			return Segment{ 0.f, 0.f, 0.f, actions[i1].pos / 100.f };
+		}
+		return computeSegment(actions[i0].pos / 100.f, actions[i1].pos / 100.f,
+			actions[i2].pos / 100.f, actions[i3].pos / 100.f);
+	}
+
+	static inline float segmentProgress(const FunscriptArray& actions, int32_t i, float time) noexcept
+	{
+		double duration = (double)actions[i + 1].at - (double)actions[i].at;
+		if (duration <= 0.0) return 0.f;
+		return (float)((time * 1000.0 - actions[i].at) / duration);
+	}
+
+	void rebuild(const FunscriptArray& actions) noexcept
+	{
+		OFS_PROFILE(__FUNCTION__);
+		const std::size_t newCount = actions.size() > 1 ? actions.size() - 1 : 0;
+		const std::size_t oldCount = segments.size();
+		std::size_t lo = 0;
+		std::size_t hi = newCount;
+
+		if (!fullRebuild && oldCount > 0 && newCount > 0) {
+			// Segment i depends on the actions i-1 to i+2.
+			// Everything before the dirty range keeps its index,
+			// everything after it only shifts by the change in size.
+			std::size_t firstDirty = std::distance(actions.begin(),
+				actions.lower_bound(FunscriptAction::FromMs(dirtyFromMs, 0)));
+			std::size_t lastDirty = std::distance(actions.begin(),
+				actions.upper_bound(FunscriptAction::FromMs(dirtyToMs, 0)));
+			lo = firstDirty > 2 ? firstDirty - 2 : 0;
+			hi = std::min(lastDirty + 1, newCount);
+
+			if (newCount > oldCount) {
+				auto grow = newCount - oldCount;
+				segments.insert(segments.begin() + (hi - grow), grow, Segment{});
+			}
+			else if (newCount < oldCount) {
+				auto shrink = oldCount - newCount;
+				segments.erase(segments.begin() + hi, segments.begin() + hi + shrink);
+			}
+		}
+		else {
+			segments.resize(newCount);
+		}
+
+		for (std::size_t i = lo; i < hi; ++i) {
+			segments[i] = computeSegment(actions, (int32_t)i, true);
+		}
+
+		dirty = false;
+		fullRebuild = false;
+	}
+
 public:
 	static inline float catmull_rom_spline(const FunscriptArray& actions, int32_t i, float time) noexcept
 	{
 		OFS_PROFILE(__FUNCTION__);
-		//int i0 = glm::clamp<int>(i - 1, 0, actions.size() - 1);
-		//int i1 = glm::clamp<int>(i, 0, actions.size() - 1);
-		//int i2 = glm::clamp<int>(i + 1, 0, actions.size() - 1);
-		//int i3 = glm::clamp<int>(i + 2, 0, actions.size() - 1);
-
-		//glm::vec1 v0(actions[i0].pos / 100.f);
-		//glm::vec1 v1(actions[i1].pos / 100.f);
-		//glm::vec1 v2(actions[i2].pos / 100.f);
-		//glm::vec1 v3(actions[i3].pos / 100.f);
-		//
-		//time -= actions[i1].atS;
-		//time /= actions[i2].atS - actions[i1].atS;
-
-		//return glm::catmullRom(v0, v1, v2, v3, time).x;
-		return time;
+		return computeSegment(actions, i, false).Evaluate(segmentProgress(actions, i, time));
 	}
 
 	static inline float catmul_rom_spline_alt(const FunscriptArray& actions, int32_t i, float time) noexcept
 	{
 		OFS_PROFILE(__FUNCTION__);
-		//int i0 = glm::clamp<int>(i - 1, 0, actions.size() - 1);
-		//int i1 = glm::clamp<int>(i, 0, actions.size() - 1);
-		//int i2 = glm::clamp<int>(i + 1, 0, actions.size() - 1);
-		//int i3 = glm::clamp<int>(i + 2, 0, actions.size() - 1);
-
-		//if(actions[i1].pos == actions[i2].pos) return actions[i1].pos / 100.f;
-
-		//glm::vec1 v0(actions[i0].pos / 100.f);
-		//glm::vec1 v1(actions[i1].pos / 100.f);
-		//glm::vec1 v2(actions[i2].pos / 100.f);
-		//glm::vec1 v3(actions[i3].pos / 100.f);
-		//
-		//time -= actions[i1].atS;
-		//time /= actions[i2].atS - actions[i1].atS;
-
-		//return glm::catmullRom(v0, v1, v2, v3, time).x;
-		return time;
+		return computeSegment(actions, i, true).Evaluate(segmentProgress(actions, i, time));
+	}
+
+	// Marks the actions in [fromMs, toMs] as changed.
+	inline void Invalidate(std::uint32_t fromMs, std::uint32_t toMs) noexcept
+	{
+		if (!dirty) {
+			dirtyFromMs = fromMs;
+			dirtyToMs = toMs;
+			dirty = true;
+		}
+		else {
+			dirtyFromMs = std::min(dirtyFromMs, fromMs);
+			dirtyToMs = std::max(dirtyToMs, toMs);
+		}
 	}
 
-	inline float Sample(const FunscriptArray& actions, float time) noexcept 
+	inline void InvalidateAll() noexcept
+	{
+		dirty = true;
+		fullRebuild = true;
+	}
+
+	inline float Sample(const FunscriptArray& actions, float time) noexcept
 	{
 		OFS_PROFILE(__FUNCTION__);
 		if (actions.size() == 0) { return 0.f; }
 		else if (actions.size() == 1) { return actions.front().pos / 100.f; }
 		else if (cacheIdx + 1 >= actions.size()) { cacheIdx = 0; }
 
-		if (actions[cacheIdx].atS <= time && actions[cacheIdx + 1].atS >= time) {
+		if (dirty) rebuild(actions);
+
+		const double timeMs = time * 1000.0;
+		if (actions[cacheIdx].at <= timeMs && actions[cacheIdx + 1].at >= timeMs) {
 			// cache hit!
-			return catmul_rom_spline_alt(actions, cacheIdx, time);
 		}
-		else if (cacheIdx + 2 < actions.size() && actions[cacheIdx+1].atS <= time && actions[cacheIdx+2].atS >= time) {
+		else if (cacheIdx + 2 < actions.size() && actions[cacheIdx + 1].at <= timeMs && actions[cacheIdx + 2].at >= timeMs) {
 			// sort of a cache hit
 			cacheIdx += 1;
-			return catmul_rom_spline_alt(actions, cacheIdx, time);
 		}
 		else {
 			// cache miss
 			// lookup index
 			auto it = actions.upper_bound(FunscriptAction(time, 0));
-			if (it == actions.end()) { 
-				return actions.back().pos / 100.f; 
+			if (it == actions.end()) {
+				return actions.back().pos / 100.f;
 			}
-			else if (it == actions.begin())			{
+			else if (it == actions.begin()) {
 				return actions.front().pos / 100.f;
 			}
 
 			it--;
 			// cache index
 			cacheIdx = std::distance(actions.begin(), it);
-			return catmul_rom_spline_alt(actions, cacheIdx, time);
 		}
 
-		return 0.f;
+		return segments[cacheIdx].Evaluate(segmentProgress(actions, cacheIdx, time));
 	}
 
 	inline static float SampleAtIndex(const FunscriptArray& actions, int32_t index, float time) noexcept
@@ -95,11 +175,11 @@ public:
 		OFS_PROFILE(__FUNCTION__);
 		if (actions.empty()) { return 0.f; }
 		if (index + 1 < actions.size())	{
-			if (actions[index].atS <= time && actions[index + 1].atS >= time) {
+			if (actions[index].atS() <= time && actions[index + 1].atS() >= time) {
 				return catmull_rom_spline(actions, index, time);
 			}
 		}
 
 		return actions.back().pos / 100.f;
 	}
-};
\ No newline at end of file
+};
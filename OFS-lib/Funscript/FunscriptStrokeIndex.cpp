@@ -0,0 +1,118 @@
+#include "FunscriptStrokeIndex.h"
+#include "OFS_Profiling.h"
+
+#include <algorithm>
+
+namespace
+{
+	inline int direction(std::uint8_t from, std::uint8_t to) noexcept
+	{
+		return (to > from) - (to < from);
+	}
+
+	inline bool extremumBefore(const FunscriptStrokeIndex::Extremum& a, std::uint32_t at) noexcept
+	{
+		return a.at < at;
+	}
+
+	inline bool extremumAfter(std::uint32_t at, const FunscriptStrokeIndex::Extremum& a) noexcept
+	{
+		return at < a.at;
+	}
+}
+
+std::optional<FunscriptStrokeIndex::Extremum> FunscriptStrokeIndex::classify(const FunscriptArray& actions, std::size_t idx) noexcept
+{
+	const auto& action = actions[idx];
+	int in = idx > 0 ? direction(actions[idx - 1].pos, action.pos) : 0;
+	int out = idx + 1 < actions.size() ? direction(action.pos, actions[idx + 1].pos) : 0;
+	bool edge = idx == 0 || idx + 1 == actions.size();
+	if (in == out && !edge) return std::nullopt;
+
+	ExtremumType type = ExtremumType::None;
+	if (in >= 0 && out <= 0 && in != out) type = ExtremumType::Peak;
+	else if (in <= 0 && out >= 0 && in != out) type = ExtremumType::Valley;
+	return Extremum{ action.at, action.pos, type };
+}
+
+void FunscriptStrokeIndex::Invalidate(std::uint32_t fromMs, std::uint32_t toMs) noexcept
+{
+	if (!dirty) {
+		dirtyFromMs = fromMs;
+		dirtyToMs = toMs;
+		dirty = true;
+	}
+	else {
+		dirtyFromMs = std::min(dirtyFromMs, fromMs);
+		dirtyToMs = std::max(dirtyToMs, toMs);
+	}
+}
+
+void FunscriptStrokeIndex::Update(const FunscriptArray& actions) noexcept
+{
+	if (!dirty) return;
+	OFS_PROFILE(__FUNCTION__);
+
+	if (fullRebuild || actions.empty()) {
+		extrema.clear();
+		for (std::size_t i = 0; i < actions.size(); ++i) {
+			if (auto extremum = classify(actions, i)) extrema.emplace_back(*extremum);
+		}
+	}
+	else {
+		// An action is classified by its direct neighbours so besides the
+		// changed actions only the ones next to them need another look.
+		std::size_t first = std::distance(actions.begin(), actions.lower_bound(FunscriptAction::FromMs(dirtyFromMs, 0)));
+		std::size_t last = std::distance(actions.begin(), actions.upper_bound(FunscriptAction::FromMs(dirtyToMs, 0)));
+		std::size_t lo = first > 0 ? first - 1 : 0;
+		std::size_t hi = std::min(last + 1, actions.size());
+
+		std::uint32_t eraseFrom = std::min(dirtyFromMs, actions[lo].at);
+		std::uint32_t eraseTo = std::max(dirtyToMs, actions[hi - 1].at);
+		auto eraseBegin = std::lower_bound(extrema.begin(), extrema.end(), eraseFrom, extremumBefore);
+		auto eraseEnd = std::upper_bound(eraseBegin, extrema.end(), eraseTo, extremumAfter);
+
+		std::vector<Extremum> updated;
+		for (std::size_t i = lo; i < hi; ++i) {
+			if (auto extremum = classify(actions, i)) updated.emplace_back(*extremum);
+		}
+		auto it = extrema.erase(eraseBegin, eraseEnd);
+		extrema.insert(it, updated.begin(), updated.end());
+	}
+
+	dirty = false;
+	fullRebuild = false;
+}
+
+std::span<const FunscriptStrokeIndex::Extremum> FunscriptStrokeIndex::ExtremaInRange(std::uint32_t fromMs, std::uint32_t toMs) const noexcept
+{
+	auto begin = std::lower_bound(extrema.begin(), extrema.end(), fromMs, extremumBefore);
+	auto end = std::upper_bound(begin, extrema.end(), toMs, extremumAfter);
+	return std::span<const Extremum>(begin, end);
+}
+
+bool FunscriptStrokeIndex::IsExtremum(std::uint32_t at, ExtremumType type) const noexcept
+{
+	auto it = std::lower_bound(extrema.begin(), extrema.end(), at, extremumBefore);
+	return it != extrema.end() && it->at == at && it->type == type;
+}
+
+std::optional<FunscriptStrokeIndex::Stroke> FunscriptStrokeIndex::StrokeAt(std::uint32_t timeMs) const noexcept
+{
+	if (extrema.size() < 2) return std::nullopt;
+	auto end = std::lower_bound(extrema.begin(), extrema.end(), timeMs, extremumBefore);
+	if (end == extrema.end()) return std::nullopt;
+	if (end == extrema.begin()) {
+		// a time on the first action belongs to the first stroke
+		if (end->at != timeMs) return std::nullopt;
+		++end;
+	}
+	return Stroke{ (end - 1)->at, end->at, (end - 1)->pos, end->pos };
+}
+
+std::optional<FunscriptStrokeIndex::Stroke> FunscriptStrokeIndex::PreviousStroke(Stroke stroke) const noexcept
+{
+	auto start = std::lower_bound(extrema.begin(), extrema.end(), stroke.fromMs, extremumBefore);
+	if (start == extrema.end() || start == extrema.begin()) return std::nullopt;
+	return Stroke{ (start - 1)->at, start->at, (start - 1)->pos, start->pos };
+}
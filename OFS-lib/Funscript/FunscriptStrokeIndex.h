@@ -0,0 +1,72 @@
+#pragma once
+#include "FunscriptAction.h"
+
+#include <span>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <optional>
+
+// Segments a script into monotonic strokes.
+// A stroke runs between two consecutive turning points, the actions in between
+// all move in the same direction (up, down or flat).
+// The turning points are kept sorted by time and only the ones
+// around changed actions get reclassified on the next update.
+class FunscriptStrokeIndex
+{
+public:
+	enum class ExtremumType : std::uint8_t
+	{
+		None, // first or last action without a change in position next to it
+		Peak,
+		Valley
+	};
+
+	struct Extremum
+	{
+		std::uint32_t at;
+		std::uint8_t pos;
+		ExtremumType type;
+	};
+
+	struct Stroke
+	{
+		std::uint32_t fromMs;
+		std::uint32_t toMs;
+		std::uint8_t fromPos;
+		std::uint8_t toPos;
+
+		inline bool IsHold() const noexcept { return fromPos == toPos; }
+	};
+
+private:
+	std::vector<Extremum> extrema;
+
+	// actions in [dirtyFromMs, dirtyToMs] changed since the last update
+	std::uint32_t dirtyFromMs = 0;
+	std::uint32_t dirtyToMs = 0;
+	bool dirty = true;
+	bool fullRebuild = true;
+
+	static std::optional<Extremum> classify(const FunscriptArray& actions, std::size_t idx) noexcept;
+
+public:
+	// Marks the actions in [fromMs, toMs] as changed.
+	void Invalidate(std::uint32_t fromMs, std::uint32_t toMs) noexcept;
+	inline void InvalidateAll() noexcept
+	{
+		dirty = true;
+		fullRebuild = true;
+	}
+	void Update(const FunscriptArray& actions) noexcept;
+
+	// all turning points sorted by time, the first and last action are always included
+	inline const std::vector<Extremum>& Extrema() const noexcept { return extrema; }
+	// turning points in [fromMs, toMs]
+	std::span<const Extremum> ExtremaInRange(std::uint32_t fromMs, std::uint32_t toMs) const noexcept;
+	bool IsExtremum(std::uint32_t at, ExtremumType type) const noexcept;
+
+	// the stroke containing timeMs, a time on a turning point belongs to the stroke ending there
+	std::optional<Stroke> StrokeAt(std::uint32_t timeMs) const noexcept;
+	std::optional<Stroke> PreviousStroke(Stroke stroke) const noexcept;
+};
@@ -0,0 +1,58 @@
+#include "FunscriptTimeIndex.h"
+#include "OFS_Profiling.h"
+
+#include <bit>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define OFS_PREFETCH(ptr) _mm_prefetch((const char*)(ptr), _MM_HINT_T0)
+#else
+#define OFS_PREFETCH(ptr) __builtin_prefetch(ptr)
+#endif
+
+namespace
+{
+	// Fills keys in breadth first order from an in-order walk of the implicit tree.
+	std::size_t fillEytzinger(const FunscriptArray& actions, std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& ranks, std::size_t i, std::size_t k) noexcept
+	{
+		if (k < keys.size()) {
+			i = fillEytzinger(actions, keys, ranks, i, 2 * k);
+			keys[k] = actions[i].at;
+			ranks[k] = (std::uint32_t)i;
+			++i;
+			i = fillEytzinger(actions, keys, ranks, i, 2 * k + 1);
+		}
+		return i;
+	}
+}
+
+void FunscriptTimeIndex::rebuild(const FunscriptArray& actions) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	keys.resize(actions.size() + 1);
+	ranks.resize(actions.size() + 1);
+	fillEytzinger(actions, keys, ranks, 0, 1);
+	dirty = false;
+}
+
+std::size_t FunscriptTimeIndex::LowerBound(const FunscriptArray& actions, std::uint32_t atMs) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	if (actions.size() < MinIndexedSize) {
+		auto it = actions.lower_bound(FunscriptAction::FromMs(atMs, 0));
+		return std::distance(actions.begin(), it);
+	}
+	if (dirty) rebuild(actions);
+
+	// 16 keys per cache line, prefetch the line holding the descendants four levels down
+	const std::size_t n = actions.size();
+	std::size_t k = 1;
+	while (k <= n) {
+		OFS_PREFETCH(keys.data() + std::min(16 * k, n));
+		k = 2 * k + (keys[k] < atMs);
+	}
+	// strip the trailing right turns and the last left turn
+	k >>= std::countr_one(k) + 1;
+	return k == 0 ? n : ranks[k];
+}
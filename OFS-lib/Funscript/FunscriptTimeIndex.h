@@ -0,0 +1,35 @@
+#pragma once
+#include "FunscriptAction.h"
+
+#include <vector>
+#include <cstdint>
+
+// Secondary search index over the action timestamps.
+// The keys are stored in Eytzinger (breadth first) order so the first levels
+// of every search share a handful of cache lines and the next levels can be
+// prefetched ahead of time. The index is rebuilt lazily on the first search
+// after an edit, small scripts are searched directly.
+class FunscriptTimeIndex
+{
+	// below this a plain binary search fits in cache anyway
+	static constexpr std::size_t MinIndexedSize = 4096;
+
+	// 1-based, keys[0] is unused
+	std::vector<std::uint32_t> keys;
+	// sorted index for every key
+	std::vector<std::uint32_t> ranks;
+	bool dirty = true;
+
+	void rebuild(const FunscriptArray& actions) noexcept;
+
+public:
+	inline void Invalidate() noexcept { dirty = true; }
+
+	// index of the first action with at >= atMs, actions.size() if there is none
+	std::size_t LowerBound(const FunscriptArray& actions, std::uint32_t atMs) noexcept;
+	// index of the first action with at > atMs, actions.size() if there is none
+	inline std::size_t UpperBound(const FunscriptArray& actions, std::uint32_t atMs) noexcept
+	{
+		return atMs == UINT32_MAX ? actions.size() : LowerBound(actions, atMs + 1);
+	}
+};
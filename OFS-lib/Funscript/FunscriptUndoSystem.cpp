@@ -1,19 +1,141 @@
 #include "FunscriptUndoSystem.h"
+#include "OFS_Util.h"
+
+#include <chrono>
+#include <format>
+#include <algorithm>
 
 void FunscriptUndoSystem::ClearRedo() noexcept
 {
 	RedoStack.clear();
 }
 
-void FunscriptUndoSystem::SnapshotRedo(int32_t type) noexcept
+void FunscriptUndoSystem::finishPendingState() noexcept
+{
+	if (!hasPendingState) return;
+	OFS_PROFILE(__FUNCTION__);
+	FUN_ASSERT(!UndoStack.empty(), "pending state without undo entry");
+	UndoStack.back().delta = script->DiffTo(pendingState);
+	pendingState = {};
+	hasPendingState = false;
+}
+
+void FunscriptUndoSystem::compressOldSteps() noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	for (; compressedCount + UncompressedSteps < UndoStack.size(); ++compressedCount) {
+		auto& state = UndoStack[compressedCount];
+		if (state.storage != ScriptState::Storage::Delta) continue;
+
+		auto packed = state.delta.Pack();
+		if (!OFS::util::compressBytes(packed, state.compressed)) {
+			// stays resident
+			state.compressed = {};
+			continue;
+		}
+		state.compressed.shrink_to_fit();
+		state.packedSize = (std::uint32_t)packed.size();
+		state.compressedSize = (std::uint32_t)state.compressed.size();
+		state.delta = {};
+		state.storage = ScriptState::Storage::Compressed;
+	}
+}
+
+bool FunscriptUndoSystem::loadDelta(ScriptState& state) noexcept
+{
+	if (state.storage == ScriptState::Storage::Delta) return true;
+	OFS_PROFILE(__FUNCTION__);
+
+	if (state.storage == ScriptState::Storage::Spilled) {
+		state.compressed.resize(state.compressedSize);
+		spillFile.seekg(state.spillOffset);
+		spillFile.read(reinterpret_cast<char*>(state.compressed.data()), state.compressedSize);
+		bool ok = spillFile.good();
+		spillFile.clear();
+
+		spilledBytes -= state.compressedSize;
+		spilledCount -= 1;
+		if (spilledCount == 0) closeSpillFile();
+		if (!ok) {
+			LOG_ERROR("Failed to read undo step from the spill file.");
+			return false;
+		}
+		state.storage = ScriptState::Storage::Compressed;
+	}
+
+	std::vector<std::uint8_t> packed;
+	bool ok = OFS::util::decompressBytes(state.compressed, packed, state.packedSize)
+		&& Funscript::FunscriptDelta::Unpack(packed, state.delta);
+	state.compressed = {};
+	state.storage = ScriptState::Storage::Delta;
+	if (!ok) {
+		LOG_ERROR("Failed to decompress undo step.");
+		state.delta = {};
+	}
+	return ok;
+}
+
+std::size_t FunscriptUndoSystem::SpillOldest(std::size_t bytes, const std::filesystem::path& spillDir) noexcept
+{
+	OFS_PROFILE(__FUNCTION__);
+	std::size_t freed = 0;
+	for (std::size_t i = 0; i < compressedCount && freed < bytes; ++i) {
+		auto& state = UndoStack[i];
+		if (state.storage != ScriptState::Storage::Compressed) continue;
+
+		if (!spillFile.is_open()) {
+			OFS::util::createDirectories(spillDir);
+			auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+			spillPath = spillDir / std::format("undo_{:x}_{:x}.tmp", ticks, reinterpret_cast<std::uintptr_t>(this));
+			spillFile = OFS::util::openFile(spillPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+			spillFileSize = 0;
+			if (!spillFile.is_open()) {
+				LOGF_ERROR("Failed to create undo spill file: \"{:s}\"", spillPath.string());
+				spillPath.clear();
+				break;
+			}
+		}
+
+		spillFile.seekp(spillFileSize);
+		spillFile.write(reinterpret_cast<const char*>(state.compressed.data()), state.compressedSize);
+		if (!spillFile.good()) {
+			spillFile.clear();
+			LOG_ERROR("Failed to write to the undo spill file.");
+			break;
+		}
+
+		freed += state.compressed.capacity();
+		state.compressed = {};
+		state.spillOffset = spillFileSize;
+		state.storage = ScriptState::Storage::Spilled;
+		spillFileSize += state.compressedSize;
+		spilledBytes += state.compressedSize;
+		spilledCount += 1;
+	}
+	if (freed > 0) spillFile.flush();
+	return freed;
+}
+
+void FunscriptUndoSystem::closeSpillFile() noexcept
 {
-	RedoStack.emplace_back(std::move(ScriptState(type, script->Data())));
+	if (spillFile.is_open()) spillFile.close();
+	if (!spillPath.empty()) {
+		std::error_code ec;
+		std::filesystem::remove(spillPath, ec);
+		spillPath.clear();
+	}
+	spillFileSize = 0;
 }
 
 void FunscriptUndoSystem::Snapshot(int32_t type, bool clearRedo) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
-	UndoStack.emplace_back(std::move(ScriptState(type, script->Data())));
+	finishPendingState();
+	compressOldSteps();
+	// blocks are shared with the script so this is cheap until the next edit
+	pendingState = script->TakeSnapshot();
+	hasPendingState = true;
+	UndoStack.emplace_back(type);
 
 	// redo gets cleared after every snapshot
 	if (clearRedo)
@@ -24,18 +146,58 @@ bool FunscriptUndoSystem::Undo() noexcept
 {
 	if (UndoStack.empty()) return false;
 	OFS_PROFILE(__FUNCTION__);
-	SnapshotRedo(UndoStack.back().type); // copy data to redo
-	script->Rollback(std::move(UndoStack.back().Data())); // move data
+	finishPendingState();
+	bool loaded = loadDelta(UndoStack.back());
+	if (loaded) {
+		auto before = script->TakeSnapshot();
+		script->ApplyDelta(UndoStack.back().delta);
+		RedoStack.emplace_back(UndoStack.back().type, script->DiffTo(before));
+	}
 	UndoStack.pop_back(); // pop of the stack
-	return true;
+	compressedCount = std::min(compressedCount, UndoStack.size());
+	return loaded;
 }
 
 bool FunscriptUndoSystem::Redo() noexcept
 {
 	if (RedoStack.empty()) return false;
 	OFS_PROFILE(__FUNCTION__);
-	Snapshot(RedoStack.back().type, false); // copy data to undo
-	script->Rollback(std::move(RedoStack.back().Data())); // move data
+	finishPendingState();
+	auto before = script->TakeSnapshot();
+	script->ApplyDelta(RedoStack.back().delta);
+	UndoStack.emplace_back(RedoStack.back().type, script->DiffTo(before));
 	RedoStack.pop_back(); // pop of the stack
+	compressOldSteps();
+	return true;
+}
+
+bool FunscriptUndoSystem::Amend() noexcept
+{
+	if (UndoStack.empty()) return false;
+	OFS_PROFILE(__FUNCTION__);
+	if (hasPendingState) {
+		// the pending state is kept, only the live result gets reverted
+		script->ApplyDelta(script->DiffTo(pendingState));
+		return true;
+	}
+
+	auto& state = UndoStack.back();
+	if (!loadDelta(state)) return false;
+	script->ApplyDelta(state.delta);
+	state.delta = {};
+	compressedCount = std::min(compressedCount, UndoStack.size() - 1);
+	pendingState = script->TakeSnapshot();
+	hasPendingState = true;
 	return true;
-}
\ No newline at end of file
+}
+
+UndoMemoryUsage FunscriptUndoSystem::MemoryUsage() const noexcept
+{
+	UndoMemoryUsage usage;
+	usage.ResidentBytes = (UndoStack.capacity() + RedoStack.capacity()) * sizeof(ScriptState);
+	for (auto& state : UndoStack) usage.ResidentBytes += state.ResidentBytes();
+	for (auto& state : RedoStack) usage.ResidentBytes += state.ResidentBytes();
+	if (hasPendingState) usage.ResidentBytes += pendingState.Selection.memoryUsage();
+	usage.SpilledBytes = spilledBytes;
+	return usage;
+}
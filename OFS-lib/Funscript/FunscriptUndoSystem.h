@@ -2,43 +2,102 @@
 #include "Funscript.h"
 
 #include <vector>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
 
+// An undo/redo step only stores the delta back to the state it restores.
+// Older undo steps get deflated and can be moved out to a spill file.
 class ScriptState {
+	friend class FunscriptUndoSystem;
+public:
+	enum class Storage : std::uint8_t
+	{
+		Delta,
+		Compressed,
+		Spilled
+	};
+
 private:
-	Funscript::FunscriptData data;
+	Funscript::FunscriptDelta delta;
+	// deflated delta, empty once it was spilled
+	std::vector<std::uint8_t> compressed;
+	std::uint64_t spillOffset = 0;
+	std::uint32_t compressedSize = 0;
+	std::uint32_t packedSize = 0;
+	Storage storage = Storage::Delta;
+
 public:
-	inline Funscript::FunscriptData& Data() { return data; }
 	int32_t type;
 	const char* Description() const noexcept;
 
 	ScriptState() noexcept 
 		: type(-1) {}
-	ScriptState(int32_t type, const Funscript::FunscriptData& data) noexcept
-		: type(type), data(data) {}
+	ScriptState(int32_t type, Funscript::FunscriptDelta&& delta = {}) noexcept
+		: type(type), delta(std::move(delta)) {}
+
+	inline Storage StoredAs() const noexcept { return storage; }
+	// heap memory held by this step
+	inline std::size_t ResidentBytes() const noexcept { return delta.MemoryUsage() + compressed.capacity(); }
+};
+
+struct UndoMemoryUsage
+{
+	std::size_t ResidentBytes = 0;
+	std::size_t SpilledBytes = 0;
 };
 
 class FunscriptUndoSystem
 {
 	friend class UndoSystem;
 
+	// the most recent undo steps are kept as plain deltas
+	static constexpr std::size_t UncompressedSteps = 32;
+
 	Funscript* script = nullptr;
-	void SnapshotRedo(int32_t type) noexcept;
 	
 	std::vector<ScriptState> UndoStack;
 	std::vector<ScriptState> RedoStack;
 
+	// State before the edit belonging to the top of the undo stack.
+	// It gets turned into a delta once the edit is over.
+	Funscript::FunscriptSnapshot pendingState;
+	bool hasPendingState = false;
+	void finishPendingState() noexcept;
+
+	// undo steps below this index are compressed or spilled
+	std::size_t compressedCount = 0;
+	std::filesystem::path spillPath;
+	std::fstream spillFile;
+	std::uint64_t spillFileSize = 0;
+	std::size_t spilledBytes = 0;
+	std::size_t spilledCount = 0;
+
+	void compressOldSteps() noexcept;
+	bool loadDelta(ScriptState& state) noexcept;
+	void closeSpillFile() noexcept;
+
 	void Snapshot(int32_t type, bool clearRedo = true) noexcept;
 	bool Undo() noexcept;
 	bool Redo() noexcept;
+	// Restores the state from before the edit of the top undo step.
+	// The step stays on the stack so the next edit replaces its result.
+	bool Amend() noexcept;
 	void ClearRedo() noexcept;
+	// Writes the oldest compressed steps to a spill file in spillDir.
+	// Returns the number of bytes freed.
+	std::size_t SpillOldest(std::size_t bytes, const std::filesystem::path& spillDir) noexcept;
 public:
 	FunscriptUndoSystem(Funscript* script) : script(script) {
 		FUN_ASSERT(script != nullptr, "no script");
 		UndoStack.reserve(1000);
 		RedoStack.reserve(100);
 	}
+	~FunscriptUndoSystem() noexcept { closeSpillFile(); }
 
 	inline bool MatchUndoTop(int32_t type) const noexcept { return !UndoEmpty() && UndoStack.back().type == type; }
 	inline bool UndoEmpty() const noexcept { return UndoStack.empty(); }
 	inline bool RedoEmpty() const noexcept { return RedoStack.empty(); }
+
+	UndoMemoryUsage MemoryUsage() const noexcept;
 };
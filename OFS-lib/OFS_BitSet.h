@@ -0,0 +1,284 @@
+#pragma once
+#include <bit>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// A dynamically sized bitset with word parallel range operations.
+// Bits past size() are always kept zero so whole words can be combined directly.
+class bit_set
+{
+public:
+    using word_type = std::uint64_t;
+    static constexpr std::size_t WordBits = 64;
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    bit_set() noexcept = default;
+    explicit bit_set(std::size_t count, bool value = false) noexcept { assign(count, value); }
+
+    inline std::size_t size() const noexcept { return bitCount; }
+    inline bool empty() const noexcept { return bitCount == 0; }
+    inline const std::vector<word_type>& words() const noexcept { return bits; }
+    inline std::size_t memoryUsage() const noexcept { return bits.capacity() * sizeof(word_type); }
+
+    inline void reserve(std::size_t count) noexcept { bits.reserve(wordCount(count)); }
+
+    inline void clear() noexcept
+    {
+        bits.clear();
+        bitCount = 0;
+    }
+
+    inline void assign(std::size_t count, bool value) noexcept
+    {
+        bitCount = count;
+        bits.assign(wordCount(count), value ? ~word_type(0) : word_type(0));
+        clearTail();
+    }
+
+    inline void resize(std::size_t count, bool value = false) noexcept
+    {
+        auto oldCount = bitCount;
+        bitCount = count;
+        bits.resize(wordCount(count), value ? ~word_type(0) : word_type(0));
+        if (value && count > oldCount && (oldCount % WordBits) != 0) {
+            bits[oldCount / WordBits] |= ~lowMask(oldCount % WordBits);
+        }
+        clearTail();
+    }
+
+    inline bool test(std::size_t idx) const noexcept
+    {
+        return (bits[idx / WordBits] >> (idx % WordBits)) & 1;
+    }
+
+    inline bool operator[](std::size_t idx) const noexcept { return test(idx); }
+
+    inline void set(std::size_t idx, bool value = true) noexcept
+    {
+        auto mask = word_type(1) << (idx % WordBits);
+        auto& word = bits[idx / WordBits];
+        word = value ? (word | mask) : (word & ~mask);
+    }
+
+    inline void reset(std::size_t idx) noexcept { set(idx, false); }
+    inline void flip(std::size_t idx) noexcept { bits[idx / WordBits] ^= word_type(1) << (idx % WordBits); }
+
+    inline void push_back(bool value) noexcept
+    {
+        if (bitCount % WordBits == 0) bits.emplace_back(0);
+        set(bitCount++, value);
+    }
+
+    // range operations on [first, last)
+    inline void set(std::size_t first, std::size_t last, bool value) noexcept
+    {
+        forRange(first, last, [value](word_type& word, word_type mask) noexcept {
+            word = value ? (word | mask) : (word & ~mask);
+        });
+    }
+
+    inline void flip(std::size_t first, std::size_t last) noexcept
+    {
+        forRange(first, last, [](word_type& word, word_type mask) noexcept { word ^= mask; });
+    }
+
+    inline void setAll() noexcept
+    {
+        std::fill(bits.begin(), bits.end(), ~word_type(0));
+        clearTail();
+    }
+
+    inline void resetAll() noexcept { std::fill(bits.begin(), bits.end(), word_type(0)); }
+
+    inline void flipAll() noexcept
+    {
+        for (auto& word : bits) word = ~word;
+        clearTail();
+    }
+
+    inline std::size_t count() const noexcept
+    {
+        std::size_t result = 0;
+        for (auto word : bits) result += std::popcount(word);
+        return result;
+    }
+
+    // number of set bits in [0, idx)
+    inline std::size_t rank(std::size_t idx) const noexcept
+    {
+        std::size_t result = 0;
+        std::size_t wordIdx = idx / WordBits;
+        for (std::size_t i = 0; i < wordIdx; ++i) result += std::popcount(bits[i]);
+        if (idx % WordBits) result += std::popcount(bits[wordIdx] & lowMask(idx % WordBits));
+        return result;
+    }
+
+    inline bool any() const noexcept
+    {
+        return std::any_of(bits.begin(), bits.end(), [](word_type word) { return word != 0; });
+    }
+
+    inline bool none() const noexcept { return !any(); }
+    inline bool all() const noexcept { return count() == bitCount; }
+
+    // returns the index of the first set bit >= idx or npos
+    inline std::size_t findNext(std::size_t idx) const noexcept
+    {
+        if (idx >= bitCount) return npos;
+        std::size_t wordIdx = idx / WordBits;
+        word_type word = bits[wordIdx] & ~lowMask(idx % WordBits);
+        while (word == 0) {
+            if (++wordIdx >= bits.size()) return npos;
+            word = bits[wordIdx];
+        }
+        return wordIdx * WordBits + std::countr_zero(word);
+    }
+
+    // returns the index of the last set bit <= idx or npos
+    inline std::size_t findPrev(std::size_t idx) const noexcept
+    {
+        if (bitCount == 0) return npos;
+        idx = std::min(idx, bitCount - 1);
+        std::size_t wordIdx = idx / WordBits;
+        std::size_t bit = idx % WordBits;
+        word_type word = bits[wordIdx] & (bit == WordBits - 1 ? ~word_type(0) : lowMask(bit + 1));
+        while (word == 0) {
+            if (wordIdx-- == 0) return npos;
+            word = bits[wordIdx];
+        }
+        return wordIdx * WordBits + (WordBits - 1 - std::countl_zero(word));
+    }
+
+    inline std::size_t findFirst() const noexcept { return findNext(0); }
+    inline std::size_t findLast() const noexcept { return bitCount == 0 ? npos : findPrev(bitCount - 1); }
+
+    // calls fn(idx) for every set bit in [first, last)
+    template<typename Fn>
+    inline void forEachSet(std::size_t first, std::size_t last, Fn&& fn) const noexcept
+    {
+        last = std::min(last, bitCount);
+        for (auto idx = findNext(first); idx < last; idx = findNext(idx + 1)) {
+            fn(idx);
+        }
+    }
+
+    template<typename Fn>
+    inline void forEachSet(Fn&& fn) const noexcept { forEachSet(0, bitCount, std::forward<Fn>(fn)); }
+
+    // inserts a bit at idx shifting all following bits up by one
+    inline void insert(std::size_t idx, bool value) noexcept
+    {
+        resize(bitCount + 1);
+        std::size_t wordIdx = idx / WordBits;
+        for (std::size_t i = bits.size() - 1; i > wordIdx; --i) {
+            bits[i] = (bits[i] << 1) | (bits[i - 1] >> (WordBits - 1));
+        }
+        auto low = lowMask(idx % WordBits);
+        auto word = bits[wordIdx];
+        bits[wordIdx] = (word & low) | ((word & ~low) << 1);
+        set(idx, value);
+        clearTail();
+    }
+
+    // removes the bits in [first, last) shifting all following bits down
+    inline void erase(std::size_t first, std::size_t last) noexcept
+    {
+        if (first >= last) return;
+        std::size_t removed = last - first;
+        std::size_t newCount = bitCount - removed;
+        std::size_t dst = first;
+        std::size_t src = last;
+        while (dst < newCount && (dst % WordBits) != 0) {
+            set(dst++, test(src++));
+        }
+        while (dst + WordBits <= newCount) {
+            bits[dst / WordBits] = extract(src);
+            dst += WordBits;
+            src += WordBits;
+        }
+        while (dst < newCount) {
+            set(dst++, test(src++));
+        }
+        resize(newCount);
+    }
+
+    inline void erase(std::size_t idx) noexcept { erase(idx, idx + 1); }
+
+    inline bit_set& operator&=(const bit_set& other) noexcept
+    {
+        for (std::size_t i = 0; i < bits.size(); ++i) bits[i] &= i < other.bits.size() ? other.bits[i] : 0;
+        return *this;
+    }
+
+    inline bit_set& operator|=(const bit_set& other) noexcept
+    {
+        for (std::size_t i = 0, size = std::min(bits.size(), other.bits.size()); i < size; ++i) bits[i] |= other.bits[i];
+        clearTail();
+        return *this;
+    }
+
+    inline bit_set& operator^=(const bit_set& other) noexcept
+    {
+        for (std::size_t i = 0, size = std::min(bits.size(), other.bits.size()); i < size; ++i) bits[i] ^= other.bits[i];
+        clearTail();
+        return *this;
+    }
+
+    // this &= ~other
+    inline bit_set& subtract(const bit_set& other) noexcept
+    {
+        for (std::size_t i = 0, size = std::min(bits.size(), other.bits.size()); i < size; ++i) bits[i] &= ~other.bits[i];
+        return *this;
+    }
+
+    inline bool operator==(const bit_set& other) const noexcept
+    {
+        return bitCount == other.bitCount && bits == other.bits;
+    }
+
+    // serialized by OFS_Binary, a loaded set has to be checked with IsConsistent
+    constexpr static auto serialize(auto& archive, auto& self) noexcept
+    {
+        return archive(self.bitCount, self.bits);
+    }
+    inline bool IsConsistent() const noexcept { return bits.size() == wordCount(bitCount); }
+
+private:
+    std::vector<word_type> bits;
+    std::size_t bitCount = 0;
+
+    static constexpr std::size_t wordCount(std::size_t count) noexcept { return (count + WordBits - 1) / WordBits; }
+    static constexpr word_type lowMask(std::size_t bit) noexcept { return bit == 0 ? 0 : (~word_type(0) >> (WordBits - bit)); }
+
+    inline void clearTail() noexcept
+    {
+        if (bitCount % WordBits) bits.back() &= lowMask(bitCount % WordBits);
+    }
+
+    // reads 64 bits starting at an unaligned bit position
+    inline word_type extract(std::size_t pos) const noexcept
+    {
+        std::size_t wordIdx = pos / WordBits;
+        std::size_t bit = pos % WordBits;
+        word_type result = wordIdx < bits.size() ? bits[wordIdx] >> bit : 0;
+        if (bit != 0 && wordIdx + 1 < bits.size()) result |= bits[wordIdx + 1] << (WordBits - bit);
+        return result;
+    }
+
+    template<typename Fn>
+    inline void forRange(std::size_t first, std::size_t last, Fn&& fn) noexcept
+    {
+        last = std::min(last, bitCount);
+        if (first >= last) return;
+        std::size_t firstWord = first / WordBits;
+        std::size_t lastWord = (last - 1) / WordBits;
+        for (std::size_t i = firstWord; i <= lastWord; ++i) {
+            word_type mask = ~word_type(0);
+            if (i == firstWord) mask &= ~lowMask(first % WordBits);
+            if (i == lastWord && (last % WordBits) != 0) mask &= lowMask(last % WordBits);
+            fn(bits[i], mask);
+        }
+    }
+};
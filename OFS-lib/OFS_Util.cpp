@@ -2,6 +2,7 @@
 #include "OFS_Profiling.h"
 
 #include <scn/scan.h>
+#include <stb_image.h>
 #include <stb_image_write.h>
 #include <xoshiro/xoshiro256plus.h>
 
@@ -13,16 +14,26 @@
 #include <shellapi.h>
 #undef  WIN32_LEAN_AND_MEAN
 #undef  NOMINMAX
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 #include <bit>
+#include <algorithm>
 #include <span>
 #include <cmath>
 #include <chrono>
 #include <string>
 #include <format>
 #include <locale>
+#include <limits>
 #include <random>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
 #include <codecvt>
 #include <filesystem>
 #include <system_error>
@@ -104,6 +115,159 @@ std::size_t OFS::util::writeFile(std::filesystem::path const& path, std::span<ch
     return 0;
 }
 
+bool OFS::util::writeFileAtomic(std::filesystem::path const& path, std::span<char const> buffer) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    auto const target = sanitizePath(path);
+    auto tmpPath = target;
+    tmpPath += ".tmp";
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(tmpPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOGF_ERROR("Failed to create \"{:s}\".", tmpPath.string());
+        return false;
+    }
+    bool success = true;
+    for (std::size_t offset = 0; success && offset < buffer.size();) {
+        DWORD written = 0;
+        auto const chunk = static_cast<DWORD>(std::min<std::size_t>(buffer.size() - offset, 1u << 30));
+        success = WriteFile(file, buffer.data() + offset, chunk, &written, nullptr) && written > 0;
+        offset += written;
+    }
+    success = success && FlushFileBuffers(file);
+    CloseHandle(file);
+    success = success && MoveFileExW(tmpPath.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOGF_ERROR("Failed to create \"{:s}\".", tmpPath.string());
+        return false;
+    }
+    bool success = true;
+    for (std::size_t offset = 0; success && offset < buffer.size();) {
+        auto written = ::write(fd, buffer.data() + offset, buffer.size() - offset);
+        success = written > 0;
+        if (success) offset += static_cast<std::size_t>(written);
+    }
+    // the data has to be on disk before the rename or a power loss can leave an empty file behind the new name
+    success = success && ::fsync(fd) == 0;
+    success = ::close(fd) == 0 && success;
+    success = success && ::rename(tmpPath.c_str(), target.c_str()) == 0;
+    if (success) {
+        // makes the rename itself durable
+        int dirFd = ::open(target.has_parent_path() ? target.parent_path().c_str() : ".", O_RDONLY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+    }
+#endif
+
+    if (!success) {
+        LOGF_ERROR("Failed to write \"{:s}\".", target.string());
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+    }
+    return success;
+}
+
+OFS::util::MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+OFS::util::MappedFile& OFS::util::MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        mappedData = std::exchange(other.mappedData, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+        opened = std::exchange(other.opened, false);
+#if defined(_WIN32)
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool OFS::util::MappedFile::open(std::filesystem::path const& path) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    close();
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(sanitizePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    opened = true;
+    if (fileSize.QuadPart == 0) return true;
+
+    mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle != nullptr)
+        mappedData = static_cast<char const*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (mappedData == nullptr)
+    {
+        LOGF_ERROR("Failed to map file: \"{:s}\"", path.string());
+        close();
+        return false;
+    }
+    mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(sanitizePath(path).c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    opened = true;
+    if (fileStat.st_size > 0)
+    {
+        void* ptr = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            LOGF_ERROR("Failed to map file: \"{:s}\"", path.string());
+            ::close(fd);
+            opened = false;
+            return false;
+        }
+        madvise(ptr, static_cast<std::size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+        mappedData = static_cast<char const*>(ptr);
+        mappedSize = static_cast<std::size_t>(fileStat.st_size);
+    }
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+#endif
+    return true;
+}
+
+void OFS::util::MappedFile::close(void) noexcept
+{
+#if defined(_WIN32)
+    if (mappedData) UnmapViewOfFile(mappedData);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (mappedData) munmap(const_cast<char*>(mappedData), mappedSize);
+#endif
+    mappedData = nullptr;
+    mappedSize = 0;
+    opened = false;
+}
+
 std::chrono::milliseconds OFS::util::parseTime(std::string_view timeStr, bool* const success)
 {
     OFS_PROFILE(__FUNCTION__);
@@ -208,13 +372,52 @@ std::wstring OFS::util::utf8ToUtf16(std::u8string_view str) noexcept
 
 bool OFS::util::savePNG(std::string const& path, void const* buffer, std::int32_t width, std::int32_t height, std::int32_t channels, bool flipVertical) noexcept
 {
-    stbi_flip_vertically_on_write(flipVertical);
+    // stbi_flip_vertically_on_write sets a process wide flag, pngs are saved from worker threads
+    // so the rows are flipped here and the flag is never touched
+    std::size_t const rowSize = static_cast<std::size_t>(width) * channels;
+    std::vector<std::uint8_t> flipped;
+    if (flipVertical) {
+        auto const* rows = static_cast<std::uint8_t const*>(buffer);
+        flipped.resize(rowSize * height);
+        for (std::int32_t y = 0; y < height; ++y) {
+            std::memcpy(flipped.data() + rowSize * y, rows + rowSize * (height - 1 - y), rowSize);
+        }
+        buffer = flipped.data();
+    }
     bool success = stbi_write_png(path.c_str(),
         width, height,
-        channels, buffer, 0);
+        channels, buffer, static_cast<int>(rowSize));
     return success;
 }
 
+// defined in the stb_image_write implementation but not declared in its header
+STBIWDEF unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+bool OFS::util::compressBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t>& output, std::int32_t quality) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (input.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) return false;
+
+    int compressedSize = 0;
+    auto compressed = stbi_zlib_compress(const_cast<unsigned char*>(input.data()), static_cast<int>(input.size()), &compressedSize, quality);
+    if (!compressed) return false;
+    output.assign(compressed, compressed + compressedSize);
+    std::free(compressed);
+    return true;
+}
+
+bool OFS::util::decompressBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t>& output, std::size_t decompressedSize) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (input.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())
+        || decompressedSize > static_cast<std::size_t>(std::numeric_limits<int>::max())) return false;
+
+    output.resize(decompressedSize);
+    auto size = stbi_zlib_decode_buffer(reinterpret_cast<char*>(output.data()), static_cast<int>(output.size()),
+        reinterpret_cast<char const*>(input.data()), static_cast<int>(input.size()));
+    return size == static_cast<int>(decompressedSize);
+}
+
 int OFS::util::openUrl(const std::string& url)
 {
 #if defined(WIN32)
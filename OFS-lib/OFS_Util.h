@@ -97,10 +97,42 @@ namespace OFS::util
     std::string readFileString(std::filesystem::path const& path);
     std::size_t writeFile(std::filesystem::path const& path, std::span<std::byte const> buffer);
     std::size_t writeFile(std::filesystem::path const& path, std::span<char const> buffer);
+    // Writes and syncs path.tmp, then renames it over path. A crash or failed write leaves the old file untouched.
+    bool writeFileAtomic(std::filesystem::path const& path, std::span<char const> buffer) noexcept;
 
     std::string filename(std::string_view path) noexcept;
     std::string filename(std::filesystem::path const& path) noexcept;
 
+    // Read only memory mapping of a whole file.
+    // The view stays valid until the file is closed or destroyed.
+    class MappedFile
+    {
+    public:
+        MappedFile(void) noexcept = default;
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile(void) noexcept { close(); }
+
+        bool open(std::filesystem::path const& path) noexcept;
+        void close(void) noexcept;
+
+        inline bool isOpen(void) const noexcept { return opened; }
+        inline char const* data(void) const noexcept { return mappedData; }
+        inline std::size_t size(void) const noexcept { return mappedSize; }
+        inline std::string_view view(void) const noexcept { return { mappedData, mappedSize }; }
+
+    private:
+        char const* mappedData = nullptr;
+        std::size_t mappedSize = 0;
+        bool opened = false;
+#if defined(_WIN32)
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+
 
     // ====================================================================================
     //  Formatting functions
@@ -129,6 +161,16 @@ namespace OFS::util
     bool savePNG(std::string const& path, void const* buffer, std::int32_t width, std::int32_t height, std::int32_t channels = 3, bool flipVertical = true) noexcept;
 
 
+    // ====================================================================================
+    //  Compression functions
+    // ====================================================================================
+
+    // zlib streams through the deflate implementation shipped with stb
+    bool compressBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t>& output, std::int32_t quality = 8) noexcept;
+    // decompressedSize has to be the exact size of the original data
+    bool decompressBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t>& output, std::size_t decompressedSize) noexcept;
+
+
     // ====================================================================================
     //  OS
     // ====================================================================================
@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
+#include <cstddef>
 #include <algorithm>
+#include <functional>
 
 template <typename T, typename Comparison = std::less<T>, typename Allocator = std::allocator<T>>
 class vector_set : public std::vector<T, Allocator>
@@ -16,15 +18,34 @@ public:
     {
         T obj(std::forward<Args>(args)...);
 
-        if (auto it = this->lower_bound(obj); it != this->end())
+        auto it = this->lower_bound(obj);
+        if (Comparison comp{}; it != this->end() && !comp(obj, *it))
         {
-            if (Comparison comp{}; !comp(*it, obj) && !comp(obj, *it))
+            // an equivalent element already exists
+            return false;
+        }
+        this->insert(it, std::move(obj));
+        return true;
+    }
+
+    // Calls fn(index) for every element which is also contained in [first, last).
+    // [first, last) has to be sorted by Comparison, both ranges are walked once in a linear merge pass.
+    template<typename InputIt, typename Fn>
+    inline void for_each_match(InputIt first, InputIt last, Fn&& fn) const
+    {
+        Comparison comp{};
+        for (std::size_t idx = 0, size = this->size(); idx < size && first != last;)
+        {
+            const auto& element = (*this)[idx];
+            if (comp(element, *first)) { ++idx; }
+            else if (comp(*first, element)) { ++first; }
+            else 
             {
-                this->insert(it, std::move(obj));
-                return true;
+                if (element == *first) fn(idx);
+                ++idx;
+                ++first;
             }
         }
-        return false;
     }
 
     inline void emplace_back_unsorted(const T& a)
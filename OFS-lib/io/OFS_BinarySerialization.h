@@ -2,11 +2,16 @@
 #include "OFS_Profiling.h"
 #include "OFS_VectorSet.h"
 
+#include <zpp_bits.h>
+
 #include <span>
 #include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string_view>
+#include <type_traits>
 
 namespace OFS::util
 {
@@ -15,55 +20,60 @@ namespace OFS::util
 }
 
 
-// QQQ
-
 using ByteBuffer = std::vector<std::uint8_t>;
-//using OutputAdapter = bitsery::OutputBufferAdapter<ByteBuffer>;
-//using InputAdapter = bitsery::InputBufferAdapter<ByteBuffer>;
-//
-//using TContext = std::tuple<bitsery::ext::PointerLinkingContext>;
-//
-//using ContextSerializer = bitsery::Serializer<OutputAdapter, TContext>;
-//using ContextDeserializer = bitsery::Deserializer<InputAdapter, TContext>;
 
 struct OFS_Binary
 {
+    static constexpr std::uint32_t Magic = 0x4253464f; // "OFSB"
+    // bumped whenever a serialized layout changes, older payloads are rejected
+    static constexpr std::uint32_t Version = 1;
 
     template<typename T>
     static size_t Serialize(ByteBuffer& buffer, T& obj) noexcept
     {
         OFS_PROFILE(__FUNCTION__);
-        return 0;
-        //zpp::bits::out out{ buffer };
-        //out(obj);
-        //return out.position();
-
-        //TContext ctx{};
-        //
-        //ContextSerializer ser{ ctx, buffer };
-        //ser.object(obj);
-        //ser.adapter().flush();
-        //auto writtenSize = ser.adapter().writtenBytesCount();
-        //
-        //return writtenSize;
+        zpp::bits::out out{ buffer };
+        if (zpp::bits::failure(out(Magic, Version, obj))) {
+            return 0;
+        }
+        return out.position();
     }
 
     template<typename T>
-    static auto Deserialize(ByteBuffer& buffer, T& obj) noexcept
+    static bool Deserialize(ByteBuffer& buffer, T& obj) noexcept
     {
         OFS_PROFILE(__FUNCTION__);
-        //zpp::bits::in in{ buffer };
-        //return in(obj);
-        return false;
-        //TContext ctx{};
-        //ContextDeserializer des{ ctx, buffer.begin(), buffer.size() };
-        //des.object(obj);
-        //
-        //auto error = des.adapter().error();
-        //auto valid = std::get<0>(ctx).isValid();
-        //std::get<0>(ctx).clearSharedState();
-        //
-        //return error;
+        zpp::bits::in in{ buffer };
+        std::uint32_t magic = 0;
+        std::uint32_t version = 0;
+        if (zpp::bits::failure(in(magic, version)) || magic != Magic || version != Version) {
+            return false;
+        }
+        return !zpp::bits::failure(in(obj));
+    }
+
+    // Trivially copyable arrays are stored as a single block of raw bytes.
+    // Loading them is one memcpy instead of a read per element.
+    template<typename Archive, typename Container>
+    static constexpr auto Block(Archive& archive, Container& items) noexcept
+    {
+        using Item = typename std::remove_cvref_t<Container>::value_type;
+        static_assert(std::is_trivially_copyable_v<Item>);
+
+        std::vector<std::byte> bytes;
+        if constexpr (std::remove_cvref_t<Archive>::kind() == zpp::bits::kind::out) {
+            bytes.resize(items.size() * sizeof(Item));
+            if (!bytes.empty()) std::memcpy(bytes.data(), items.data(), bytes.size());
+            return archive(bytes);
+        }
+        else {
+            auto result = archive(bytes);
+            if (zpp::bits::failure(result)) return result;
+            if (bytes.size() % sizeof(Item) != 0) return zpp::bits::errc{ std::errc::message_size };
+            items.resize(bytes.size() / sizeof(Item));
+            if (!bytes.empty()) std::memcpy(items.data(), bytes.data(), bytes.size());
+            return result;
+        }
     }
 };
 //
@@ -1,14 +1,61 @@
 #include "OFS_StateManager.h"
 #include "io/OFS_FileLogging.h"
+#include "OFS_Profiling.h"
 
 #include <glaze/glaze.hpp>
 
 #include <map>
+#include <memory>
+#include <span>
 #include <string>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include <utility>
 #include <string_view>
 
+namespace
+{
+    // "OFSS" followed by the version, then per state the size prefixed name, the format and the size prefixed data.
+    // Version 1 had no format, every state was BEVE.
+    constexpr char BinaryMagic[4] = { 'O', 'F', 'S', 'S' };
+    constexpr std::uint32_t BinaryVersion = 2;
+
+    // unknown states from json projects are kept as json until something registers them
+    enum class BinaryStateFormat : std::uint8_t
+    {
+        Beve = 0,
+        Json = 1,
+    };
+
+    void appendSized(std::vector<char>& bin, const char* data, std::size_t size) noexcept
+    {
+        auto size32 = static_cast<std::uint32_t>(size);
+        auto offset = bin.size();
+        bin.resize(offset + sizeof(size32) + size);
+        std::memcpy(bin.data() + offset, &size32, sizeof(size32));
+        if (size > 0) std::memcpy(bin.data() + offset + sizeof(size32), data, size);
+    }
+
+    void appendState(std::vector<char>& bin, std::string_view name, BinaryStateFormat format, const char* data, std::size_t size) noexcept
+    {
+        appendSized(bin, name.data(), name.size());
+        bin.push_back(static_cast<char>(format));
+        appendSized(bin, data, size);
+    }
+
+    bool readSized(std::span<const char> bin, std::size_t& offset, std::span<const char>& out) noexcept
+    {
+        std::uint32_t size32;
+        if (bin.size() - offset < sizeof(size32)) return false;
+        std::memcpy(&size32, bin.data() + offset, sizeof(size32));
+        offset += sizeof(size32);
+        if (bin.size() - offset < size32) return false;
+        out = bin.subspan(offset, size32);
+        offset += size32;
+        return true;
+    }
+}
 
 OFS::StateManager* OFS::StateManager::get(void) noexcept
 {
@@ -23,46 +70,196 @@ void OFS::StateManager::clearStateGroup(std::size_t group) noexcept
     std::string json = "{}";
     for (auto& state : stateGroups[group].registeredStates)
     {
+        state.raw.reset();
         state.deserializeJson(state.value, json);
     }
+    stateGroups[group].unknownStates.clear();
+}
+
+void OFS::StateManager::decodeState(StateMeta& state) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    auto raw = std::move(state.raw);
+    auto deserialize = raw->binary ? state.deserializeBinary : state.deserializeJson;
+    if (nullptr == deserialize) 
+    {
+        state.raw = std::move(raw);
+        return;
+    }
+
+    std::string data = raw->data;
+    deserialize(state.value, data);
+}
+
+void OFS::StateManager::addRawState(StateGroup& group, std::shared_ptr<const RawState> raw) noexcept
+{
+    if (auto const it = group.handleMap.find(std::string_view{ raw->name }); group.handleMap.end() != it)
+    {
+        group.registeredStates[it->second.value].raw = std::move(raw);
+    }
+    else
+    {
+        auto& state = group.unknownStates.emplace_back();
+        state.name = raw->name;
+        state.raw = std::move(raw);
+    }
+}
+
+namespace
+{
+    void writeStatesJson(std::span<OFS::StateMeta> states, std::span<OFS::StateMeta> unknownStates, std::string& json)
+    {
+        std::vector<std::pair<std::string_view, glz::raw_json>> partial{};
+        partial.reserve(states.size() + unknownStates.size());
+
+        for (auto* group : { &states, &unknownStates })
+        {
+            for (auto& state : *group)
+            {
+                if (state.raw && !state.raw->binary)
+                {
+                    // never decoded, the data is still what was read
+                    partial.emplace_back(state.name, glz::raw_json{ state.raw->data });
+                    continue;
+                }
+                if (nullptr == state.serializeJson)
+                {
+                    LOGF_DEBUG("Dropping state {:s} which can't be converted to JSON without being registered.", state.name);
+                    continue;
+                }
+                if (state.raw) 
+                    OFS::StateManager::decodeState(state);
+                auto& [_, partialJson] = partial.emplace_back(state.name, glz::raw_json{});
+                state.serializeJson(state.value, partialJson.str);
+            }
+        }
+
+        if (auto const err = glz::write_json(partial, json); err)
+        {
+            FUN_ASSERT(false, err.custom_error_message);
+            json = "{}";
+        }
+    }
+
+    void writeStatesBinary(std::span<OFS::StateMeta> states, std::span<OFS::StateMeta> unknownStates, std::vector<char>& bin)
+    {
+        bin.clear();
+        bin.insert(bin.end(), std::begin(BinaryMagic), std::end(BinaryMagic));
+        bin.resize(bin.size() + sizeof(BinaryVersion));
+        std::memcpy(bin.data() + sizeof(BinaryMagic), &BinaryVersion, sizeof(BinaryVersion));
+
+        std::string partialBin{};
+        for (auto* group : { &states, &unknownStates })
+        {
+            for (auto& state : *group)
+            {
+                if (state.raw && (state.raw->binary || nullptr == state.serializeBinary))
+                {
+                    // never decoded, the data is still what was read
+                    auto format = state.raw->binary ? BinaryStateFormat::Beve : BinaryStateFormat::Json;
+                    appendState(bin, state.name, format, state.raw->data.data(), state.raw->data.size());
+                    continue;
+                }
+                if (nullptr == state.serializeBinary)
+                {
+                    LOGF_DEBUG("Dropping state {:s} which has no binary serialization.", state.name);
+                    continue;
+                }
+                if (state.raw)
+                    OFS::StateManager::decodeState(state);
+                partialBin.clear();
+                state.serializeBinary(state.value, partialBin);
+                appendState(bin, state.name, BinaryStateFormat::Beve, partialBin.data(), partialBin.size());
+            }
+        }
+    }
 }
 
 void OFS::StateManager::serializeStateGroup(StateGroup& group, std::string& json)
 {
-    std::vector<std::pair<std::string_view, glz::raw_json>> partial{};
-    partial.reserve(group.registeredStates.size());
+    writeStatesJson(group.registeredStates, group.unknownStates, json);
+}
+
+void OFS::StateManager::serializeStateGroupBinary(StateGroup& group, std::vector<char>& bin)
+{
+    writeStatesBinary(group.registeredStates, group.unknownStates, bin);
+}
+
+void OFS::StateManager::serializeStates(std::vector<StateMeta>& states, std::string& json)
+{
+    writeStatesJson(states, {}, json);
+}
+
+void OFS::StateManager::serializeStatesBinary(std::vector<StateMeta>& states, std::vector<char>& bin)
+{
+    writeStatesBinary(states, {}, bin);
+}
+
+bool OFS::StateManager::isBinaryStateGroup(std::span<const char> bin) noexcept
+{
+    return bin.size() >= sizeof(BinaryMagic) + sizeof(BinaryVersion)
+        && std::memcmp(bin.data(), BinaryMagic, sizeof(BinaryMagic)) == 0;
+}
 
-    for (auto& state : group.registeredStates)
+// States only get decoded on first use, until then they are kept as they were read.
+bool OFS::StateManager::deserializeStateGroupBinary(StateGroup& group, std::span<const char> bin)
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (!isBinaryStateGroup(bin))
+        return false;
+
+    std::uint32_t version;
+    std::memcpy(&version, bin.data() + sizeof(BinaryMagic), sizeof(version));
+    if (version > BinaryVersion)
     {
-        auto& [_, partialJson] = partial.emplace_back(state.name, glz::raw_json{});
-        state.serializeJson(state.value, partialJson.str);
+        LOGF_ERROR("State file version {:d} is newer than the supported version {:d}.", version, BinaryVersion);
+        return false;
     }
 
-    if (auto const err = glz::write_json(partial, json); err)
+    std::vector<std::shared_ptr<const RawState>> rawStates{};
+    std::size_t offset = sizeof(BinaryMagic) + sizeof(BinaryVersion);
+    while (offset < bin.size())
     {
-        FUN_ASSERT(false, err.custom_error_message);
-        json = "{}";
+        std::span<const char> name, data;
+        auto format = BinaryStateFormat::Beve;
+        if (!readSized(bin, offset, name))
+            return false;
+        if (version >= 2)
+        {
+            if (offset >= bin.size())
+                return false;
+            format = static_cast<BinaryStateFormat>(bin[offset++]);
+            if (format != BinaryStateFormat::Beve && format != BinaryStateFormat::Json)
+            {
+                LOGF_ERROR("State {:s} has an unknown format.", std::string_view{ name.data(), name.size() });
+                return false;
+            }
+        }
+        if (!readSized(bin, offset, data))
+            return false;
+        rawStates.emplace_back(std::make_shared<const RawState>(
+            std::string{ name.begin(), name.end() }, std::string{ data.begin(), data.end() }, format == BinaryStateFormat::Beve));
     }
+
+    group.unknownStates.clear();
+    for (auto& raw : rawStates)
+        addRawState(group, std::move(raw));
+    return true;
 }
 
 bool OFS::StateManager::deserializeStateGroup(StateGroup& group, std::string& json)
 {
+    OFS_PROFILE(__FUNCTION__);
     std::map<std::string_view, glz::raw_json_view> partial{};
 
     if (auto const err = glz::read_json(partial, json); err)
         return false;
 
-    for (auto& state : group.registeredStates)
+    group.unknownStates.clear();
+    for (auto& [name, partialJson] : partial)
     {
-        if (auto const it = partial.find(state.name); partial.end() != it)
-        {
-            std::string partialJson{ it->second.str.begin(), it->second.str.end() };
-            state.deserializeJson(state.value, partialJson);
-        }
-        else [[unlikely]]
-        {
-            LOGF_DEBUG("Attempted to load state {:s} but it hasn't been registered yet.", state.name);
-        }
+        addRawState(group, std::make_shared<const RawState>(
+            std::string{ name }, std::string{ partialJson.str.begin(), partialJson.str.end() }, false));
     }
     return true;
 }
@@ -6,7 +6,10 @@
 #include <glaze/glaze.hpp>
 
 #include <any>
+#include <algorithm>
 #include <map>
+#include <span>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -54,6 +57,45 @@ namespace OFS
         }
     }
 
+    // BEVE is glaze's binary format, objects keep their keys so states can still gain and lose fields.
+    template <typename T>
+    void serializeStateBinary(std::any& state, std::string& bin)
+    {
+        auto *value = std::any_cast<T>(std::addressof(state));
+        if (nullptr == value) [[unlikely]]
+        {
+            FUN_ASSERT(false, "State serialization failed. Type mismatch.");
+            return;
+        }
+
+        if (auto const err = glz::write_beve(*value, bin); err)
+            [[unlikely]]
+            FUN_ASSERT(false, err.custom_error_message);
+    }
+
+    template <typename T>
+    void deserializeStateBinary(std::any& state, std::string& bin)
+    {
+        if (nullptr == std::any_cast<T>(std::addressof(state))) [[unlikely]]
+        {
+            FUN_ASSERT(false, "State deserialization failed. Type mismatch.");
+            state.emplace<T>();
+            return;
+        }
+
+        auto& value = state.emplace<T>();
+        if (auto const err = glz::read<glz::opts{ .format = glz::BEVE, .error_on_unknown_keys = false }>(value, bin); err)
+            [[unlikely]] FUN_ASSERT(false, "State deserialization failed.");
+    }
+
+    // A state as it was read from a file.
+    struct RawState
+    {
+        std::string name;
+        std::string data;
+        bool binary;
+    };
+
     struct StateMeta
     {
         std::any value;
@@ -62,6 +104,12 @@ namespace OFS
         using SerializationFn = void(*)(std::any&, std::string& json);
         SerializationFn serializeJson;
         SerializationFn deserializeJson;
+        SerializationFn serializeBinary;
+        SerializationFn deserializeBinary;
+
+        // Set while the state hasn't been decoded yet. States nobody registered only consist of
+        // their raw data and no serialization functions, they get written back unchanged.
+        std::shared_ptr<const RawState> raw;
     };
 
     class StateManager
@@ -82,6 +130,23 @@ namespace OFS
         template <std::size_t STATE_GROUP>
         bool deserializeStateGroup(std::string json);
 
+        // Binary state files skip the JSON <> CBOR conversion.
+        // Files written by older versions are CBOR and have to go through deserializeStateGroup.
+        template <std::size_t STATE_GROUP>
+        std::vector<char> serializeStateGroupBinary(void);
+        template <std::size_t STATE_GROUP>
+        bool deserializeStateGroupBinary(std::span<const char> bin);
+        static bool isBinaryStateGroup(std::span<const char> bin) noexcept;
+
+        // Copies of the states in a group which can be serialized on any thread.
+        template <std::size_t STATE_GROUP>
+        std::vector<StateMeta> copyStateGroup(void);
+        static void serializeStates(std::vector<StateMeta>& states, std::string& json);
+        static void serializeStatesBinary(std::vector<StateMeta>& states, std::vector<char>& bin);
+
+        // Replaces the value of a state with its raw data.
+        static void decodeState(StateMeta& state) noexcept;
+
         //void serialize(void);  // TODO: we dont have to support this yet 
         //void deserialize(void);  // TODO: we dont have to support this yet 
 
@@ -94,10 +159,16 @@ namespace OFS
         {
             StateHandleMap handleMap;
             std::vector<StateMeta> registeredStates;
+            // read from a file but not registered (yet)
+            std::vector<StateMeta> unknownStates;
         };
 
+        static void addRawState(StateGroup&, std::shared_ptr<const RawState> raw) noexcept;
+
         void serializeStateGroup  (StateGroup&, std::string& json);
+        void serializeStateGroupBinary(StateGroup&, std::vector<char>& bin);
         bool deserializeStateGroup(StateGroup&, std::string& json);
+        bool deserializeStateGroupBinary(StateGroup&, std::span<const char> bin);
 
         StateManager(void) = default;
 
@@ -116,7 +187,17 @@ inline OFS::StateHandle OFS::StateManager::registerState(std::string_view stateN
     if (auto const it = group.handleMap.find(stateName); group.handleMap.end() == it)
     {
         auto ret = group.handleMap.emplace_hint(it, stateName, StateHandle(group.registeredStates.size()));
-        group.registeredStates.emplace_back(T{}, stateName, serializeState<T>, deserializeState<T>);
+        auto& state = group.registeredStates.emplace_back(T{}, stateName, 
+            serializeState<T>, deserializeState<T>, serializeStateBinary<T>, deserializeStateBinary<T>);
+
+        // the file was read before this state got registered
+        auto const unknown = std::find_if(group.unknownStates.begin(), group.unknownStates.end(),
+            [stateName](auto const& unknownState) noexcept { return unknownState.name == stateName; });
+        if (group.unknownStates.end() != unknown)
+        {
+            state.raw = std::move(unknown->raw);
+            group.unknownStates.erase(unknown);
+        }
 
         return ret->second;
     }
@@ -135,7 +216,10 @@ inline T& OFS::StateManager::getState(StateHandle handle) noexcept
 {
     FUN_ASSERT(STATE_GROUP < stateGroups.size(), "Specified state group out of bounds. Please register something to this group first.");
     FUN_ASSERT(handle.value < stateGroups[STATE_GROUP].registeredStates.size(), "Invalid handle");
-    return std::any_cast<T&>(stateGroups[STATE_GROUP].registeredStates[handle.value].value);
+    auto& state = stateGroups[STATE_GROUP].registeredStates[handle.value];
+    if (state.raw) [[unlikely]]
+        decodeState(state);
+    return std::any_cast<T&>(state.value);
 }
 
 template <std::size_t STATE_GROUP>
@@ -154,6 +238,20 @@ inline std::string OFS::StateManager::serializeStateGroup(void)
     }
 }
 
+template <std::size_t STATE_GROUP>
+inline std::vector<OFS::StateMeta> OFS::StateManager::copyStateGroup(void)
+{
+    if (STATE_GROUP < stateGroups.size())
+    {
+        auto const& group = stateGroups[STATE_GROUP];
+        auto states = group.registeredStates;
+        states.insert(states.end(), group.unknownStates.begin(), group.unknownStates.end());
+        return states;
+    }
+    FUN_ASSERT(false, "Specified state group out of bounds. Please register something to this group first.");
+    return {};
+}
+
 template <std::size_t STATE_GROUP>
 inline bool OFS::StateManager::deserializeStateGroup(std::string json)
 {
@@ -168,3 +266,33 @@ inline bool OFS::StateManager::deserializeStateGroup(std::string json)
     }
     return false;
 }
+
+template <std::size_t STATE_GROUP>
+inline std::vector<char> OFS::StateManager::serializeStateGroupBinary(void)
+{
+    if (STATE_GROUP < stateGroups.size())
+    {
+        std::vector<char> outBin{};
+        serializeStateGroupBinary(stateGroups[STATE_GROUP], outBin);
+        return outBin;
+    }
+    else
+    {
+        FUN_ASSERT(false, "Specified state group out of bounds. Please register something to this group first.");
+        return {};
+    }
+}
+
+template <std::size_t STATE_GROUP>
+inline bool OFS::StateManager::deserializeStateGroupBinary(std::span<const char> bin)
+{
+    if (STATE_GROUP < stateGroups.size())
+    {
+        return deserializeStateGroupBinary(stateGroups[STATE_GROUP], bin);
+    }
+    else
+    {
+        FUN_ASSERT(false, "Specified state group out of bounds. Please register something to this group first.");
+    }
+    return false;
+}
@@ -0,0 +1,159 @@
+#include "OFS_CliCommands.h"
+#include "OFS_Util.h"
+#include "OFS_Profiling.h"
+#include "Funscript/FunscriptProcessing.h"
+#include "Funscript/FunscriptHeatmapExport.h"
+
+#include <cmath>
+#include <format>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+    OFS::cli::FileResult failure(std::filesystem::path const& input, std::string_view reason) noexcept
+    {
+        return { false, std::format("{:s}: {:s}", input.string(), reason) };
+    }
+
+    bool loadFunscript(std::filesystem::path const& input, Funscript& script, Funscript::Metadata& metadata,
+        Funscript::LoadIssues* issues, OFS::cli::FileResult& error) noexcept
+    {
+        // the mapping is only needed while parsing
+        OFS::util::MappedFile file;
+        if (!file.open(input)) {
+            error = failure(input, "can't be opened");
+            return false;
+        }
+        if (!script.Deserialize(file.view(), &metadata, false, issues)) {
+            error = failure(input, "isn't a valid funscript");
+            return false;
+        }
+        return true;
+    }
+
+    bool writeFunscript(std::filesystem::path const& path, Funscript::SaveSnapshot& snapshot, FunscriptArray const& actions, Funscript::Metadata const& metadata) noexcept
+    {
+        OFS_PROFILE(__FUNCTION__);
+        snapshot.State.Actions = {};
+        snapshot.State.Actions.Update(actions);
+        // stays allocated for the next file on this thread
+        thread_local std::string json;
+        Funscript::Serialize(json, snapshot, metadata);
+        return OFS::util::writeFile(path, json) == json.size();
+    }
+
+    std::string formatStats(std::filesystem::path const& input, FunscriptArray const& actions) noexcept
+    {
+        std::uint64_t durationMs = actions.size() > 1 ? actions.back().at - actions.front().at : 0;
+        std::uint64_t distance = 0;
+        float maxSpeed = 0.f;
+        for (std::size_t i = 1; i < actions.size(); ++i) {
+            auto travel = (std::uint32_t)std::abs((int)actions[i].pos - (int)actions[i - 1].pos);
+            distance += travel;
+            maxSpeed = std::max(maxSpeed, travel / ((actions[i].at - actions[i - 1].at) / 1000.f));
+        }
+        float averageSpeed = durationMs > 0 ? distance / (durationMs / 1000.f) : 0.f;
+        return std::format("{:s}\t{:d}\t{:.3f}\t{:.1f}\t{:.1f}",
+            input.string(), actions.size(), durationMs / 1000.0, averageSpeed, maxSpeed);
+    }
+}
+
+std::string OFS::cli::statsHeader() noexcept
+{
+    return "file\tactions\tduration_s\taverage_speed\tmax_speed";
+}
+
+OFS::cli::FileResult OFS::cli::processFile(Command const& command, std::filesystem::path const& input) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (command.type == CommandType::Heatmap) {
+        auto name = input.stem();
+        name += OFS::funscript::HeatmapExtension;
+        auto outputPath = command.output.empty() ? input.parent_path() / name : command.output / name;
+        if (!OFS::funscript::renderHeatmapFile(input, outputPath, command.width, command.height)) {
+            return failure(input, "heatmap can't be written");
+        }
+        return { true, std::format("{:s}: {:d}x{:d}", outputPath.string(), command.width, command.height) };
+    }
+
+    Funscript script;
+    Funscript::Metadata metadata;
+    Funscript::LoadIssues issues;
+    FileResult result;
+    if (!loadFunscript(input, script, metadata, &issues, result)) {
+        return result;
+    }
+
+    auto const& actions = script.Actions();
+    FunscriptArray processed;
+    switch (command.type) {
+        case CommandType::Validate:
+        {
+            if (!issues.Any()) {
+                return { true, std::format("{:s}: ok", input.string()) };
+            }
+            return failure(input, std::format("{:d} negative timestamps, {:d} positions out of range, {:d} unsorted actions, {:d} duplicate timestamps",
+                issues.NegativeTimes, issues.PositionsOutOfRange, issues.UnsortedActions, issues.DuplicateTimes));
+        }
+        case CommandType::Stats:
+            return { true, formatStats(input, actions) };
+        case CommandType::Simplify:
+            OFS::funscript::simplify(actions, command.epsilon * OFS::funscript::averageDistance(actions), processed);
+            break;
+        case CommandType::Resample:
+            OFS::funscript::resample(actions, command.intervalMs, processed);
+            break;
+        case CommandType::Clip:
+            OFS::funscript::clip(actions, command.fromMs, command.toMs, processed);
+            break;
+        case CommandType::Merge:
+            FUN_ASSERT(false, "merge needs every input at once");
+            return failure(input, "can't be merged on its own");
+        case CommandType::Heatmap:
+            FUN_ASSERT(false, "heatmaps don't need the editor script");
+            return failure(input, "heatmap can't be written");
+    }
+
+    auto outputPath = command.output / input.filename();
+    auto snapshot = script.TakeSaveSnapshot();
+    if (!writeFunscript(outputPath, snapshot, processed, metadata)) {
+        return failure(outputPath, "can't be written");
+    }
+    return { true, std::format("{:s}: {:d} -> {:d} actions", outputPath.string(), actions.size(), processed.size()) };
+}
+
+OFS::cli::FileResult OFS::cli::loadScript(std::filesystem::path const& input, LoadedScript& out) noexcept
+{
+    Funscript script;
+    FileResult result;
+    if (!loadFunscript(input, script, out.metadata, nullptr, result)) {
+        return result;
+    }
+    out.actions = script.Actions();
+    out.snapshot = script.TakeSaveSnapshot();
+    // only the actions are needed from here on
+    out.snapshot.State = {};
+    return { true, {} };
+}
+
+OFS::cli::FileResult OFS::cli::mergeScripts(Command const& command, std::vector<LoadedScript>& scripts) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (scripts.empty()) {
+        return failure(command.output, "nothing to merge");
+    }
+
+    std::vector<FunscriptArray> actions;
+    actions.reserve(scripts.size());
+    for (auto& script : scripts) actions.emplace_back(std::move(script.actions));
+
+    FunscriptArray merged;
+    OFS::funscript::merge(actions, merged);
+    // metadata and unknown fields come from the first input
+    if (!writeFunscript(command.output, scripts.front().snapshot, merged, scripts.front().metadata)) {
+        return failure(command.output, "can't be written");
+    }
+    return { true, std::format("{:s}: {:d} actions from {:d} scripts", command.output.string(), merged.size(), scripts.size()) };
+}
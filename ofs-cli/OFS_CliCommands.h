@@ -0,0 +1,60 @@
+#pragma once
+#include "Funscript/Funscript.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+namespace OFS::cli
+{
+    enum class CommandType : std::uint8_t
+    {
+        Validate,
+        Stats,
+        Simplify,
+        Resample,
+        Clip,
+        Merge,
+        Heatmap,
+    };
+
+    struct Command
+    {
+        CommandType type = CommandType::Validate;
+        // output directory, for merge the output file, heatmaps are written next to the inputs when empty
+        std::filesystem::path output;
+        std::vector<std::filesystem::path> inputs;
+        unsigned jobs = 0;
+
+        // relative to the average distance between actions like the simplify function in the editor
+        float epsilon = 0.f;
+        std::uint32_t intervalMs = 0;
+        std::uint32_t fromMs = 0;
+        std::uint32_t toMs = FunscriptAction::MaxTimeMs;
+        std::uint32_t width = 2000;
+        std::uint32_t height = 50;
+    };
+
+    struct FileResult
+    {
+        bool success = false;
+        // printed on stdout for successes and on stderr for failures
+        std::string message;
+    };
+
+    // A loaded script, only used by merge which needs every input at once.
+    struct LoadedScript
+    {
+        FunscriptArray actions;
+        Funscript::Metadata metadata;
+        Funscript::SaveSnapshot snapshot;
+    };
+
+    // Runs the command on a single input. Safe to call on any thread.
+    FileResult processFile(Command const& command, std::filesystem::path const& input) noexcept;
+    FileResult loadScript(std::filesystem::path const& input, LoadedScript& out) noexcept;
+    FileResult mergeScripts(Command const& command, std::vector<LoadedScript>& scripts) noexcept;
+
+    std::string statsHeader() noexcept;
+}
@@ -0,0 +1,213 @@
+#include "OFS_CliCommands.h"
+#include "OFS_Util.h"
+#include "OFS_ThreadPool.h"
+#include "io/OFS_FileLogging.h"
+
+#include <deque>
+#include <format>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <charconv>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+namespace
+{
+    constexpr std::string_view Usage =
+        "usage: ofs-cli <command> [options] <funscripts or directories...>\n"
+        "\n"
+        "commands:\n"
+        "  validate                        report files which needed repairs to load\n"
+        "  stats                           action count, duration and speeds as tab separated values\n"
+        "  simplify --epsilon <value>      Ramer-Douglas-Peucker, epsilon is relative to the average action distance\n"
+        "  resample --interval <ms>        linearly interpolated actions at a fixed interval\n"
+        "  clip     --from <t> --to <t>    keep the actions in a time range, t is milliseconds or hh:mm:ss.mmm\n"
+        "  merge                           combine every input into the file given by --output\n"
+        "  heatmap [--width <px>] [--height <px>]\n"
+        "                                  <name>.heatmap.png for every input, 2000x50 by default\n"
+        "\n"
+        "options:\n"
+        "  -o, --output <path>             output directory, for merge the output file, heatmaps go next to the inputs without it\n"
+        "  -j, --jobs <n>                  files processed at once, defaults to the number of hardware threads\n"
+        "      --log <file>                log file, defaults to ofs-cli.log in the temp directory\n";
+
+    void printLine(std::FILE* stream, std::string_view line) noexcept
+    {
+        std::fwrite(line.data(), 1, line.size(), stream);
+        std::fputc('\n', stream);
+    }
+
+    bool parseUInt(std::string_view str, std::uint32_t& out) noexcept
+    {
+        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), out);
+        return ec == std::errc{} && ptr == str.data() + str.size();
+    }
+
+    bool parseTimeMs(std::string_view str, std::uint32_t& out) noexcept
+    {
+        if (parseUInt(str, out)) return true;
+        bool success = false;
+        auto time = OFS::util::parseTime(str, &success);
+        if (success) out = (std::uint32_t)std::clamp<std::int64_t>(time.count(), 0, FunscriptAction::MaxTimeMs);
+        return success;
+    }
+
+    bool parseCommand(std::string_view name, OFS::cli::CommandType& type) noexcept
+    {
+        using OFS::cli::CommandType;
+        if (name == "validate") type = CommandType::Validate;
+        else if (name == "stats") type = CommandType::Stats;
+        else if (name == "simplify") type = CommandType::Simplify;
+        else if (name == "resample") type = CommandType::Resample;
+        else if (name == "clip") type = CommandType::Clip;
+        else if (name == "merge") type = CommandType::Merge;
+        else if (name == "heatmap") type = CommandType::Heatmap;
+        else return false;
+        return true;
+    }
+
+    // directories are searched recursively for funscripts, the order is kept stable for reproducible output
+    void addInput(std::filesystem::path const& path, std::vector<std::filesystem::path>& inputs) noexcept
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(path, ec)) {
+            inputs.emplace_back(path);
+            return;
+        }
+        auto first = inputs.size();
+        for (auto it = std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, ec);
+            !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_regular_file(ec) && it->path().extension() == Funscript::Extension) {
+                inputs.emplace_back(it->path());
+            }
+        }
+        std::sort(inputs.begin() + first, inputs.end());
+    }
+
+    bool parseArguments(int argc, char* argv[], OFS::cli::Command& command, std::filesystem::path& logPath) noexcept
+    {
+        if (argc < 2 || !parseCommand(argv[1], command.type)) return false;
+
+        bool hasEpsilon = false, hasInterval = false, hasRange = false;
+        for (int i = 2; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            auto value = [&]() noexcept -> std::string_view { return i + 1 < argc ? argv[++i] : std::string_view{}; };
+
+            if (arg == "-o" || arg == "--output") {
+                command.output = OFS::util::pathFromU8String(value());
+            }
+            else if (arg == "-j" || arg == "--jobs") {
+                std::uint32_t jobs = 0;
+                if (!parseUInt(value(), jobs) || jobs == 0) return false;
+                command.jobs = jobs;
+            }
+            else if (arg == "--log") {
+                logPath = OFS::util::pathFromU8String(value());
+            }
+            else if (arg == "--epsilon") {
+                auto str = value();
+                auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), command.epsilon);
+                if (ec != std::errc{} || command.epsilon < 0.f) return false;
+                hasEpsilon = true;
+            }
+            else if (arg == "--interval") {
+                if (!parseUInt(value(), command.intervalMs) || command.intervalMs == 0) return false;
+                hasInterval = true;
+            }
+            else if (arg == "--from") {
+                if (!parseTimeMs(value(), command.fromMs)) return false;
+                hasRange = true;
+            }
+            else if (arg == "--to") {
+                if (!parseTimeMs(value(), command.toMs)) return false;
+                hasRange = true;
+            }
+            else if (arg == "--width") {
+                if (!parseUInt(value(), command.width) || command.width == 0) return false;
+            }
+            else if (arg == "--height") {
+                if (!parseUInt(value(), command.height) || command.height == 0) return false;
+            }
+            else if (arg.starts_with("-")) {
+                return false;
+            }
+            else {
+                addInput(OFS::util::pathFromU8String(arg), command.inputs);
+            }
+        }
+
+        using OFS::cli::CommandType;
+        bool needsOutput = command.type != CommandType::Validate && command.type != CommandType::Stats && command.type != CommandType::Heatmap;
+        if (needsOutput && command.output.empty()) return false;
+        if (command.type == CommandType::Simplify && !hasEpsilon) return false;
+        if (command.type == CommandType::Resample && !hasInterval) return false;
+        if (command.type == CommandType::Clip && (!hasRange || command.fromMs > command.toMs)) return false;
+        return !command.inputs.empty();
+    }
+
+    // Keeps at most jobs files in flight so memory stays bounded no matter how many inputs there are.
+    // Results are reported in input order.
+    template <typename Task, typename OnResult>
+    void runBounded(std::vector<std::filesystem::path> const& inputs, unsigned jobs, Task&& task, OnResult&& onResult) noexcept
+    {
+        auto& pool = OFS::ThreadPool::get();
+        std::deque<std::future<OFS::cli::FileResult>> running;
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            if (running.size() >= jobs) {
+                onResult(running.front().get());
+                running.pop_front();
+            }
+            running.emplace_back(pool.queueTask([&task, &input = inputs[i], i]() noexcept { return task(input, i); }));
+        }
+        while (!running.empty()) {
+            onResult(running.front().get());
+            running.pop_front();
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    OFS::cli::Command command;
+    std::filesystem::path logPath;
+    if (!parseArguments(argc, argv, command, logPath)) {
+        std::fputs(Usage.data(), stderr);
+        return 2;
+    }
+
+    std::error_code ec;
+    if (logPath.empty()) logPath = std::filesystem::temp_directory_path(ec) / "ofs-cli.log";
+    OFS::FileLogger::get().init(logPath.string());
+
+    if (command.jobs == 0) command.jobs = std::max(1u, std::thread::hardware_concurrency());
+    if (command.type != OFS::cli::CommandType::Merge && !command.output.empty()) {
+        std::filesystem::create_directories(command.output, ec);
+    }
+
+    std::size_t failed = 0;
+    auto report = [&failed](OFS::cli::FileResult const& result) noexcept {
+        if (!result.success) failed += 1;
+        if (!result.message.empty()) printLine(result.success ? stdout : stderr, result.message);
+    };
+
+    if (command.type == OFS::cli::CommandType::Merge) {
+        std::vector<OFS::cli::LoadedScript> scripts(command.inputs.size());
+        runBounded(command.inputs, command.jobs,
+            [&scripts](std::filesystem::path const& input, std::size_t idx) noexcept { return OFS::cli::loadScript(input, scripts[idx]); },
+            report);
+        if (failed == 0) report(OFS::cli::mergeScripts(command, scripts));
+    }
+    else {
+        if (command.type == OFS::cli::CommandType::Stats) printLine(stdout, OFS::cli::statsHeader());
+        runBounded(command.inputs, command.jobs,
+            [&command](std::filesystem::path const& input, std::size_t) noexcept { return OFS::cli::processFile(command, input); },
+            report);
+    }
+
+    OFS::FileLogger::get().shutdown();
+    return failed == 0 ? 0 : 1;
+}
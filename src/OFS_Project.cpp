@@ -1,5 +1,6 @@
 #include "OFS_Project.h"
 
+#include <future>
 #include <algorithm>
 #include <filesystem>
 
@@ -7,6 +8,7 @@
 #include "ui/OFS_ImGui.h"
 #include "ui/OFS_DynamicFontAtlas.h"
 #include "ui/OFS_BlockingTask.h"
+#include "OFS_ThreadPool.h"
 #include "io/OFS_FileDialogs.h"
 #include "event/OFS_EventSystem.h"
 #include "localization/OFS_Localization.h"
@@ -30,6 +32,31 @@ static std::array<const char*, 4> AudioExtensions{
     ".wav",
 };
 
+struct LoadedFunscript
+{
+    std::shared_ptr<Funscript> script;
+    Funscript::Metadata metadata;
+    bool loaded = false;
+};
+
+// Safe to call from any thread, nothing is added to the project yet.
+static LoadedFunscript LoadFunscriptFile(std::filesystem::path const& path, bool loadChapters) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    LoadedFunscript result;
+    result.script = std::make_shared<Funscript>();
+
+    OFS::util::MappedFile file;
+    if (file.open(path)) {
+        result.loaded = result.script->Deserialize(file.view(), &result.metadata, loadChapters);
+    }
+    if (!result.loaded) {
+        // don't keep a partially loaded script around
+        result.script = std::make_shared<Funscript>();
+    }
+    return result;
+}
+
 inline bool static HasMediaExtension(std::filesystem::path const& path) noexcept
 {
     auto ext = path.extension().string();
@@ -71,6 +98,25 @@ inline bool FindMedia(std::filesystem::path const& path, std::string* outMedia)
     return false;
 }
 
+// Runs on the thread pool. The project is written and synced to a temporary file first which then
+// replaces the old one, a crash or power loss while saving never leaves a half written project behind.
+static bool WriteProjectFile(std::filesystem::path const& path, std::vector<OFS::StateMeta>& states, OFS_Project::SaveSnapshot const& snapshot) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    for (auto& state : states) {
+        if (auto projectState = std::any_cast<ProjectState>(&state.value)) {
+            auto size = OFS_Binary::Serialize(projectState->binaryFunscriptData, snapshot);
+            if (size == 0) return false;
+            projectState->binaryFunscriptData.resize(size);
+        }
+    }
+
+    std::vector<char> projectBin;
+    OFS::StateManager::serializeStatesBinary(states, projectBin);
+
+    return OFS::util::writeFileAtomic(path, projectBin);
+}
+
 OFS_Project::OFS_Project() noexcept
 {
     stateHandle = OFS::ProjectState<ProjectState>::registerState(ProjectState::StateName, ProjectState::StateName);
@@ -79,6 +125,7 @@ OFS_Project::OFS_Project() noexcept
 
 OFS_Project::~OFS_Project() noexcept
 {
+    WaitForSave();
 }
 
 void OFS_Project::loadNecessaryGlyphs() noexcept
@@ -107,8 +154,13 @@ bool OFS_Project::Load(std::filesystem::path const& path) noexcept
     std::vector<char> projectBin;
     if (OFS::util::readFile(path, projectBin) > 0)
     {
-        if (auto projectState = OFS::util::convertCBORtoJSON(projectBin); !projectState.empty()) 
+        if (OFS::StateManager::isBinaryStateGroup(projectBin))
         {
+            valid = OFS::StateManager::get()->deserializeStateGroupBinary<OFS::ProjectState<void>::STATE_GROUP>(projectBin);
+        }
+        else if (auto projectState = OFS::util::convertCBORtoJSON(projectBin); !projectState.empty()) 
+        {
+            // projects saved by older versions
             valid = OFS::StateManager::get()->deserializeStateGroup<OFS::ProjectState<void>::STATE_GROUP>(projectState);
         }
     }
@@ -129,8 +181,18 @@ bool OFS_Project::Load(std::filesystem::path const& path) noexcept
 
     if (valid) {
         auto& projectState = State();
-        OFS_Binary::Deserialize(projectState.binaryFunscriptData, *this);
+        // projects without a payload keep the single empty script
+        if (!projectState.binaryFunscriptData.empty()
+            && !OFS_Binary::Deserialize(projectState.binaryFunscriptData, *this)) {
+            addError("Failed to load the scripts of the project.");
+            return valid;
+        }
+        projectState.binaryFunscriptData = {};
         lastPath = path;
+        if (projectState.journalId != 0) {
+            // recovers the edits of a session which ended without saving
+            journal.Open(journalPath(), projectState.journalId, Funscripts);
+        }
         loadNecessaryGlyphs();
     }
 
@@ -200,36 +262,23 @@ bool OFS_Project::ImportFromMedia(std::filesystem::path const& file) noexcept
 
 bool OFS_Project::AddFunscript(std::filesystem::path const& path) noexcept
 {
-    bool loadedScript = false;
-
-    bool succ = false;
-    auto jsonText = OFS::util::readFileString(path);
-
-    // QQQ
-    auto json = std::string{};// Util::ParseJson(jsonText, &succ);
-
-    auto script = std::make_shared<Funscript>();
-    auto metadata = Funscript::Metadata();
+    bool isFirstFunscript = Funscripts.size() == 0;
+    auto loaded = LoadFunscriptFile(path, isFirstFunscript);
+    addLoadedFunscript(path, loaded.script, loaded.metadata, loaded.loaded);
+    return loaded.loaded;
+}
 
+void OFS_Project::addLoadedFunscript(std::filesystem::path const& path, std::shared_ptr<Funscript> script, Funscript::Metadata const& metadata, bool loaded) noexcept
+{
     bool isFirstFunscript = Funscripts.size() == 0;
-    if (succ && script->Deserialize(/*json, */&metadata, isFirstFunscript)) {
-        // Add existing script to project
-        script = Funscripts.emplace_back(std::move(script));
-        script->UpdateRelativePath(MakePathRelative(path));
-        if (isFirstFunscript) {
-            // Initialize project metadata using the first funscript
-            auto& projectState = State();
-            projectState.metadata = metadata;
-        }
-        loadedScript = true;
-    }
-    else {
-        // Add empty script to project
-        script = std::make_shared<Funscript>();
-        script->UpdateRelativePath(MakePathRelative(path));
-        script = Funscripts.emplace_back(std::move(script));
+    // Add the script to the project, failed scripts get added empty
+    script = Funscripts.emplace_back(std::move(script));
+    script->UpdateRelativePath(MakePathRelative(path));
+    if (loaded && isFirstFunscript) {
+        // Initialize project metadata using the first funscript
+        auto& projectState = State();
+        projectState.metadata = metadata;
     }
-    return loadedScript;
 }
 
 void OFS_Project::RemoveFunscript(int32_t idx) noexcept
@@ -242,32 +291,123 @@ void OFS_Project::RemoveFunscript(int32_t idx) noexcept
 
 void OFS_Project::Save(std::filesystem::path const& path, bool clearUnsavedChanges) noexcept
 {
-    {
-        auto& projectState = State();
-        projectState.binaryFunscriptData.clear();
-        auto size = OFS_Binary::Serialize(projectState.binaryFunscriptData, *this);
-        projectState.binaryFunscriptData.resize(size);
+    SaveRequest request{ path, clearUnsavedChanges };
+    if (runningSave.valid()) {
+        // Only one save runs at a time, the requests made in the meantime are merged
+        // into one which saves the newest state. A backup never replaces a full save.
+        if (!queuedSave || clearUnsavedChanges || !queuedSave->clearUnsavedChanges) {
+            queuedSave = std::move(request);
+        }
+        return;
     }
+    startSave(std::move(request));
+}
 
-#if 1
-    // QQQ
-    //auto projectState = OFS_StateManager::Get()->SerializeProjectAll(true);
-    //auto projectBin = Util::SerializeCBOR(projectState);
-    //OFS::util::writeFile(path.c_str(), projectBin.data(), projectBin.size());
-#else
-    auto projectState = OFS_StateManager::Get()->SerializeProjectAll(false);
-    auto projectJson = Util::SerializeJson(projectState, false);
-    OFS::util::writeFile(path.c_str(), projectJson.data(), projectJson.size());
-#endif
-    if (clearUnsavedChanges) {
-        for (auto& script : Funscripts) {
-            script->ClearUnsavedEdits();
+void OFS_Project::startSave(SaveRequest request) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    // Only copies happen here, the scripts share their actions with the snapshots.
+    // The payload gets filled in on the thread pool.
+    auto& projectState = State();
+    projectState.binaryFunscriptData = {};
+    auto states = OFS::StateManager::get()->copyStateGroup<OFS::ProjectState<void>::STATE_GROUP>();
+
+    // the journal of the previous save no longer applies to a full save
+    auto journalId = request.clearUnsavedChanges ? OFS_ProjectJournal::NewBaseId() : projectState.journalId;
+    for (auto& state : states) {
+        if (auto savedState = std::any_cast<ProjectState>(&state.value)) {
+            savedState->journalId = journalId;
         }
     }
+
+    SaveSnapshot snapshot;
+    snapshot.Scripts.reserve(Funscripts.size());
+    runningBaseline.clear();
+    for (auto& script : Funscripts) {
+        auto& saved = snapshot.Scripts.emplace_back(script->TakeSaveSnapshot());
+        runningBaseline.emplace_back(saved.State);
+    }
+    runningScripts = Funscripts;
+    runningJournalId = journalId;
+    runningSaveTime = std::chrono::system_clock::now();
+    runningRequest = request;
+
+    runningSave = OFS::ThreadPool::get().queueTask(
+        [path = std::move(request.path), states = std::move(states), snapshot = std::move(snapshot)]() mutable noexcept {
+            bool success = WriteProjectFile(path, states, snapshot);
+            EV::Enqueue<ProjectSavedEvent>(path, success);
+            return success;
+        });
+}
+
+void OFS_Project::finishRunningSave() noexcept
+{
+    bool success = runningSave.get();
+    if (!success) {
+        LOGF_ERROR("Failed to save \"{:s}\"", runningRequest.path.string());
+    }
+    else if (runningRequest.clearUnsavedChanges) {
+        // edits made while saving stay unsaved
+        for (auto& script : runningScripts) {
+            if (script->EditTime() <= runningSaveTime) {
+                script->ClearUnsavedEdits();
+            }
+        }
+        State().journalId = runningJournalId;
+        journal.Reset(journalPath(), runningJournalId, runningScripts, runningBaseline);
+    }
+    runningScripts.clear();
+    runningBaseline.clear();
+
+    if (queuedSave) {
+        auto request = std::move(*queuedSave);
+        queuedSave.reset();
+        startSave(std::move(request));
+    }
+}
+
+void OFS_Project::WaitForSave() noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    while (runningSave.valid()) {
+        finishRunningSave();
+    }
+    // finishing an export starts the one queued for its path
+    while (!runningExports.empty()) {
+        auto exported = std::move(runningExports.front());
+        runningExports.erase(runningExports.begin());
+        finishExport(exported);
+    }
+}
+
+bool OFS_Project::Journal() noexcept
+{
+    if (!valid) return false;
+    return journal.Append(Funscripts);
+}
+
+std::filesystem::path OFS_Project::journalPath() const noexcept
+{
+    auto path = lastPath;
+    path += OFS_ProjectJournal::Extension;
+    return path;
 }
 
 void OFS_Project::Update(float delta, bool idleMode) noexcept
 {
+    if (runningSave.valid() && runningSave.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        finishRunningSave();
+    }
+    for (std::size_t i = 0; i < runningExports.size();) {
+        if (runningExports[i].result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            auto exported = std::move(runningExports[i]);
+            runningExports.erase(runningExports.begin() + i);
+            finishExport(exported);
+        }
+        else {
+            i += 1;
+        }
+    }
     if (!idleMode) {
         auto& projectState = State();
         projectState.activeTimer += delta;
@@ -331,32 +471,21 @@ void OFS_Project::ShowProjectWindow(bool* open) noexcept
 
 void OFS_Project::ExportFunscripts() noexcept
 {
-    auto& state = State();
     for (auto& script : Funscripts) {
         FUN_ASSERT(!script->RelativePath().empty(), "path is empty");
         if (!script->RelativePath().empty()) {
-            auto json = script->Serialize(state.metadata, true);
-            script->ClearUnsavedEdits();
-            // QQQ
-            auto jsonText = std::string{};// Util::SerializeJson(json, false);
-            OFS::util::writeFile(MakePathAbsolute(script->RelativePath()), jsonText);
+            queueExport(MakePathAbsolute(script->RelativePath()), script, true);
         }
     }
 }
 
 void OFS_Project::ExportFunscripts(std::filesystem::path const& outputDir) noexcept
 {
-    auto& state = State();
     for (auto& script : Funscripts) {
         FUN_ASSERT(!script->RelativePath().empty(), "path is empty");
         if (!script->RelativePath().empty()) {
             auto filename = script->RelativePath().filename();
-            auto outputPath = outputDir / filename;
-            auto json = script->Serialize(state.metadata, true);
-            script->ClearUnsavedEdits();
-            // QQQ
-            auto jsonText = std::string{};// Util::SerializeJson(json, false);
-            OFS::util::writeFile(outputPath, jsonText);
+            queueExport(outputDir / filename, script, true);
         }
     }
 }
@@ -364,14 +493,70 @@ void OFS_Project::ExportFunscripts(std::filesystem::path const& outputDir) noexc
 void OFS_Project::ExportFunscript(std::filesystem::path const& outputPath, int32_t idx) noexcept
 {
     FUN_ASSERT(idx >= 0 && idx < Funscripts.size(), "out of bounds");
-    auto& state = State();
-    auto json = Funscripts[idx]->Serialize(state.metadata, true);
-    Funscripts[idx]->ClearUnsavedEdits();
+    queueExport(outputPath, Funscripts[idx], true);
     // Using this function changes the default path
     Funscripts[idx]->UpdateRelativePath(MakePathRelative(outputPath));
-    // QQQ
-    auto jsonText = std::string{};// Util::SerializeJson(json, false);
-    OFS::util::writeFile(outputPath, jsonText);
+}
+
+void OFS_Project::queueExport(std::filesystem::path path, std::shared_ptr<Funscript> const& script, bool clearUnsavedChanges) noexcept
+{
+    ExportRequest request{ std::move(path), script, script->TakeSaveSnapshot(), State().metadata,
+        std::chrono::system_clock::now(), clearUnsavedChanges };
+
+    auto samePath = [&request](auto const& other) noexcept { return other.path == request.path; };
+    if (std::any_of(runningExports.begin(), runningExports.end(), samePath)) {
+        // the newer snapshot wins, the file would be overwritten anyway
+        if (auto queued = std::find_if(queuedExports.begin(), queuedExports.end(), samePath); queued != queuedExports.end()) {
+            *queued = std::move(request);
+        }
+        else {
+            queuedExports.emplace_back(std::move(request));
+        }
+        return;
+    }
+    startExport(std::move(request));
+}
+
+// One task per script, the json is built and written on the thread pool.
+void OFS_Project::startExport(ExportRequest request) noexcept
+{
+    auto& exported = runningExports.emplace_back();
+    exported.script = std::move(request.script);
+    exported.path = request.path;
+    exported.time = request.time;
+    exported.clearUnsavedChanges = request.clearUnsavedChanges;
+    exported.result = OFS::ThreadPool::get().queueTask(
+        [path = std::move(request.path), snapshot = std::move(request.snapshot), metadata = std::move(request.metadata)]() noexcept {
+            OFS_PROFILE("ExportFunscript");
+            // stays allocated for the next export on this thread
+            thread_local std::string json;
+            Funscript::Serialize(json, snapshot, metadata);
+            return OFS::util::writeFileAtomic(path, json);
+        });
+}
+
+// Runs on the main thread once the export task is done.
+void OFS_Project::finishExport(RunningExport& exported) noexcept
+{
+    bool success = exported.result.get();
+    if (!success) {
+        LOGF_ERROR("Failed to export \"{:s}\"", exported.path.string());
+    }
+    else if (auto script = exported.script.lock(); script && exported.clearUnsavedChanges) {
+        // edits made while exporting stay unsaved
+        if (script->EditTime() <= exported.time) {
+            script->ClearUnsavedEdits();
+        }
+    }
+    EV::Enqueue<FunscriptExportedEvent>(exported.path, success);
+
+    auto queued = std::find_if(queuedExports.begin(), queuedExports.end(),
+        [&exported](auto const& request) noexcept { return request.path == exported.path; });
+    if (queued != queuedExports.end()) {
+        auto request = std::move(*queued);
+        queuedExports.erase(queued);
+        startExport(std::move(request));
+    }
 }
 
 void OFS_Project::loadMultiAxis(std::filesystem::path const& rootScript) noexcept
@@ -417,11 +602,16 @@ void OFS_Project::loadMultiAxis(std::filesystem::path const& rootScript) noexcep
             }
         }
     }
-    // load the related files
+    // parse the related files in parallel but add them in the same order as before
+    std::vector<std::future<LoadedFunscript>> loading;
+    loading.reserve(relatedFiles.size());
     for (int i = relatedFiles.size() - 1; i >= 0; i -= 1) {
-        auto& file = relatedFiles[i];
-        auto filePathString = file.string();
-        AddFunscript(filePathString);
+        loading.emplace_back(OFS::ThreadPool::get().queueTask(
+            [path = relatedFiles[i]]() noexcept { return LoadFunscriptFile(path, false); }));
+    }
+    for (int i = relatedFiles.size() - 1, futureIdx = 0; i >= 0; i -= 1, futureIdx += 1) {
+        auto loaded = loading[futureIdx].get();
+        addLoadedFunscript(relatedFiles[i], std::move(loaded.script), loaded.metadata, loaded.loaded);
     }
 }
 
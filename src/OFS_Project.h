@@ -1,14 +1,18 @@
 #pragma once
 #include "state/ProjectState.h"
+#include "OFS_ProjectJournal.h"
 #include "Funscript/Funscript.h"
 #include "event/OFS_Event.h"
 
 #include "state/OFS_StateManager.h"
 
+#include <chrono>
+#include <future>
 #include <vector>
 #include <memory>
 #include <string>
 #include <cstdint>
+#include <optional>
 
 class ProjectLoadedEvent: public OFS_Event<ProjectLoadedEvent>
 {
@@ -16,6 +20,24 @@ public:
     ProjectLoadedEvent() noexcept {}
 };
 
+class ProjectSavedEvent : public OFS_Event<ProjectSavedEvent>
+{
+public:
+    std::filesystem::path Path;
+    bool Success;
+    ProjectSavedEvent(std::filesystem::path path, bool success) noexcept
+        : Path(std::move(path)), Success(success) {}
+};
+
+class FunscriptExportedEvent : public OFS_Event<FunscriptExportedEvent>
+{
+public:
+    std::filesystem::path Path;
+    bool Success;
+    FunscriptExportedEvent(std::filesystem::path path, bool success) noexcept
+        : Path(std::move(path)), Success(success) {}
+};
+
 #define OFS_PROJECT_EXT ".ofsp"
 
 class OFS_Project
@@ -30,9 +52,35 @@ public:
 
     std::vector<std::shared_ptr<Funscript>> Funscripts;
 
+    // Everything a save writes, taking one only copies the states and shares the actions.
+    struct SaveSnapshot
+    {
+        std::vector<Funscript::SaveSnapshot> Scripts;
+
+        // write only, in the layout OFS_Project::serialize reads
+        constexpr static auto serialize(auto& archive, auto& self) noexcept
+        {
+            std::uint32_t count = (std::uint32_t)self.Scripts.size();
+            if (auto result = archive(count); zpp::bits::failure(result)) return result;
+            for (auto& script : self.Scripts) {
+                if (auto result = archive(script); zpp::bits::failure(result)) return result;
+            }
+            return zpp::bits::errc{};
+        }
+    };
+
     bool Load(std::filesystem::path const& path) noexcept;
+    // Saving runs on the thread pool, a ProjectSavedEvent reports the result.
     void Save(bool clearUnsavedChanges) noexcept { Save(lastPath, clearUnsavedChanges); }
     void Save(std::filesystem::path const& path, bool clearUnsavedChanges) noexcept;
+    // Blocks until the running and queued saves and all exports are written.
+    void WaitForSave() noexcept;
+    inline bool IsSaving() const noexcept { return runningSave.valid(); }
+    // Appends the edits since the last call to the journal next to the project file.
+    // Returns false if they couldn't be journaled and a full save is needed instead.
+    bool Journal() noexcept;
+    // The unsaved edits won't be recovered on the next load.
+    inline void DiscardJournal() noexcept { journal.Discard(); }
 
     bool ImportFromFunscript(std::filesystem::path const& path) noexcept;
     bool ImportFromMedia(std::filesystem::path const& path) noexcept;
@@ -54,6 +102,8 @@ public:
     inline const std::string& NotValidError() const noexcept { return notValidError; }
     inline ProjectState& State() const noexcept { return ProjectState::State(stateHandle); }
 
+    // Exports run on the thread pool, every script is written by its own task.
+    // A script only loses its unsaved edits once the file is written, a FunscriptExportedEvent reports the result.
     void ExportFunscripts() noexcept;
     void ExportFunscripts(std::filesystem::path const& outputDir) noexcept;
     void ExportFunscript(std::filesystem::path const& outputPath, int32_t idx) noexcept;
@@ -62,16 +112,26 @@ public:
     std::filesystem::path MakePathRelative(std::filesystem::path const& absPath) const noexcept;
     std::filesystem::path MediaPath() const noexcept;
 
-    template<typename S>
-    void serialize(S& s)
+    static constexpr std::uint32_t MaxFunscripts = 1024;
+
+    // Layout of the scripts inside ProjectState::binaryFunscriptData, see OFS_Binary.
+    constexpr static auto serialize(auto& archive, auto& self) noexcept
     {
-        //s.ext(*this, bitsery::ext::Growable{},
-        //    [](S& s, OFS_Project& o) {
-        //        s.container(o.Funscripts, 100,
-        //            [](S& s, std::shared_ptr<Funscript>& script) {
-        //                s.ext(script, bitsery::ext::StdSmartPtr{});
-        //            });
-        //    });
+        using Archive = std::remove_cvref_t<decltype(archive)>;
+        std::uint32_t count = (std::uint32_t)self.Funscripts.size();
+        if (auto result = archive(count); zpp::bits::failure(result)) return result;
+
+        if constexpr (Archive::kind() == zpp::bits::kind::in) {
+            if (count > MaxFunscripts) return zpp::bits::errc{ std::errc::value_too_large };
+            self.Funscripts.clear();
+            for (std::uint32_t i = 0; i < count; ++i) {
+                self.Funscripts.emplace_back(std::make_shared<Funscript>());
+            }
+        }
+        for (auto& script : self.Funscripts) {
+            if (auto result = archive(*script); zpp::bits::failure(result)) return result;
+        }
+        return zpp::bits::errc{};
     }
 
 private:
@@ -79,6 +139,41 @@ private:
     OFS::StateHandle bookmarkStateHandle = OFS::StateManager::INVALID_ID;
 
     std::filesystem::path lastPath;
+    OFS_ProjectJournal journal;
+
+    struct SaveRequest
+    {
+        std::filesystem::path path;
+        bool clearUnsavedChanges = false;
+    };
+    std::future<bool> runningSave;
+    SaveRequest runningRequest;
+    std::optional<SaveRequest> queuedSave;
+    // state of the running save which is needed once it's written
+    std::vector<std::shared_ptr<Funscript>> runningScripts;
+    std::vector<Funscript::FunscriptSnapshot> runningBaseline;
+    std::chrono::system_clock::time_point runningSaveTime;
+    std::uint64_t runningJournalId = 0;
+    struct ExportRequest
+    {
+        std::filesystem::path path;
+        std::weak_ptr<Funscript> script;
+        Funscript::SaveSnapshot snapshot;
+        Funscript::Metadata metadata;
+        std::chrono::system_clock::time_point time;
+        bool clearUnsavedChanges = false;
+    };
+    struct RunningExport
+    {
+        std::future<bool> result;
+        std::weak_ptr<Funscript> script;
+        std::filesystem::path path;
+        std::chrono::system_clock::time_point time;
+        bool clearUnsavedChanges = false;
+    };
+    std::vector<RunningExport> runningExports;
+    // only one export per path runs at a time, a newer export to the same path replaces the queued one
+    std::vector<ExportRequest> queuedExports;
 
     std::string notValidError;
     bool valid = false;
@@ -90,6 +185,13 @@ private:
         notValidError += error;
     }
     void loadNecessaryGlyphs() noexcept;
+    std::filesystem::path journalPath() const noexcept;
+    void startSave(SaveRequest request) noexcept;
+    void finishRunningSave() noexcept;
+    void queueExport(std::filesystem::path path, std::shared_ptr<Funscript> const& script, bool clearUnsavedChanges) noexcept;
+    void startExport(ExportRequest request) noexcept;
+    void finishExport(RunningExport& exported) noexcept;
     void loadMultiAxis(std::filesystem::path const& rootScript) noexcept;
+    void addLoadedFunscript(std::filesystem::path const& path, std::shared_ptr<Funscript> script, Funscript::Metadata const& metadata, bool loaded) noexcept;
 
 };
@@ -0,0 +1,338 @@
+#include "OFS_ProjectJournal.h"
+#include "OFS_Util.h"
+#include "OFS_Profiling.h"
+
+#include <mutex>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <condition_variable>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr std::uint32_t JournalVersion = 1;
+
+    struct JournalHeader
+    {
+        char magic[4] = { 'O', 'F', 'S', 'J' };
+        std::uint32_t version = JournalVersion;
+        std::uint64_t baseId = 0;
+        std::uint32_t scriptCount = 0;
+        std::uint32_t reserved = 0;
+    };
+
+    // followed by the payload: the index of the script and the packed delta
+    struct RecordHeader
+    {
+        std::uint32_t payloadSize;
+        std::uint32_t checksum;
+    };
+
+    // FNV-1a, only has to catch records torn by a crash
+    std::uint32_t checksum(const std::uint8_t* data, std::size_t size) noexcept
+    {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    std::vector<std::uint8_t> makeHeader(std::uint64_t baseId, std::size_t scriptCount) noexcept
+    {
+        JournalHeader header;
+        header.baseId = baseId;
+        header.scriptCount = (std::uint32_t)scriptCount;
+        std::vector<std::uint8_t> out(sizeof(header));
+        std::memcpy(out.data(), &header, sizeof(header));
+        return out;
+    }
+
+    void appendRecord(std::vector<std::uint8_t>& out, std::uint32_t scriptIdx, const Funscript::FunscriptDelta& delta) noexcept
+    {
+        auto packed = delta.Pack();
+        RecordHeader record{ (std::uint32_t)(sizeof(scriptIdx) + packed.size()), 0 };
+        auto offset = out.size();
+        out.resize(offset + sizeof(record) + record.payloadSize);
+        auto payload = out.data() + offset + sizeof(record);
+        std::memcpy(payload, &scriptIdx, sizeof(scriptIdx));
+        std::memcpy(payload + sizeof(scriptIdx), packed.data(), packed.size());
+        record.checksum = checksum(payload, record.payloadSize);
+        std::memcpy(out.data() + offset, &record, sizeof(record));
+    }
+
+    std::FILE* openJournalFile(std::filesystem::path const& path, bool append) noexcept
+    {
+#if defined(_WIN32)
+        return _wfopen(path.c_str(), append ? L"ab" : L"wb");
+#else
+        return std::fopen(path.c_str(), append ? "ab" : "wb");
+#endif
+    }
+
+    bool syncFile(std::FILE* file) noexcept
+    {
+        if (std::fflush(file) != 0) return false;
+#if defined(_WIN32)
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+}
+
+struct OFS_ProjectJournal::Writer
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    std::filesystem::path path;
+    std::vector<std::uint8_t> pending;
+    // written after truncating the file
+    std::vector<std::uint8_t> header;
+    bool truncate = false;
+    bool discard = false;
+    bool exit = false;
+};
+
+void OFS_ProjectJournal::startWriter() noexcept
+{
+    if (writerThread.joinable()) return;
+    if (!writer) writer = std::make_shared<Writer>();
+    writerThread = std::thread(writerFunction, writer);
+}
+
+OFS_ProjectJournal::~OFS_ProjectJournal() noexcept
+{
+    if (writerThread.joinable()) {
+        {
+            std::lock_guard lock(writer->mtx);
+            writer->exit = true;
+        }
+        writer->cv.notify_one();
+        writerThread.join();
+    }
+}
+
+void OFS_ProjectJournal::writerFunction(std::shared_ptr<Writer> writer) noexcept
+{
+    std::FILE* file = nullptr;
+    std::filesystem::path filePath;
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::uint8_t> header;
+
+    for (;;) {
+        std::filesystem::path path;
+        bool discard, truncate, exit;
+        {
+            std::unique_lock lock(writer->mtx);
+            writer->cv.wait(lock, [&writer]() noexcept {
+                return writer->exit || writer->discard || writer->truncate || !writer->pending.empty();
+            });
+            path = writer->path;
+            discard = std::exchange(writer->discard, false);
+            truncate = std::exchange(writer->truncate, false);
+            exit = writer->exit;
+            if (truncate) header.swap(writer->header);
+            buffer.swap(writer->pending);
+        }
+
+        if (discard) {
+            auto target = file ? filePath : path;
+            if (file) { std::fclose(file); file = nullptr; }
+            std::error_code ec;
+            std::filesystem::remove(target, ec);
+        }
+        if (truncate) {
+            if (file) std::fclose(file);
+            file = openJournalFile(path, false);
+            filePath = path;
+            if (file) std::fwrite(header.data(), 1, header.size(), file);
+        }
+        if (!buffer.empty() && !file) {
+            file = openJournalFile(path, true);
+            filePath = path;
+        }
+        if (file && (truncate || !buffer.empty())) {
+            // one sync per batch no matter how many records it holds
+            bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size()
+                && syncFile(file);
+            if (!ok) LOGF_ERROR("Failed to write edit journal \"{:s}\"", filePath.string());
+        }
+        else if (!buffer.empty()) {
+            LOGF_ERROR("Failed to open edit journal \"{:s}\"", path.string());
+        }
+        buffer.clear();
+
+        if (exit) break;
+    }
+    if (file) std::fclose(file);
+}
+
+std::uint64_t OFS_ProjectJournal::NewBaseId() noexcept
+{
+    std::random_device rd;
+    std::uint64_t id = ((std::uint64_t)rd() << 32) ^ rd()
+        ^ (std::uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+    return id != 0 ? id : 1;
+}
+
+void OFS_ProjectJournal::trackScripts(std::vector<std::shared_ptr<Funscript>> const& scripts, std::span<const Funscript::FunscriptSnapshot> baseline) noexcept
+{
+    FUN_ASSERT(baseline.empty() || baseline.size() == scripts.size(), "baseline doesn't match the scripts");
+    scriptIds.clear();
+    journaled.clear();
+    for (std::size_t i = 0; i < scripts.size(); ++i) {
+        scriptIds.emplace_back(scripts[i].get());
+        journaled.emplace_back(baseline.empty() ? scripts[i]->TakeSnapshot() : baseline[i]);
+    }
+}
+
+bool OFS_ProjectJournal::sameScripts(std::vector<std::shared_ptr<Funscript>> const& scripts) const noexcept
+{
+    return std::equal(scriptIds.begin(), scriptIds.end(), scripts.begin(), scripts.end(),
+        [](const Funscript* id, const std::shared_ptr<Funscript>& script) noexcept { return id == script.get(); });
+}
+
+std::size_t OFS_ProjectJournal::Open(std::filesystem::path const& path, std::uint64_t baseId, std::vector<std::shared_ptr<Funscript>> const& scripts) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    std::size_t replayed = 0;
+    std::size_t validSize = 0;
+    {
+        OFS::util::MappedFile file;
+        JournalHeader header;
+        bool matches = file.open(path) && file.size() >= sizeof(header);
+        if (matches) {
+            std::memcpy(&header, file.data(), sizeof(header));
+            matches = std::memcmp(header.magic, JournalHeader{}.magic, sizeof(header.magic)) == 0
+                && header.version == JournalVersion
+                && header.baseId == baseId
+                && header.scriptCount == scripts.size();
+        }
+
+        if (matches) {
+            auto data = reinterpret_cast<const std::uint8_t*>(file.data());
+            std::size_t offset = sizeof(header);
+            // stops at the first torn or corrupted record
+            while (file.size() - offset >= sizeof(RecordHeader)) {
+                RecordHeader record;
+                std::memcpy(&record, data + offset, sizeof(record));
+                auto payload = data + offset + sizeof(record);
+                if (record.payloadSize < sizeof(std::uint32_t)
+                    || record.payloadSize > file.size() - offset - sizeof(record)
+                    || record.checksum != checksum(payload, record.payloadSize)) {
+                    break;
+                }
+
+                std::uint32_t scriptIdx;
+                std::memcpy(&scriptIdx, payload, sizeof(scriptIdx));
+                Funscript::FunscriptDelta delta;
+                auto packed = std::span<const std::uint8_t>(payload + sizeof(scriptIdx), record.payloadSize - sizeof(scriptIdx));
+                if (scriptIdx >= scripts.size() || !Funscript::FunscriptDelta::Unpack(packed, delta)) {
+                    break;
+                }
+                scripts[scriptIdx]->ApplyDelta(delta);
+                replayed += 1;
+                offset += sizeof(record) + record.payloadSize;
+            }
+            validSize = offset;
+        }
+    }
+
+    if (validSize > 0) {
+        // drop a torn tail so new records directly follow the replayed ones
+        std::error_code ec;
+        if (std::filesystem::file_size(path, ec) != validSize) {
+            std::filesystem::resize_file(path, validSize, ec);
+        }
+        if (ec) {
+            LOGF_ERROR("Failed to truncate edit journal \"{:s}\"", path.string());
+            Reset(path, baseId, scripts);
+            return replayed;
+        }
+        startWriter();
+        {
+            std::lock_guard lock(writer->mtx);
+            writer->path = path;
+        }
+        trackScripts(scripts);
+        open = true;
+    }
+    else {
+        Reset(path, baseId, scripts);
+    }
+
+    if (replayed > 0) {
+        LOGF_INFO("Recovered {:d} edits from \"{:s}\"", replayed, path.string());
+    }
+    return replayed;
+}
+
+void OFS_ProjectJournal::Reset(std::filesystem::path const& path, std::uint64_t baseId, std::vector<std::shared_ptr<Funscript>> const& scripts,
+    std::span<const Funscript::FunscriptSnapshot> baseline) noexcept
+{
+    startWriter();
+    {
+        std::lock_guard lock(writer->mtx);
+        // queued records belong to the previous save
+        writer->pending.clear();
+        writer->path = path;
+        writer->header = makeHeader(baseId, scripts.size());
+        writer->truncate = true;
+    }
+    writer->cv.notify_one();
+    trackScripts(scripts, baseline);
+    open = true;
+}
+
+bool OFS_ProjectJournal::Append(std::vector<std::shared_ptr<Funscript>> const& scripts) noexcept
+{
+    if (!open || !sameScripts(scripts)) return false;
+    OFS_PROFILE(__FUNCTION__);
+
+    std::vector<std::uint8_t> records;
+    for (std::size_t i = 0; i < scripts.size(); ++i) {
+        auto snapshot = scripts[i]->TakeSnapshot();
+        auto delta = Funscript::Diff(journaled[i], snapshot);
+        journaled[i] = std::move(snapshot);
+        // the selection isn't worth recovering
+        if (!delta.HasActionChanges()) continue;
+        delta.SelectionFlips.clear();
+        appendRecord(records, (std::uint32_t)i, delta);
+    }
+
+    if (!records.empty()) {
+        {
+            std::lock_guard lock(writer->mtx);
+            writer->pending.insert(writer->pending.end(), records.begin(), records.end());
+        }
+        writer->cv.notify_one();
+    }
+    return true;
+}
+
+void OFS_ProjectJournal::Discard() noexcept
+{
+    if (!open) return;
+    {
+        std::lock_guard lock(writer->mtx);
+        writer->pending.clear();
+        writer->truncate = false;
+        writer->discard = true;
+    }
+    writer->cv.notify_one();
+    scriptIds.clear();
+    journaled.clear();
+    open = false;
+}
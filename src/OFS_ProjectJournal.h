@@ -0,0 +1,57 @@
+#pragma once
+#include "Funscript/Funscript.h"
+
+#include <span>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <filesystem>
+
+// Append-only log of the script edits made since the last full save of a project.
+// Every record holds the delta of one script, records are checksummed and written
+// by a background thread which syncs them to disk once per batch.
+// A journal belongs to exactly one full save through its base id,
+// on load the records are replayed on top of the saved scripts.
+class OFS_ProjectJournal
+{
+public:
+    static constexpr auto Extension = ".journal";
+
+    OFS_ProjectJournal() noexcept = default;
+    OFS_ProjectJournal(const OFS_ProjectJournal&) = delete;
+    OFS_ProjectJournal(OFS_ProjectJournal&&) = delete;
+    ~OFS_ProjectJournal() noexcept;
+
+    // Replays the journal at path if it was started on top of baseId.
+    // Journaling continues on the resulting state, returns the number of replayed records.
+    std::size_t Open(std::filesystem::path const& path, std::uint64_t baseId, std::vector<std::shared_ptr<Funscript>> const& scripts) noexcept;
+    // Starts an empty journal on top of a full save.
+    // baseline holds the saved state of every script, without one their current state is used.
+    void Reset(std::filesystem::path const& path, std::uint64_t baseId, std::vector<std::shared_ptr<Funscript>> const& scripts,
+        std::span<const Funscript::FunscriptSnapshot> baseline = {}) noexcept;
+    // Queues the edits made since the last call.
+    // Returns false when the edits can't be journaled, for example after a script was added or removed.
+    bool Append(std::vector<std::shared_ptr<Funscript>> const& scripts) noexcept;
+    // Stops journaling and deletes the journal so the edits don't get recovered.
+    void Discard() noexcept;
+
+    inline bool IsOpen() const noexcept { return open; }
+
+    static std::uint64_t NewBaseId() noexcept;
+
+private:
+    struct Writer;
+    std::shared_ptr<Writer> writer;
+    std::thread writerThread;
+
+    // the journaled state of every script, in project order
+    std::vector<const Funscript*> scriptIds;
+    std::vector<Funscript::FunscriptSnapshot> journaled;
+    bool open = false;
+
+    static void writerFunction(std::shared_ptr<Writer> writer) noexcept;
+    void startWriter() noexcept;
+    void trackScripts(std::vector<std::shared_ptr<Funscript>> const& scripts, std::span<const Funscript::FunscriptSnapshot> baseline = {}) noexcept;
+    bool sameScripts(std::vector<std::shared_ptr<Funscript>> const& scripts) const noexcept;
+};
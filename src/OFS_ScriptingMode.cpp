@@ -168,7 +168,7 @@ void ScriptingMode::AddEditAction(FunscriptAction action) noexcept
     if (!app->player->isPaused()) {
         // apply offset
         auto& state = ScriptingModeState::State(stateHandle);
-        action.atS += state.actionInsertDelayMs / 1000.f;
+        action.at = FunscriptAction::OffsetMs(action.at, state.actionInsertDelayMs);
     }
     Mode()->AddEditAction(action);
 }
@@ -241,10 +241,10 @@ void DynamicInjectionMode::DrawModeSettings() noexcept
 // dynamic injection
 void DynamicInjectionMode::AddEditAction(FunscriptAction action) noexcept
 {
-    auto previous = ctx().GetPreviousActionBehind(action.atS);
+    auto previous = ctx().GetPreviousActionBehindMs(action.at);
     if (previous != nullptr) {
-        auto injectAt = previous->atS + ((action.atS - previous->atS) / 2) + (((action.atS - previous->atS) / 2) * directionBias);
-        auto inject_duration = injectAt - previous->atS;
+        auto injectAt = previous->atS() + ((action.atS() - previous->atS()) / 2) + (((action.atS() - previous->atS()) / 2) * directionBias);
+        auto inject_duration = injectAt - previous->atS();
 
         int32_t injectPos = Util::Clamp<int32_t>(previous->pos + (topBottomDirection * inject_duration * targetSpeed), 0, 100);
         ScriptingModeBase::AddEditAction(FunscriptAction(injectAt, injectPos));
@@ -307,7 +307,7 @@ void AlternatingMode::DrawModeSettings() noexcept
 void AlternatingMode::AddEditAction(FunscriptAction action) noexcept
 {
     if (contextSensitive) {
-        auto behind = ctx().GetPreviousActionBehind(action.atS - 0.001f);
+        auto behind = ctx().GetPreviousActionBehindMs(action.at);
         if (behind && behind->pos <= 50 && action.pos <= 50) {
             // Top
             action.pos = 100 - action.pos;
@@ -3,10 +3,14 @@
 #include "OFS_Profiling.h"
 #include "Funscript/FunscriptUndoSystem.h"
 #include "localization/OFS_Localization.h"
+#include "OFS_Util.h"
+#include "OFS_SDLUtil.h"
 
 #include <imgui.h>
 
 #include <array>
+#include <algorithm>
+#include <functional>
 
 // this array provides strings for the StateType enum
 // for this to work the order needs to be maintained
@@ -66,12 +70,66 @@ UndoSystem::UndoSystem() noexcept
     UndoStack.reserve(1000);
 }
 
+std::vector<const Funscript*> UndoSystem::collectScripts() const noexcept
+{
+    std::vector<const Funscript*> scripts;
+    auto collect = [&scripts](const std::vector<UndoContext>& stack) noexcept {
+        for (auto& context : stack) {
+            for (auto& weak : context.Scripts) {
+                if (auto script = weak.lock()) scripts.emplace_back(script.get());
+            }
+        }
+    };
+    collect(UndoStack);
+    collect(RedoStack);
+    std::sort(scripts.begin(), scripts.end());
+    scripts.erase(std::unique(scripts.begin(), scripts.end()), scripts.end());
+    return scripts;
+}
+
+UndoMemoryUsage UndoSystem::memoryUsage() const noexcept
+{
+    UndoMemoryUsage usage;
+    for (auto script : collectScripts()) {
+        auto scriptUsage = script->undoSystem->MemoryUsage();
+        usage.ResidentBytes += scriptUsage.ResidentBytes;
+        usage.SpilledBytes += scriptUsage.SpilledBytes;
+    }
+    return usage;
+}
+
+void UndoSystem::enforceMemoryBudget() noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    auto scripts = collectScripts();
+    std::vector<std::pair<std::size_t, const Funscript*>> residentPerScript;
+    std::size_t resident = 0;
+    for (auto script : scripts) {
+        auto bytes = script->undoSystem->MemoryUsage().ResidentBytes;
+        residentPerScript.emplace_back(bytes, script);
+        resident += bytes;
+    }
+    if (resident <= memoryBudget) return;
+
+    // take from the largest histories first
+    std::sort(residentPerScript.begin(), residentPerScript.end(), std::greater<>());
+    auto spillDir = OFS::util::preferredPath("tmp");
+    for (auto [bytes, script] : residentPerScript) {
+        resident -= script->undoSystem->SpillOldest(resident - memoryBudget, spillDir);
+        if (resident <= memoryBudget) break;
+    }
+}
+
 void UndoSystem::ShowUndoRedoHistory(bool* open) noexcept
 {
     if (!*open) return;
     OFS_PROFILE(__FUNCTION__);
     ImGui::SetNextWindowSizeConstraints(ImVec2(200, 100), ImVec2(200, 200));
     ImGui::Begin(TR_ID(UndoSystem::WindowId, Tr::UNDO_REDO_HISTORY).c_str(), open, ImGuiWindowFlags_AlwaysVerticalScrollbar | ImGuiWindowFlags_AlwaysAutoResize);
+    auto usage = memoryUsage();
+    ImGui::TextDisabled("%s: %s", TR(UNDO_RESIDENT), OFS::util::formatBytes(usage.ResidentBytes).c_str());
+    ImGui::TextDisabled("%s: %s", TR(UNDO_SPILLED), OFS::util::formatBytes(usage.SpilledBytes).c_str());
+    ImGui::Separator();
     ImGui::TextDisabled(TR(REDO_STACK));
 
     for (auto it = RedoStack.begin(), end = RedoStack.end(); it != end; ++it) {
@@ -116,6 +174,7 @@ void UndoSystem::Snapshot(StateType type, UndoContextScripts&& scriptsToSnapshot
             FUN_ASSERT(false, "Stale weak_ptr.");
         }
     }
+    enforceMemoryBudget();
 }
 
 bool UndoSystem::Undo() noexcept
@@ -168,6 +227,22 @@ bool UndoSystem::Redo() noexcept
     return redidSomething;
 }
 
+bool UndoSystem::Amend(StateType type) noexcept
+{
+    if (!MatchUndoTop(type)) return false;
+    OFS_PROFILE(__FUNCTION__);
+    bool amendedSomething = false;
+    for (auto& weak : UndoStack.back().Scripts) {
+        if (auto script = weak.lock()) {
+            amendedSomething = script->undoSystem->Amend() || amendedSomething;
+        }
+        else {
+            LOG_DEBUG("Stale amend.");
+        }
+    }
+    return amendedSomething;
+}
+
 void UndoSystem::ClearRedo() noexcept
 {
     RedoStack.clear();
@@ -63,11 +63,19 @@ private:
     std::vector<UndoContext> UndoStack;
     std::vector<UndoContext> RedoStack;
     void ClearRedo() noexcept;
+    // memory budget for the undo steps of all scripts, older steps get spilled to disk past it
+    std::size_t memoryBudget = 256 * 1024 * 1024;
+
+    std::vector<const Funscript*> collectScripts() const noexcept;
+    // memory held by the undo systems of all scripts on the stacks
+    UndoMemoryUsage memoryUsage() const noexcept;
+    void enforceMemoryBudget() noexcept;
 
 public:
     UndoSystem() noexcept;
     static constexpr const char* WindowId = "###UNDO_REDO_HISTORY";
     void ShowUndoRedoHistory(bool* open) noexcept;
+    inline void SetMemoryBudget(std::size_t bytes) noexcept { memoryBudget = bytes; enforceMemoryBudget(); }
 
     void Snapshot(StateType type, std::weak_ptr<const Funscript> scriptToSnapshot, bool clearRedo = true) noexcept
     {
@@ -78,6 +86,9 @@ public:
         bool clearRedo = true) noexcept;
     bool Undo() noexcept;
     bool Redo() noexcept;
+    // Reverts the scripts of the top undo step to their state before it, when the step is of the given type.
+    // Meant for continuous edits which recompute their result from the original state every tick.
+    bool Amend(StateType type) noexcept;
 
     inline bool MatchUndoTop(int32_t type) const noexcept { return !UndoEmpty() && UndoStack.back().Type == type; }
     inline bool UndoEmpty() const noexcept { return UndoStack.empty(); }
@@ -11,6 +11,7 @@
 #include "state/OpenFunscripterState.h"
 #include "videoplayer/OFS_MpvLoader.h"
 #include "Funscript/FunscriptHeatmap.h"
+#include "Funscript/FunscriptHeatmapExport.h"
 
 #include "OFS_Util.h"
 #include "OFS_Profiling.h"
@@ -30,6 +31,7 @@
 
 #include <SDL3/SDL.h>
 
+#include <cmath>
 #include <chrono>
 #include <format>
 #include <string>
@@ -105,13 +107,11 @@ bool OpenFunscripter::imguiSetup() noexcept
     return true;
 }
 
-// QQQ
 static void SaveState() noexcept
 {
-    //auto stateJson = OFS_StateManager::Get()->SerializeAppAll(true);
-    //auto stateBin = Util::SerializeCBOR(stateJson);
-    //auto statePath = std::filesystem::path(Util::Prefpath("state.ofs")).string();
-    //OFS::util::writeFile(statePath.c_str(), stateBin.data(), stateBin.size());
+    auto stateBin = OFS::StateManager::get()->serializeStateGroupBinary<OFS::AppState<void>::STATE_GROUP>();
+    auto statePath = OFS::util::preferredPath("state.ofs");
+    OFS::util::writeFile(statePath, stateBin);
 }
 
 OpenFunscripter::~OpenFunscripter() noexcept
@@ -145,7 +145,11 @@ bool OpenFunscripter::Init(int argc, char* argv[])
         auto statePath = OFS::util::preferredPath("state.ofs");
         if (OFS::util::readFile(statePath, fileData) > 0)
         {
-            if (auto json = OFS::util::convertCBORtoJSON(fileData); !json.empty())
+            if (OFS::StateManager::isBinaryStateGroup(fileData))
+            {
+                stateMgr->deserializeStateGroupBinary<OFS::AppState<void>::STATE_GROUP>(fileData);
+            }
+            else if (auto json = OFS::util::convertCBORtoJSON(fileData); !json.empty())
             {
                 stateMgr->deserializeStateGroup<OFS::AppState<void>::STATE_GROUP>(json);
             }
@@ -229,6 +233,7 @@ bool OpenFunscripter::Init(int argc, char* argv[])
 
     playerControls.Init(player.get(), prefState.forceHwDecoding);
     undoSystem = std::make_unique<UndoSystem>();
+    undoSystem->SetMemoryBudget((std::size_t)prefState.undoMemoryBudgetMB * 1024 * 1024);
 
     registerBindings();
 
@@ -245,6 +250,10 @@ bool OpenFunscripter::Init(int argc, char* argv[])
         OFS_SDL_Event::HandleEvent(EVENT_SYSTEM_BIND(this, &OpenFunscripter::ControllerAxisPlaybackSpeed)));
     EV::Queue().appendListener(VideoLoadedEvent::EventType,
         VideoLoadedEvent::HandleEvent(EVENT_SYSTEM_BIND(this, &OpenFunscripter::VideoLoaded)));
+    EV::Queue().appendListener(ProjectSavedEvent::EventType,
+        ProjectSavedEvent::HandleEvent(EVENT_SYSTEM_BIND(this, &OpenFunscripter::ProjectSaved)));
+    EV::Queue().appendListener(FunscriptExportedEvent::EventType,
+        FunscriptExportedEvent::HandleEvent(EVENT_SYSTEM_BIND(this, &OpenFunscripter::FunscriptExported)));
     EV::Queue().appendListener(DurationChangeEvent::EventType,
         DurationChangeEvent::HandleEvent(EVENT_SYSTEM_BIND(this, &OpenFunscripter::VideoDuration)));
     EV::Queue().appendListener(PlayPauseChangeEvent::EventType,
@@ -522,7 +531,7 @@ void OpenFunscripter::registerBindings()
             { "prev_action",
                 [this]() {
                     auto action = ActiveFunscript()->GetPreviousActionBehind(player->CurrentTime() - 0.001f);
-                    if (action != nullptr) player->SetPositionExact(action->atS);
+                    if (action != nullptr) player->SetPositionExact(action->atS());
                 },
                 false },
             Tr::ACTION_PREVIOUS_ACTION, "Navigation",
@@ -533,7 +542,7 @@ void OpenFunscripter::registerBindings()
             { "next_action",
                 [this]() {
                     auto action = ActiveFunscript()->GetNextActionAhead(player->CurrentTime() + 0.001f);
-                    if (action != nullptr) player->SetPositionExact(action->atS);
+                    if (action != nullptr) player->SetPositionExact(action->atS());
                 },
                 false },
             Tr::ACTION_NEXT_ACTION, "Navigation",
@@ -551,9 +560,9 @@ void OpenFunscripter::registerBindings()
                         auto& script = LoadedFunscripts()[i];
                         auto action = script->GetPreviousActionBehind(currentTime - 0.001f);
                         if (action != nullptr) {
-                            if (std::abs(currentTime - action->atS) < std::abs(currentTime - closestTime)) {
+                            if (std::abs(currentTime - action->atS()) < std::abs(currentTime - closestTime)) {
                                 foundAction = true;
-                                closestTime = action->atS;
+                                closestTime = action->atS();
                             }
                         }
                     }
@@ -577,9 +586,9 @@ void OpenFunscripter::registerBindings()
                         auto& script = LoadedFunscripts()[i];
                         auto action = script->GetNextActionAhead(currentTime + 0.001f);
                         if (action != nullptr) {
-                            if (std::abs(currentTime - action->atS) < std::abs(currentTime - closestTime)) {
+                            if (std::abs(currentTime - action->atS()) < std::abs(currentTime - closestTime)) {
                                 foundAction = true;
-                                closestTime = action->atS;
+                                closestTime = action->atS();
                             }
                         }
                     }
@@ -801,8 +810,8 @@ void OpenFunscripter::registerBindings()
         if (app->ActiveFunscript()->HasSelection()) {
 
             auto time = forward
-                ? app->scripting->SteppingIntervalForward(app->ActiveFunscript()->Selection().front().atS)
-                : app->scripting->SteppingIntervalBackward(app->ActiveFunscript()->Selection().front().atS);
+                ? app->scripting->SteppingIntervalForward(app->ActiveFunscript()->FirstSelected()->atS())
+                : app->scripting->SteppingIntervalBackward(app->ActiveFunscript()->FirstSelected()->atS());
 
             app->undoSystem->Snapshot(StateType::ACTIONS_MOVED, app->ActiveFunscript());
             app->ActiveFunscript()->MoveSelectionTime(time, app->scripting->LogicalFrameTime());
@@ -811,14 +820,14 @@ void OpenFunscripter::registerBindings()
             auto closest = ptr->ActiveFunscript()->GetClosestAction(app->player->CurrentTime());
             if (closest != nullptr) {
                 auto time = forward
-                    ? app->scripting->SteppingIntervalForward(closest->atS)
-                    : app->scripting->SteppingIntervalBackward(closest->atS);
+                    ? app->scripting->SteppingIntervalForward(closest->atS())
+                    : app->scripting->SteppingIntervalBackward(closest->atS());
 
-                FunscriptAction moved(closest->atS + time, closest->pos);
-                auto closestInMoveRange = app->ActiveFunscript()->GetActionAtTime(moved.atS, app->scripting->LogicalFrameTime());
+                auto moved = FunscriptAction::FromMs(FunscriptAction::OffsetMs(closest->at, std::llround(time * 1000.0)), closest->pos);
+                auto closestInMoveRange = app->ActiveFunscript()->GetActionAtTime(moved.atS(), app->scripting->LogicalFrameTime());
                 if (closestInMoveRange == nullptr
-                    || (forward && closestInMoveRange->atS < moved.atS)
-                    || (!forward && closestInMoveRange->atS > moved.atS)) {
+                    || (forward && closestInMoveRange->at < moved.at)
+                    || (!forward && closestInMoveRange->at > moved.at)) {
                     app->undoSystem->Snapshot(StateType::ACTIONS_MOVED, app->ActiveFunscript());
                     app->ActiveFunscript()->EditAction(*closest, moved);
                 }
@@ -829,35 +838,35 @@ void OpenFunscripter::registerBindings()
         auto app = OpenFunscripter::ptr;
         if (app->ActiveFunscript()->HasSelection()) {
             auto time = forward
-                ? app->scripting->SteppingIntervalForward(app->ActiveFunscript()->Selection().front().atS)
-                : app->scripting->SteppingIntervalBackward(app->ActiveFunscript()->Selection().front().atS);
+                ? app->scripting->SteppingIntervalForward(app->ActiveFunscript()->FirstSelected()->atS())
+                : app->scripting->SteppingIntervalBackward(app->ActiveFunscript()->FirstSelected()->atS());
 
             app->undoSystem->Snapshot(StateType::ACTIONS_MOVED, app->ActiveFunscript());
             app->ActiveFunscript()->MoveSelectionTime(time, app->scripting->LogicalFrameTime());
             auto closest = ptr->ActiveFunscript()->GetClosestActionSelection(app->player->CurrentTime());
             if (closest != nullptr) {
-                app->player->SetPositionExact(closest->atS);
+                app->player->SetPositionExact(closest->atS());
             }
             else {
-                app->player->SetPositionExact(app->ActiveFunscript()->Selection().front().atS);
+                app->player->SetPositionExact(app->ActiveFunscript()->FirstSelected()->atS());
             }
         }
         else {
             auto closest = app->ActiveFunscript()->GetClosestAction(ptr->player->CurrentTime());
             if (closest != nullptr) {
                 auto time = forward
-                    ? app->scripting->SteppingIntervalForward(closest->atS)
-                    : app->scripting->SteppingIntervalBackward(closest->atS);
+                    ? app->scripting->SteppingIntervalForward(closest->atS())
+                    : app->scripting->SteppingIntervalBackward(closest->atS());
 
-                FunscriptAction moved(closest->atS + time, closest->pos);
-                auto closestInMoveRange = app->ActiveFunscript()->GetActionAtTime(moved.atS, app->scripting->LogicalFrameTime());
+                auto moved = FunscriptAction::FromMs(FunscriptAction::OffsetMs(closest->at, std::llround(time * 1000.0)), closest->pos);
+                auto closestInMoveRange = app->ActiveFunscript()->GetActionAtTime(moved.atS(), app->scripting->LogicalFrameTime());
 
                 if (closestInMoveRange == nullptr
-                    || (forward && closestInMoveRange->atS < moved.atS)
-                    || (!forward && closestInMoveRange->atS > moved.atS)) {
+                    || (forward && closestInMoveRange->at < moved.at)
+                    || (!forward && closestInMoveRange->at > moved.at)) {
                     app->undoSystem->Snapshot(StateType::ACTIONS_MOVED, app->ActiveFunscript());
                     app->ActiveFunscript()->EditAction(*closest, moved);
-                    app->player->SetPositionExact(moved.atS);
+                    app->player->SetPositionExact(moved.atS());
                 }
             }
         }
@@ -876,7 +885,7 @@ void OpenFunscripter::registerBindings()
                         auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
                         if (closest != nullptr) {
                             undoSystem->Snapshot(StateType::ACTIONS_MOVED, ActiveFunscript());
-                            ActiveFunscript()->EditAction(*closest, FunscriptAction(closest->atS, Util::Clamp<int32_t>(closest->pos + 10, 0, 100)));
+                            ActiveFunscript()->EditAction(*closest, FunscriptAction::FromMs(closest->at, Util::Clamp<int32_t>(closest->pos + 10, 0, 100)));
                         }
                     }
                 },
@@ -894,7 +903,7 @@ void OpenFunscripter::registerBindings()
                         auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
                         if (closest != nullptr) {
                             undoSystem->Snapshot(StateType::ACTIONS_MOVED, ActiveFunscript());
-                            ActiveFunscript()->EditAction(*closest, FunscriptAction(closest->atS, Util::Clamp<int32_t>(closest->pos - 10, 0, 100)));
+                            ActiveFunscript()->EditAction(*closest, FunscriptAction::FromMs(closest->at, Util::Clamp<int32_t>(closest->pos - 10, 0, 100)));
                         }
                     }
                 },
@@ -912,7 +921,7 @@ void OpenFunscripter::registerBindings()
                         auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
                         if (closest != nullptr) {
                             undoSystem->Snapshot(StateType::ACTIONS_MOVED, ActiveFunscript());
-                            ActiveFunscript()->EditAction(*closest, FunscriptAction(closest->atS, Util::Clamp<int32_t>(closest->pos + 5, 0, 100)));
+                            ActiveFunscript()->EditAction(*closest, FunscriptAction::FromMs(closest->at, Util::Clamp<int32_t>(closest->pos + 5, 0, 100)));
                         }
                     }
                 },
@@ -930,7 +939,7 @@ void OpenFunscripter::registerBindings()
                         auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
                         if (closest != nullptr) {
                             undoSystem->Snapshot(StateType::ACTIONS_MOVED, ActiveFunscript());
-                            ActiveFunscript()->EditAction(*closest, FunscriptAction(closest->atS, Util::Clamp<int32_t>(closest->pos - 5, 0, 100)));
+                            ActiveFunscript()->EditAction(*closest, FunscriptAction::FromMs(closest->at, Util::Clamp<int32_t>(closest->pos - 5, 0, 100)));
                         }
                     }
                 },
@@ -984,10 +993,10 @@ void OpenFunscripter::registerBindings()
                     else {
                         auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
                         if (closest != nullptr) {
-                            FunscriptAction moved(closest->atS, closest->pos + 1);
-                            if (moved.pos <= 100 && moved.pos >= 0) {
+                            int32_t newPos = closest->pos + 1;
+                            if (newPos >= 0 && newPos <= 100) {
                                 undoSystem->Snapshot(StateType::ACTIONS_MOVED, ActiveFunscript());
-                                ActiveFunscript()->EditAction(*closest, moved);
+                                ActiveFunscript()->EditAction(*closest, FunscriptAction::FromMs(closest->at, newPos));
                             }
                         }
                     }
@@ -1006,10 +1015,10 @@ void OpenFunscripter::registerBindings()
                     else {
                         auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
                         if (closest != nullptr) {
-                            FunscriptAction moved(closest->atS, closest->pos - 1);
-                            if (moved.pos <= 100 && moved.pos >= 0) {
+                            int32_t newPos = closest->pos - 1;
+                            if (newPos >= 0 && newPos <= 100) {
                                 undoSystem->Snapshot(StateType::ACTIONS_MOVED, ActiveFunscript());
-                                ActiveFunscript()->EditAction(*closest, moved);
+                                ActiveFunscript()->EditAction(*closest, FunscriptAction::FromMs(closest->at, newPos));
                             }
                         }
                     }
@@ -1381,7 +1390,11 @@ void OpenFunscripter::FunscriptChanged(const FunscriptActionsChangedEvent* ev) n
         }
     }
 
-    Status = Status | OFS_Status::OFS_GradientNeedsUpdate;
+    // the heatmap only shows the active script
+    if (ptr == ActiveFunscript().get()) {
+        heatmapChangedFromMs = std::min(heatmapChangedFromMs, ev->FromMs);
+        heatmapChangedToMs = std::max(heatmapChangedToMs, ev->ToMs);
+    }
 }
 
 void OpenFunscripter::ScriptTimelineActionClicked(const FunscriptActionClickedEvent* ev) noexcept
@@ -1392,7 +1405,7 @@ void OpenFunscripter::ScriptTimelineActionClicked(const FunscriptActionClickedEv
         }
     }
     else {
-        player->SetPositionExact(ev->action.atS);
+        player->SetPositionExact(ev->action.atS());
     }
 }
 
@@ -1446,6 +1459,22 @@ void OpenFunscripter::VideoLoaded(const VideoLoadedEvent* ev) noexcept
     OFS_PROFILE(__FUNCTION__);
 }
 
+void OpenFunscripter::ProjectSaved(const ProjectSavedEvent* ev) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (!ev->Success) {
+        OFS::util::MessageBoxAlert(TR(FAILED_TO_SAVE), std::string(TR(FAILED_TO_SAVE_MSG)) + "\n" + ev->Path.string());
+    }
+}
+
+void OpenFunscripter::FunscriptExported(const FunscriptExportedEvent* ev) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (!ev->Success) {
+        OFS::util::MessageBoxAlert(TR(FAILED_TO_EXPORT), std::string(TR(FAILED_TO_EXPORT_MSG)) + "\n" + ev->Path.string());
+    }
+}
+
 void OpenFunscripter::PlayPauseChange(const PlayPauseChangeEvent* ev) noexcept
 {
     OFS_PROFILE(__FUNCTION__);
@@ -1490,6 +1519,12 @@ void OpenFunscripter::autoBackup() noexcept
     OFS_PROFILE(__FUNCTION__);
     lastBackup = std::chrono::steady_clock::now();
 
+    // Only the edits since the last backup get appended to the journal.
+    // A full backup is only written when they can't be journaled.
+    if (LoadedProject->Journal()) {
+        return;
+    }
+
     auto backupDir = OFS::util::preferredPath("backup");
     auto name = OFS::util::filename(OFS::util::pathFromU8String(player->videoPath()));
     name = OFS::util::trim(name); // this needs to be trimmed because trailing spaces
@@ -1545,6 +1580,7 @@ void OpenFunscripter::exitApp(bool force) noexcept
                     Status |= OFS_Status::OFS_ShouldExit;
                 }
                 else if (result == OFS::util::YesNoCancel::NO) {
+                    LoadedProject->DiscardJournal();
                     Status |= OFS_Status::OFS_ShouldExit;
                 }
                 else {
@@ -1612,13 +1648,23 @@ void OpenFunscripter::Step() noexcept
             keys->RenderKeybindingWindow();
             chapterMgr->ShowWindow(&ofsState.showChapterManager);
 
-            if (preferences->ShowPreferenceWindow()) {}
+            if (preferences->ShowPreferenceWindow()) {
+                const auto& prefState = PreferenceState::State(preferences->StateHandle());
+                undoSystem->SetMemoryBudget((std::size_t)prefState.undoMemoryBudgetMB * 1024 * 1024);
+            }
 
             playerControls.DrawControls();
 
             if (Status & OFS_GradientNeedsUpdate) {
                 Status &= ~(OFS_GradientNeedsUpdate);
                 playerControls.UpdateHeatmap(player->Duration(), ActiveFunscript()->Actions());
+                heatmapChangedFromMs = std::numeric_limits<uint32_t>::max();
+                heatmapChangedToMs = 0;
+            }
+            else if (heatmapChangedFromMs <= heatmapChangedToMs) {
+                playerControls.UpdateHeatmapRange(player->Duration(), ActiveFunscript()->Actions(), heatmapChangedFromMs, heatmapChangedToMs);
+                heatmapChangedFromMs = std::numeric_limits<uint32_t>::max();
+                heatmapChangedToMs = 0;
             }
 
             playerControls.DrawTimeline();
@@ -1626,7 +1672,8 @@ void OpenFunscripter::Step() noexcept
             scriptTimeline.ShowScriptPositions(player.get(),
                 scripting->Overlay().get(),
                 LoadedFunscripts(),
-                LoadedProject->ActiveIdx());
+                LoadedProject->ActiveIdx(),
+                &playerControls.Heatmap->speeds);
 
             ShowStatisticsWindow(&ofsState.showStatistics);
 
@@ -1896,6 +1943,10 @@ bool OpenFunscripter::closeProject(bool closeWithUnsavedChanges) noexcept
     }
     else {
         UpdateNewActiveScript(0);
+        if (LoadedProject) {
+            // a running save has to finish while the state of its project is still around
+            LoadedProject->WaitForSave();
+        }
         LoadedProject = std::make_unique<OFS_Project>();
         player->closeVideo();
         playerControls.videoPreview->CloseVideo();
@@ -1930,7 +1981,8 @@ void OpenFunscripter::saveHeatmap(const char* path, int width, int height, bool
     }
     else {
         auto bitmap = playerControls.Heatmap->RenderToBitmap(width, height);
-        OFS::util::savePNG(path, bitmap.data(), width, height, 4);
+        // rendered on the CPU, the rows are already top to bottom
+        OFS::util::savePNG(path, bitmap.data(), width, height, 4, false);
     }
 }
 
@@ -1977,10 +2029,7 @@ void OpenFunscripter::copySelection() noexcept
 {
     OFS_PROFILE(__FUNCTION__);
     if (ActiveFunscript()->HasSelection()) {
-        CopiedSelection.clear();
-        for (auto action : ActiveFunscript()->Selection()) {
-            CopiedSelection.emplace(action);
-        }
+        CopiedSelection = ActiveFunscript()->SelectedActions();
     }
 }
 
@@ -1991,18 +2040,22 @@ void OpenFunscripter::pasteSelection() noexcept
     undoSystem->Snapshot(StateType::PASTE_COPIED_ACTIONS, ActiveFunscript());
     // paste CopiedSelection relatively to position
     // NOTE: assumes CopiedSelection is ordered by time
-    float currentTime = player->CurrentTime();
-    float offsetTime = currentTime - CopiedSelection.begin()->atS;
+    auto currentTime = FunscriptAction::ToMs(player->CurrentTime());
+    int64_t offsetMs = (int64_t)currentTime - CopiedSelection.front().at;
 
-    ActiveFunscript()->RemoveActionsInInterval(
-        currentTime - 0.0005f,
-        currentTime + (CopiedSelection.back().atS - CopiedSelection.front().atS + 0.0005f));
-
-    for (auto&& action : CopiedSelection) {
-        ActiveFunscript()->AddAction(FunscriptAction(action.atS + offsetTime, action.pos));
+    {
+        Funscript::EditBatch batch(*ActiveFunscript());
+        batch.Reserve(CopiedSelection.size(), 0);
+        batch.RemoveInterval(
+            currentTime,
+            FunscriptAction::OffsetMs(CopiedSelection.back().at, offsetMs));
+
+        for (auto&& action : CopiedSelection) {
+            batch.Add(FunscriptAction::FromMs(FunscriptAction::OffsetMs(action.at, offsetMs), action.pos));
+        }
     }
-    float newPosTime = (CopiedSelection.end() - 1)->atS + offsetTime;
-    player->SetPositionExact(newPosTime);
+    auto newPosTime = FunscriptAction::OffsetMs(CopiedSelection.back().at, offsetMs);
+    player->SetPositionExact(FunscriptAction::ToSeconds(newPosTime));
 }
 
 void OpenFunscripter::pasteSelectionExact() noexcept
@@ -2011,13 +2064,15 @@ void OpenFunscripter::pasteSelectionExact() noexcept
     if (CopiedSelection.empty()) return;
 
     undoSystem->Snapshot(StateType::PASTE_COPIED_ACTIONS, ActiveFunscript());
+    Funscript::EditBatch batch(*ActiveFunscript());
+    batch.Reserve(CopiedSelection.size(), 0);
     if (CopiedSelection.size() >= 2) {
-        ActiveFunscript()->RemoveActionsInInterval(CopiedSelection.front().atS, CopiedSelection.back().atS);
+        batch.RemoveInterval(CopiedSelection.front().at, CopiedSelection.back().at);
     }
 
     // paste without altering timestamps
     for (auto&& action : CopiedSelection) {
-        ActiveFunscript()->AddAction(action);
+        batch.Add(action);
     }
 }
 
@@ -2029,9 +2084,9 @@ void OpenFunscripter::equalizeSelection() noexcept
         // this is a small hack
         auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
         if (closest != nullptr) {
-            auto behind = ActiveFunscript()->GetPreviousActionBehind(closest->atS);
+            auto behind = ActiveFunscript()->GetPreviousActionBehindMs(closest->at);
             if (behind != nullptr) {
-                auto front = ActiveFunscript()->GetNextActionAhead(closest->atS);
+                auto front = ActiveFunscript()->GetNextActionAheadMs(closest->at);
                 if (front != nullptr) {
                     ActiveFunscript()->SelectAction(*behind);
                     ActiveFunscript()->SelectAction(*closest);
@@ -2042,7 +2097,7 @@ void OpenFunscripter::equalizeSelection() noexcept
             }
         }
     }
-    else if (ActiveFunscript()->Selection().size() >= 3) {
+    else if (ActiveFunscript()->SelectionSize() >= 3) {
         undoSystem->Snapshot(StateType::EQUALIZE_ACTIONS, ActiveFunscript());
         ActiveFunscript()->EqualizeSelection();
     }
@@ -2061,7 +2116,7 @@ void OpenFunscripter::invertSelection() noexcept
             ActiveFunscript()->ClearSelection();
         }
     }
-    else if (ActiveFunscript()->Selection().size() >= 3) {
+    else if (ActiveFunscript()->SelectionSize() >= 3) {
         undoSystem->Snapshot(StateType::INVERT_ACTIONS, ActiveFunscript());
         ActiveFunscript()->InvertSelection();
     }
@@ -2073,8 +2128,8 @@ void OpenFunscripter::isolateAction() noexcept
     auto closest = ActiveFunscript()->GetClosestAction(player->CurrentTime());
     if (closest != nullptr) {
         undoSystem->Snapshot(StateType::ISOLATE_ACTION, ActiveFunscript());
-        auto prev = ActiveFunscript()->GetPreviousActionBehind(closest->atS - 0.001f);
-        auto next = ActiveFunscript()->GetNextActionAhead(closest->atS + 0.001f);
+        auto prev = ActiveFunscript()->GetPreviousActionBehindMs(closest->at);
+        auto next = ActiveFunscript()->GetNextActionAheadMs(closest->at);
         if (prev != nullptr && next != nullptr) {
             auto tmp = *next; // removing prev will invalidate the pointer
             ActiveFunscript()->RemoveAction(*prev);
@@ -2094,25 +2149,26 @@ void OpenFunscripter::repeatLastStroke() noexcept
     OFS_PROFILE(__FUNCTION__);
     auto stroke = ActiveFunscript()->GetLastStroke(player->CurrentTime());
     if (stroke.size() > 1) {
-        auto offsetTime = player->CurrentTime() - stroke.back().atS;
+        auto offsetTime = player->CurrentTime() - stroke.back().atS();
+        int64_t offsetMs = (int64_t)FunscriptAction::ToMs(player->CurrentTime()) - stroke.back().at;
         undoSystem->Snapshot(StateType::REPEAT_STROKE, ActiveFunscript());
         auto action = ActiveFunscript()->GetActionAtTime(player->CurrentTime(), scripting->LogicalFrameTime());
         // if we are on top of an action we ignore the first action of the last stroke
         if (action != nullptr) {
             for (int i = stroke.size() - 2; i >= 0; i--) {
                 auto action = stroke[i];
-                action.atS += offsetTime;
+                action.at = FunscriptAction::OffsetMs(action.at, offsetMs);
                 ActiveFunscript()->AddAction(action);
             }
         }
         else {
             for (int i = stroke.size() - 1; i >= 0; i--) {
                 auto action = stroke[i];
-                action.atS += offsetTime;
+                action.at = FunscriptAction::OffsetMs(action.at, offsetMs);
                 ActiveFunscript()->AddAction(action);
             }
         }
-        player->SetPositionExact(stroke.front().atS + offsetTime);
+        player->SetPositionExact(stroke.front().atS() + offsetTime);
     }
 }
 
@@ -2395,6 +2451,35 @@ void OpenFunscripter::ShowMainMenuBar() noexcept
                     },
                     ext, "PNG");
             }
+            if (ImGui::MenuItem(TR(SAVE_HEATMAPS_FOR_DIRECTORY), NULL, false, !blockingTask.currentTask)) {
+                OFS::util::openDirectoryDialog(
+                    TR(SAVE_HEATMAPS_FOR_DIRECTORY), ofsState.heatmapSettings.defaultPath,
+                    [this](auto& result) {
+                        if (result.files.empty()) return;
+                        auto& ofsState = OpenFunscripterState::State(stateHandle);
+                        // the heatmaps are written next to their scripts
+                        auto batch = new OFS::funscript::HeatmapBatch;
+                        batch->directory = result.files.front();
+                        batch->width = (uint32_t)std::max(1, ofsState.heatmapSettings.defaultWidth);
+                        batch->height = (uint32_t)std::max(1, ofsState.heatmapSettings.defaultHeight);
+
+                        auto task = std::make_unique<BlockingTaskData>();
+                        task->TaskDescription = TR(SAVE_HEATMAPS_FOR_DIRECTORY);
+                        task->User = batch;
+                        task->TaskThreadFunc = [](void* data) -> int {
+                            auto task = (BlockingTaskData*)data;
+                            std::unique_ptr<OFS::funscript::HeatmapBatch> batch((OFS::funscript::HeatmapBatch*)task->User);
+                            auto result = OFS::funscript::renderHeatmaps(*batch,
+                                [task](std::size_t done, std::size_t total) noexcept {
+                                    task->MaxProgress = (int)total;
+                                    task->Progress = (int)done;
+                                });
+                            LOGF_INFO("Saved {:d} heatmaps, {:d} failed.", result.written, result.failed.size());
+                            return 0;
+                        };
+                        blockingTask.DoTask(std::move(task));
+                    });
+            }
             ImGui::Separator();
             if (ImGui::MenuItem(TR(UNDO), BINDING_STRING("undo"), false, !undoSystem->UndoEmpty())) {
                 this->Undo();
@@ -2731,7 +2816,7 @@ void OpenFunscripter::ShowStatisticsWindow(bool* open) noexcept
     const FunscriptAction* front = ActiveFunscript()->GetActionAtTime(currentTime, 0.001f);
     const FunscriptAction* behind = nullptr;
     if (front != nullptr) {
-        behind = ActiveFunscript()->GetPreviousActionBehind(front->atS);
+        behind = ActiveFunscript()->GetPreviousActionBehindMs(front->at);
     }
     else {
         behind = ActiveFunscript()->GetPreviousActionBehind(currentTime);
@@ -2739,11 +2824,11 @@ void OpenFunscripter::ShowStatisticsWindow(bool* open) noexcept
     }
 
     if (behind != nullptr) {
-        FUN_ASSERT(((double)currentTime - behind->atS) * 1000.0 > 0.001, "This maybe a bug");
+        FUN_ASSERT(((double)currentTime - behind->atS()) * 1000.0 > 0.001, "This maybe a bug");
 
-        ImGui::Text("%s: %.2lf ms", TR(INTERVAL), ((double)currentTime - behind->atS) * 1000.0);
+        ImGui::Text("%s: %.2lf ms", TR(INTERVAL), ((double)currentTime - behind->atS()) * 1000.0);
         if (front != nullptr) {
-            auto duration = front->atS - behind->atS;
+            auto duration = front->atS() - behind->atS();
             int32_t length = front->pos - behind->pos;
             ImGui::Text("%s: %.02lf units/s", TR(SPEED), std::abs(length) / duration);
             ImGui::Text("%s: %.2lf ms", TR(DURATION), (double)duration * 1000.0);
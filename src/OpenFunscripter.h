@@ -28,6 +28,7 @@
 #include <SDL3/SDL.h>
 
 #include <memory>
+#include <limits>
 #include <chrono>
 
 enum OFS_Status : uint8_t {
@@ -58,6 +59,10 @@ private:
     FunscriptArray CopiedSelection;
     std::chrono::steady_clock::time_point lastBackup;
 
+    // changed time range of the active script which isn't reflected in the heatmap yet
+    uint32_t heatmapChangedFromMs = std::numeric_limits<uint32_t>::max();
+    uint32_t heatmapChangedToMs = 0;
+
     char tmpBuf[2][32];
 
     void setIdle(bool idle) noexcept;
@@ -80,6 +85,8 @@ private:
 
     void VideoDuration(const DurationChangeEvent* ev) noexcept;
     void VideoLoaded(const VideoLoadedEvent* ev) noexcept;
+    void ProjectSaved(const ProjectSavedEvent* ev) noexcept;
+    void FunscriptExported(const FunscriptExportedEvent* ev) noexcept;
     void PlayPauseChange(const PlayPauseChangeEvent* ev) noexcept;
 
     void ControllerAxisPlaybackSpeed(const OFS_SDL_Event* ev) noexcept;
@@ -202,6 +209,7 @@ inline void OpenFunscripter::closeWithoutSavingDialog(OnCloseAction&& onProjectC
                 }
                 else if (result == OFS::util::YesNoCancel::NO) {
                     /* don't save */
+                    LoadedProject->DiscardJournal();
                     closeProject(true);
                     onProjectCloseHandler();
                 }
@@ -109,8 +109,11 @@ bool OFS_ChapterManager::ExportClip(const Chapter& chapter, std::filesystem::pat
         auto clippedScript = Funscript();
         auto slice = script->GetSelection(chapter.startTime, chapter.endTime);
         clippedScript.SetActions(slice);
-        clippedScript.AddEditAction(FunscriptAction(chapter.startTime, script->GetPositionAtTime(chapter.startTime)), 0.001f);
-        clippedScript.AddEditAction(FunscriptAction(chapter.endTime, script->GetPositionAtTime(chapter.endTime)), 0.001f);
+        const float clipTimes[2] = { chapter.startTime, chapter.endTime };
+        float clipPositions[2];
+        script->SamplePositions(clipTimes, clipPositions);
+        clippedScript.AddEditAction(FunscriptAction(chapter.startTime, clipPositions[0]), 0.001f);
+        clippedScript.AddEditAction(FunscriptAction(chapter.endTime, clipPositions[1]), 0.001f);
         clippedScript.SelectAll();
         clippedScript.MoveSelectionTime(-chapter.startTime, 0.f);
 
@@ -198,6 +198,12 @@ bool OFS_Preferences::ShowPreferenceWindow() noexcept
 					if (ImGui::Checkbox(TR(SHOW_METADATA_DIALOG_ON_NEW_PROJECT), &state.showMetaOnNew)) {
 						save = true;
 					}
+					ImGui::Separator();
+					if (ImGui::InputInt(TR(UNDO_MEMORY_BUDGET), &state.undoMemoryBudgetMB, 16, 128)) {
+						save = true;
+						state.undoMemoryBudgetMB = Util::Clamp<int32_t>(state.undoMemoryBudgetMB, 16, 16384);
+					}
+					OFS::Tooltip(TR(UNDO_MEMORY_BUDGET_TOOLTIP));
 					ImGui::EndTabItem();
 				}
 				ImGui::EndTabBar();
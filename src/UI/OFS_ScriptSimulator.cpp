@@ -336,7 +336,7 @@ void ScriptSimulator::ShowSimulator(bool* open, std::shared_ptr<Funscript>& acti
         }
         auto nextAction = activeScript->GetNextActionAhead(currentTime);
         if (previousAction != nullptr && nextAction == previousAction) {
-            nextAction = activeScript->GetNextActionAhead(previousAction->atS);
+            nextAction = activeScript->GetNextActionAheadMs(previousAction->at);
         }
 
         if (previousAction != nullptr) {
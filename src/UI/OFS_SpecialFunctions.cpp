@@ -5,6 +5,7 @@
 
 #include "ui/OFS_ImGui.h"
 #include "Funscript/FunscriptUndoSystem.h"
+#include "Funscript/FunscriptProcessing.h"
 
 #include <imgui.h>
 #include <misc/cpp/imgui_stdlib.h>
@@ -107,7 +108,7 @@ void FunctionRangeExtender::SelectionChanged(const FunscriptSelectionChangedEven
 {
     OFS_PROFILE(__FUNCTION__);
     auto app = OpenFunscripter::ptr;
-    if (!app->ActiveFunscript()->Selection().empty()) {
+    if (app->ActiveFunscript()->HasSelection()) {
         rangeExtend = 0;
         createUndoState = true;
     }
@@ -121,11 +122,8 @@ void FunctionRangeExtender::DrawUI() noexcept
         if (ImGui::SliderInt(TR(RANGE), &rangeExtend, -50, 100)) {
             rangeExtend = Util::Clamp<int32_t>(rangeExtend, -50, 100);
             if (createUndoState || 
-                !undoSystem->MatchUndoTop(StateType::RANGE_EXTEND)) {
-                app->undoSystem->Snapshot(StateType::RANGE_EXTEND, app->ActiveFunscript());
-            }
-            else {
-                app->Undo();
+                !undoSystem->MatchUndoTop(StateType::RANGE_EXTEND) ||
+                !app->undoSystem->Amend(StateType::RANGE_EXTEND)) {
                 app->undoSystem->Snapshot(StateType::RANGE_EXTEND, app->ActiveFunscript());
             }
             createUndoState = false;
@@ -154,90 +152,12 @@ void RamerDouglasPeucker::SelectionChanged(const FunscriptSelectionChangedEvent*
 {
     OFS_PROFILE(__FUNCTION__);
     auto app = OpenFunscripter::ptr;
-    if (!app->ActiveFunscript()->Selection().empty()) {
+    if (app->ActiveFunscript()->HasSelection()) {
         epsilon = 0.f;
         createUndoState = true;
     }
 }
 
-inline static float PointLineDistance(FunscriptAction pt, FunscriptAction lineStart, FunscriptAction lineEnd) noexcept {
-    float dx = lineEnd.atS - lineStart.atS;
-    float dy = lineEnd.pos - lineStart.pos;
-
-    // Normalize
-    float mag = std::sqrtf(dx * dx + dy * dy);
-    if (mag > 0.0f) {
-        dx /= mag;
-        dy /= mag;
-    }
-    float pvx = pt.atS - lineStart.atS;
-    float pvy = pt.pos - lineStart.pos;
-
-    // Get dot product (project pv onto normalized direction)
-    float pvdot = dx * pvx + dy * pvy;
-
-    // Scale line direction vector and subtract it from pv
-    float ax = pvx - pvdot * dx;
-    float ay = pvy - pvdot * dy;
-
-    return std::sqrtf(ax * ax + ay * ay);
-}
-
-static std::vector<bool> DouglasPeucker(const FunscriptArray& points, int startIndex, int lastIndex, float epsilon) noexcept {
-    OFS_PROFILE(__FUNCTION__);
-    std::vector<std::pair<int, int>> stk;
-    stk.push_back(std::make_pair(startIndex, lastIndex));
-    
-    int globalStartIndex = startIndex;
-    auto bitArray = std::vector<bool>();
-    bitArray.resize(lastIndex - startIndex + 1, true);
-
-    while (!stk.empty()) {
-        startIndex = stk.back().first;
-        lastIndex = stk.back().second;
-        stk.pop_back();
-
-        float dmax = 0.f;
-        int index = startIndex;
-
-        for (int i = index + 1; i < lastIndex; ++i) {
-            if (bitArray[i - globalStartIndex]) {
-                float d = PointLineDistance(points[i], points[startIndex], points[lastIndex]);
-
-                if (d > dmax) {
-                    index = i;
-                    dmax = d;
-                }
-            }
-        }
-
-        if (dmax > epsilon) {
-            stk.push_back(std::make_pair(startIndex, index));
-            stk.push_back(std::make_pair(index, lastIndex));
-        }
-        else {
-            for (int i = startIndex + 1; i < lastIndex; ++i) {
-                bitArray[i - globalStartIndex] = false;
-            }
-        }
-    }
-
-    return bitArray;
-}
-
-static void DouglasPeucker(const FunscriptArray& points, float epsilon, FunscriptArray& newActions) noexcept {
-    OFS_PROFILE(__FUNCTION__);
-    auto bitArray = DouglasPeucker(points, 0, points.size() - 1, epsilon);
-    newActions.reserve(points.size());
-
-    for (int i = 0, n = points.size(); i < n; ++i) {
-        if (bitArray[i]) {
-            // we can safely assume points to be sorted
-            newActions.emplace_back_unsorted(points[i]);
-        }
-    }
-}
-
 void RamerDouglasPeucker::DrawUI() noexcept
 {
     OFS_PROFILE(__FUNCTION__);
@@ -247,32 +167,19 @@ void RamerDouglasPeucker::DrawUI() noexcept
             epsilon = std::max(epsilon, 0.f);
             if (createUndoState ||
                 !app->ActiveFunscript()->undoSystem->MatchUndoTop(StateType::SIMPLIFY)) {
-                // calculate average distance in selection
-                int count = 0;
-                for (int i = 0, size = ctx().Selection().size(); i < size - 1; ++i) {
-                    auto action1 = ctx().Selection()[i];
-                    auto action2 = ctx().Selection()[i + 1];
-                    
-                    float dx = action1.atS - action2.atS;
-                    float dy = action1.pos - action2.pos;
-                    float distance = sqrtf((dx * dx) + (dy * dy));
-                    averageDistance += distance;
-                    ++count;
-                }
-                averageDistance /= (float)count;
+                averageDistance = OFS::funscript::averageDistance(ctx().SelectedActions());
+                app->undoSystem->Snapshot(StateType::SIMPLIFY, app->ActiveFunscript());
             }
-            else {
-                app->undoSystem->Undo();
+            else if (!app->undoSystem->Amend(StateType::SIMPLIFY)) {
+                app->undoSystem->Snapshot(StateType::SIMPLIFY, app->ActiveFunscript());
             }
-            app->undoSystem->Snapshot(StateType::SIMPLIFY, app->ActiveFunscript());
 
             createUndoState = false;
-            auto selection = ctx().Selection();
+            auto selection = ctx().SelectedActions();
             ctx().RemoveSelectedActions();
             FunscriptArray newActions;
-            newActions.reserve(selection.size());
             float scaledEpsilon = epsilon * averageDistance;
-            DouglasPeucker(selection, scaledEpsilon, newActions);
+            OFS::funscript::simplify(selection, scaledEpsilon, newActions);
             ctx().AddMultipleActions(newActions);
         }
     }
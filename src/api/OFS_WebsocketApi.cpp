@@ -238,7 +238,7 @@ OFS_WebsocketApi::OFS_WebsocketApi() noexcept
 				auto app = OpenFunscripter::ptr;
 				auto& projectState = app->LoadedProject->State();
 				eventSerializationCtx->Push<WsFunscriptRemove>(ev->oldName);
-				eventSerializationCtx->Push<WsFunscriptChange>(ev->Script->Title(), ev->Script->Data(), projectState.metadata);
+				eventSerializationCtx->Push<WsFunscriptChange>(ev->Script->Title(), ev->Script->TakeSnapshot(), projectState.metadata);
 			}
 		}
 	));
@@ -384,7 +384,7 @@ void OFS_WebsocketApi::Update() noexcept
 			{
 				auto& projectState = app->LoadedProject->State();
 				auto& script = app->LoadedFunscripts()[i];
-				eventSerializationCtx->Push<WsFunscriptChange>(script->Title(), script->Data(), projectState.metadata);
+				eventSerializationCtx->Push<WsFunscriptChange>(script->Title(), script->TakeSnapshot(), projectState.metadata);
 				LOGF_DEBUG("[WsFunscriptChange]: ScriptIdx: %d", i);
 			}
 			cd = 0;
@@ -93,7 +93,7 @@ void OFS_WebsocketClient::UpdateAll() noexcept
     auto& projectState = app->LoadedProject->State();
     for(auto& script : app->LoadedFunscripts())
     {
-        serializeSend(std::move(WsFunscriptChange(script->Title(), script->Data(), projectState.metadata)));
+        serializeSend(std::move(WsFunscriptChange(script->Title(), script->TakeSnapshot(), projectState.metadata)));
     }
 }
 
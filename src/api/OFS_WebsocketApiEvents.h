@@ -75,10 +75,10 @@ class WsFunscriptChange : public OFS_Event<WsFunscriptChange>, public ToJsonInte
 {
     public:
     std::string name;
-    Funscript::FunscriptData funscriptData;
+    Funscript::FunscriptSnapshot funscriptData;
     Funscript::Metadata funscriptMetadata;
 
-    WsFunscriptChange(const std::string& name, Funscript::FunscriptData funscriptData, Funscript::Metadata metadata) noexcept
+    WsFunscriptChange(const std::string& name, Funscript::FunscriptSnapshot funscriptData, Funscript::Metadata metadata) noexcept
         : name(name), funscriptData(std::move(funscriptData)), funscriptMetadata(std::move(metadata)) {}
 
     //void Serialize(nlohmann::json& json) noexcept override { to_json(json, *this); }
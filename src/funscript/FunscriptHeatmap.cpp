@@ -14,8 +14,6 @@
 ImGradient FunscriptHeatmap::Colors;
 ImGradient FunscriptHeatmap::LineColors;
 
-static constexpr auto SpeedTextureResolution = 2048;
-
 class HeatmapShader : public ShaderBase
 {
 private:
@@ -139,6 +137,7 @@ void FunscriptHeatmap::Init() noexcept
 }
 
 FunscriptHeatmap::FunscriptHeatmap() noexcept
+    : textureSpeeds(SpeedTextureResolution, 0.f), speeds(SpeedTextureResolution, MaxSpeedPerSecond)
 {
     glGenTextures(1, &speedTexture);
     glBindTexture(GL_TEXTURE_2D, speedTexture);
@@ -150,56 +149,41 @@ FunscriptHeatmap::FunscriptHeatmap() noexcept
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void FunscriptHeatmap::updateTextureSpeeds(OFS::funscript::SpeedProfile::SampleRange range) noexcept
+{
+    auto level = speeds.LevelForResolution(SpeedTextureResolution);
+    auto means = speeds.Means(level);
+    auto [first, last] = speeds.LevelRange(level, range);
+    for (auto i = first; i < last && i < textureSpeeds.size(); i += 1) {
+        textureSpeeds[i] = Util::Clamp(means[i] / MaxSpeedPerSecond, 0.f, 1.f);
+    }
+}
+
 void FunscriptHeatmap::Update(float totalDuration, const FunscriptArray& actions) noexcept
 {
     OFS_PROFILE(__FUNCTION__);
-    std::vector<float> speedBuffer; 
-    speedBuffer.resize(SpeedTextureResolution, 0.f);
-    std::vector<uint16_t> sampleCountBuffer;
-    sampleCountBuffer.resize(SpeedTextureResolution, 0);
+    updateTextureSpeeds(speeds.Rebuild(totalDuration, actions));
 
-    float timeStep = totalDuration / SpeedTextureResolution;
+    glBindTexture(GL_TEXTURE_2D, speedTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, SpeedTextureResolution, 1, 0, GL_RED, GL_FLOAT, textureSpeeds.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    for(uint32_t i = 0, j = 1, size = actions.size(); j < size; i = j++)
-    {
-        auto prev = actions[i];
-        auto next = actions[j];
-
-        float strokeDuration = next.atS - prev.atS;
-        float speed = std::abs(prev.pos - next.pos) / strokeDuration;
-    
-        uint32_t prevSampleIdx = prev.atS / timeStep;
-        uint32_t nextSampleIdx = next.atS / timeStep;
-        if(prevSampleIdx == nextSampleIdx)
-        {
-            if(prevSampleIdx < SpeedTextureResolution)
-            {
-                sampleCountBuffer[prevSampleIdx] += 1;
-                speedBuffer[prevSampleIdx] += speed;
-            }
-        }
-        else
-        {
-            if(prevSampleIdx < SpeedTextureResolution && nextSampleIdx < SpeedTextureResolution)
-            {
-                for(int x = prevSampleIdx; x < nextSampleIdx; x += 1)
-                {
-                    sampleCountBuffer[x] += 1;
-                    speedBuffer[x] += speed;
-                }
-            }
-        }
+void FunscriptHeatmap::UpdateRange(float totalDuration, const FunscriptArray& actions, uint32_t fromMs, uint32_t toMs) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (speeds.TotalDuration() != totalDuration) {
+        Update(totalDuration, actions);
+        return;
     }
 
-    for(uint32_t i=0; i < SpeedTextureResolution; i += 1)
-    {
-        speedBuffer[i] /= sampleCountBuffer[i] > 0 ? (float)sampleCountBuffer[i] : 1.f;
-        speedBuffer[i] /= MaxSpeedPerSecond;
-        speedBuffer[i] = Util::Clamp(speedBuffer[i], 0.f, 1.f);
-    }
+    auto range = speeds.Update(actions, fromMs, toMs);
+    updateTextureSpeeds(range);
+    auto [first, last] = speeds.LevelRange(speeds.LevelForResolution(SpeedTextureResolution), range);
+    if (first >= last) return;
 
     glBindTexture(GL_TEXTURE_2D, speedTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, SpeedTextureResolution, 1, 0, GL_RED, GL_FLOAT, speedBuffer.data());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, first, 0, last - first, 1, GL_RED, GL_FLOAT, textureSpeeds.data() + first);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
@@ -233,79 +217,13 @@ void FunscriptHeatmap::DrawHeatmap(ImDrawList* drawList, const ImVec2& min, cons
     drawList->AddCallback(ImDrawCallback_ResetRenderState, 0);
 }
 
-#include <backends/imgui_impl_opengl3.h>
-
 std::vector<uint8_t> FunscriptHeatmap::RenderToBitmap(int16_t width, int16_t height) noexcept
 {
-    width = Util::Min(width, FunscriptHeatmap::MaxResolution);
-    height = Util::Min(height, FunscriptHeatmap::MaxResolution);
-
-    // Prepare temporary framebuffer
-    uint32_t tmpFramebuffer = 0;
-    uint32_t tmpColorTex = 0;
-
-    glGenFramebuffers(1, &tmpFramebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, tmpFramebuffer);
-
-    glGenTextures(1, &tmpColorTex);
-    glBindTexture(GL_TEXTURE_2D, tmpColorTex);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, OFS_InternalTexFormat, width, height, 0, OFS_TexFormat, GL_UNSIGNED_BYTE, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tmpColorTex, 0);
-    GLenum DrawBuffers[1] = { GL_COLOR_ATTACHMENT0 };
-    glDrawBuffers(1, DrawBuffers);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        // FIXME: leaking memory
-        return {};
-    }
-
-    // Backup out main ImGuiContext
-    auto prevContext = ImGui::GetCurrentContext();
-
-    // Create a temporary ImGuiContext
-    auto tmpContext = ImGui::CreateContext();
-    ImGui::SetCurrentContext(tmpContext);
-    ImGui_ImplOpenGL3_Init(OFS_SHADER_VERSION);
-
-    // Prepare drawing a single image
-    auto& io = ImGui::GetIO();
-    io.DisplaySize.x = width;
-    io.DisplaySize.y = height;
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui::NewFrame();
-
-    // Draw calls
-    {
-        auto drawList = ImGui::GetForegroundDrawList(ImGui::GetMainViewport());
-        DrawHeatmap(drawList, ImVec2(0.f, 0.f), ImVec2(width, height));
-    }
-
-    // Render image
-    ImGui::Render();
-    OFS_ImGui::CurrentlyRenderedViewport = ImGui::GetMainViewport();
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    OFS_ImGui::CurrentlyRenderedViewport = nullptr;
-
+    OFS_PROFILE(__FUNCTION__);
+    width = Util::Clamp<int16_t>(width, 0, FunscriptHeatmap::MaxResolution);
+    height = Util::Clamp<int16_t>(height, 0, FunscriptHeatmap::MaxResolution);
 
-    // Grab the bitmap
     std::vector<uint8_t> bitmap;
-    bitmap.resize((size_t)width * (size_t)height * 4);
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, bitmap.data());
-
-    // Destroy everything
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui::DestroyContext(tmpContext);
-
-    glDeleteTextures(1, &tmpColorTex);
-    glDeleteFramebuffers(1, &tmpFramebuffer);
-
-    // Reset to default framebuffer and main ImGuiContext    
-    ImGui::SetCurrentContext(prevContext);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    OFS::funscript::renderHeatmap(textureSpeeds, width, height, bitmap);
     return bitmap;
-}
\ No newline at end of file
+}
@@ -1,11 +1,14 @@
 #pragma once
 #include "ui/GradientBar.h"
 #include "funscript/Funscript.h"
+#include "Funscript/FunscriptHeatmapRender.h"
+#include "Funscript/FunscriptSpeedPyramid.h"
 
 class FunscriptHeatmap
 {
 public:
-	static constexpr float MaxSpeedPerSecond = 400.f;
+	static constexpr uint32_t SpeedTextureResolution = OFS::funscript::HeatmapSpeedResolution;
+	static constexpr float MaxSpeedPerSecond = OFS::funscript::HeatmapMaxSpeedPerSecond;
 	static constexpr int16_t MaxResolution = 4096;
 
 	static ImGradient LineColors;
@@ -13,12 +16,23 @@ public:
 
 	static void Init() noexcept;
 
+private:
+	// CPU copy of the speed texture so bitmaps can be rendered without GL
+	std::vector<float> textureSpeeds;
+
+	void updateTextureSpeeds(OFS::funscript::SpeedProfile::SampleRange range) noexcept;
+public:
 	uint32_t speedTexture = 0;
+	// the texture is read from the level with SpeedTextureResolution samples, zoomed views use the finer levels
+	OFS::funscript::SpeedPyramid speeds;
 
 	FunscriptHeatmap() noexcept;
 
 	void DrawHeatmap(ImDrawList* drawList, const ImVec2& min, const ImVec2& max) noexcept;
 	void Update(float totalDuration , const FunscriptArray& actions) noexcept;
+	// only recomputes and uploads the part of the texture affected by a change in [fromMs, toMs]
+	void UpdateRange(float totalDuration, const FunscriptArray& actions, uint32_t fromMs, uint32_t toMs) noexcept;
 
+	// RGBA rows ordered top to bottom
 	std::vector<uint8_t> RenderToBitmap(int16_t width, int16_t height) noexcept;
 };
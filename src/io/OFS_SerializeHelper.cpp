@@ -48,6 +48,28 @@ struct glz::detail::to<glz::JSON, std::filesystem::path>
 		write<JSON>::op<Opts>(str, args...);
 	}
 };
+template <>
+struct glz::detail::from<glz::BEVE, std::filesystem::path>
+{
+	template <auto Opts>
+	static void op(std::filesystem::path& value, auto&& ... args)
+	{
+		std::string str{};
+		read<BEVE>::op<Opts>(str, args...);
+		value = OFS::util::pathFromU8String(str);
+	}
+};
+template <>
+struct glz::detail::to<glz::BEVE, std::filesystem::path>
+{
+	template <auto Opts>
+	static void op(std::filesystem::path& value, auto&& ... args)
+	{
+		auto u8 = value.u8string();
+		auto str = std::string(u8.begin(), u8.end());
+		write<BEVE>::op<Opts>(str, args...);
+	}
+};
 
 
 template<>
@@ -90,6 +112,26 @@ struct glz::meta<::ProjectState>
 		, &ProjectState::lastPlayerPosition
 		, &ProjectState::activeScriptIdx
 		, &ProjectState::nudgeMetadata
+		, &ProjectState::journalId
+	);
+};
+
+namespace
+{
+	// The binary form has no older versions to stay compatible with, so the funscript data is a plain field.
+	struct BinaryProjectState
+	{
+		::ProjectState State;
+		std::vector<std::uint8_t> BinaryFunscriptData;
+	};
+}
+
+template <>
+struct glz::meta<BinaryProjectState>
+{
+	static constexpr auto value = glz::object(
+		&BinaryProjectState::State
+		, &BinaryProjectState::BinaryFunscriptData
 	);
 };
 
@@ -102,6 +144,22 @@ struct glz::meta<WaveformState>
 	);
 };
 
+template <>
+void OFS::serializeState<::ProjectState>(std::any& state, std::string& json)
+{
+	auto* value = std::any_cast<::ProjectState>(std::addressof(state));
+	if (nullptr == value) [[unlikely]]
+	{
+		FUN_ASSERT(false, "State serialization failed. Type mismatch.");
+		return;
+	}
+
+	// binaryFunscriptData isn't part of the meta because reading has to accept the older object form
+	auto const fields = glz::merge{ *value, glz::obj{ "binaryFunscriptData", value->binaryFunscriptData } };
+	if (auto const err = glz::write_json(glz::obj{ "State", fields }, json); err) [[unlikely]]
+		FUN_ASSERT(false, err.custom_error_message);
+}
+
 template <>
 void OFS::deserializeState<::ProjectState>(std::any& state, std::string& json)
 {
@@ -189,3 +247,45 @@ void OFS::deserializeState<WaveformState>(std::any& state, std::string& json)
 		}
 	}
 }
+
+template <>
+void OFS::serializeStateBinary<::ProjectState>(std::any& state, std::string& bin)
+{
+	auto* value = std::any_cast<::ProjectState>(std::addressof(state));
+	if (nullptr == value) [[unlikely]]
+	{
+		FUN_ASSERT(false, "State serialization failed. Type mismatch.");
+		return;
+	}
+
+	// moved in and out again to not copy the funscript data
+	BinaryProjectState binaryState{ std::move(*value), {} };
+	binaryState.BinaryFunscriptData = std::move(binaryState.State.binaryFunscriptData);
+	auto const err = glz::write_beve(binaryState, bin);
+	*value = std::move(binaryState.State);
+	value->binaryFunscriptData = std::move(binaryState.BinaryFunscriptData);
+
+	if (err) [[unlikely]]
+		FUN_ASSERT(false, err.custom_error_message);
+}
+
+template <>
+void OFS::deserializeStateBinary<::ProjectState>(std::any& state, std::string& bin)
+{
+	if (nullptr == std::any_cast<::ProjectState>(std::addressof(state))) [[unlikely]]
+	{
+		FUN_ASSERT(false, "State serialization failed. deserialize function state type mismatch.");
+		state.emplace<::ProjectState>();
+		return;
+	}
+
+	auto& value = state.emplace<::ProjectState>();
+	BinaryProjectState binaryState{};
+	if (auto const err = glz::read<glz::opts{ .format = glz::BEVE, .error_on_unknown_keys = false }>(binaryState, bin); err) [[unlikely]]
+	{
+		FUN_ASSERT(false, "State deserialization failed.");
+		return;
+	}
+	value = std::move(binaryState.State);
+	value.binaryFunscriptData = std::move(binaryState.BinaryFunscriptData);
+}
@@ -21,37 +21,56 @@ struct OFS_KeybindingState;
 #else
 #define OFS_SERIALIZATION_EXTERN extern
 
+OFS_SERIALIZATION_EXTERN template void OFS::serializeState<::ProjectState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<::ProjectState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<::ProjectState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<::ProjectState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<WaveformState>(std::any& state, std::string& json);
 #endif
 
-OFS_SERIALIZATION_EXTERN template void OFS::serializeState<::ProjectState>(std::any& state, std::string& json);
-
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<WaveformState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<WaveformState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<WaveformState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<OpenFunscripterState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<OpenFunscripterState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<OpenFunscripterState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<OpenFunscripterState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<BaseOverlayState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<BaseOverlayState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<BaseOverlayState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<BaseOverlayState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<ChapterState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<ChapterState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<ChapterState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<ChapterState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<SimulatorState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<SimulatorState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<SimulatorState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<SimulatorState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<SimulatorDefaultConfigState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<SimulatorDefaultConfigState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<SimulatorDefaultConfigState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<SimulatorDefaultConfigState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<VideoPlayerWindowState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<VideoPlayerWindowState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<VideoPlayerWindowState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<VideoPlayerWindowState>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<OFS_ActionTrigger>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<OFS_ActionTrigger>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<OFS_ActionTrigger>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<OFS_ActionTrigger>(std::any& state, std::string& bin);
 
 OFS_SERIALIZATION_EXTERN template void OFS::serializeState<OFS_KeybindingState>(std::any& state, std::string& json);
 OFS_SERIALIZATION_EXTERN template void OFS::deserializeState<OFS_KeybindingState>(std::any& state, std::string& json);
+OFS_SERIALIZATION_EXTERN template void OFS::serializeStateBinary<OFS_KeybindingState>(std::any& state, std::string& bin);
+OFS_SERIALIZATION_EXTERN template void OFS::deserializeStateBinary<OFS_KeybindingState>(std::any& state, std::string& bin);
 
 #undef OFS_SERIALIZATION_EXTERN
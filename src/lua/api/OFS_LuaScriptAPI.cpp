@@ -84,29 +84,36 @@ LuaFunscript::LuaFunscript(const FunscriptArray& actions) noexcept
     }
 }
 
-void LuaFunscript::Commit(/*sol::this_state L*/) noexcept
-{
-    //FUN_ASSERT(OFS::util::isMainThread(), "Not in main thread.");
-    //auto app = OpenFunscripter::ptr;
-    //auto ref = script.lock();
-    //if(ref) {
-    //    FunscriptArray commit;
-    //    FunscriptArray selection;
-    //    commit.reserve(actions.size());
-    //    for(auto action : actions) {
-    //        auto succ = commit.emplace(action.o);
-    //        if(!succ) {
-    //            luaL_error(L.lua_state(), "Tried adding multiple actions with the same timestamp.");
-    //            return;
-    //        }
-    //        if(action.selected) {
-    //            selection.emplace(action.o);
-    //        }
-    //    }
-    //    app->undoSystem->Snapshot(StateType::CUSTOM_LUA, script);
-    //    ref->SetActions(commit);
-    //    ref->SetSelection(selection);
-    //}
+bool LuaFunscript::Commit(/*sol::this_state L*/) noexcept
+{
+    FUN_ASSERT(OFS::util::isMainThread(), "Not in main thread.");
+    auto app = OpenFunscripter::ptr;
+    auto ref = script.lock();
+    if(ref) {
+        std::vector<uint32_t> times;
+        times.reserve(actions.size());
+        for(auto action : actions) {
+            times.emplace_back(action.o.at);
+        }
+        if(!std::is_sorted(times.begin(), times.end())) {
+            std::sort(times.begin(), times.end());
+        }
+        if(std::adjacent_find(times.begin(), times.end()) != times.end()) {
+            LOG_ERROR("Tried adding multiple actions with the same timestamp.");
+            return false;
+        }
+
+        app->undoSystem->Snapshot(StateType::CUSTOM_LUA, script);
+        Funscript::EditBatch batch(*ref);
+        batch.Reserve(actions.size(), 0);
+        batch.RemoveAll();
+        batch.ClearSelection();
+        for(auto action : actions) {
+            batch.Add(action.o, action.selected);
+        }
+        return batch.Commit() == 0;
+    }
+    return false;
 }
 
 std::filesystem::path LuaFunscript::Path() const noexcept
@@ -142,20 +149,20 @@ bool LuaFunscript::HasSelection() const noexcept
 
 std::optional<std::tuple<LuaFunscriptAction, lua_Integer>> LuaFunscript::ClosestAction(lua_Number time) noexcept
 {
-    float closestDelta = std::numeric_limits<float>::max();
+    double closestDelta = std::numeric_limits<double>::max();
     int closestIdx = -1;
     LuaFunscriptAction closestAction(FunscriptAction(0, 0), false);
 
     for(uint32_t i=0, size=actions.size(); i < size; i += 1) {
         auto a = actions[i];
-        float delta = std::abs(a.at() - time);
+        double delta = std::abs(a.at() - time);
         if(delta < closestDelta) {
             closestDelta = delta;
             closestIdx = i;
             closestAction = a;
         }
     }
-    if(closestDelta != std::numeric_limits<float>::max()) {
+    if(closestDelta != std::numeric_limits<double>::max()) {
         return std::make_optional(std::make_tuple(closestAction, closestIdx + 1));
     }
     return std::optional<std::tuple<LuaFunscriptAction, lua_Integer>>();
@@ -163,21 +170,21 @@ std::optional<std::tuple<LuaFunscriptAction, lua_Integer>> LuaFunscript::Closest
 
 std::optional<std::tuple<LuaFunscriptAction, lua_Integer>> LuaFunscript::ClosestActionAfter(lua_Number time) noexcept
 {
-    float closestDelta = std::numeric_limits<float>::max();
+    double closestDelta = std::numeric_limits<double>::max();
     int closestIdx = -1;
     LuaFunscriptAction closestAction(FunscriptAction(0, 0), false);
 
     for(uint32_t i=0, size=actions.size(); i < size; i += 1) {
         auto a = actions[i];
         if(a.at() < time) continue;
-        float delta = std::abs(a.at() - time);
+        double delta = std::abs(a.at() - time);
         if(delta < closestDelta && delta != 0.f) {
             closestDelta = delta;
             closestIdx = i;
             closestAction = a;
         }
     }
-    if(closestDelta != std::numeric_limits<float>::max()) {
+    if(closestDelta != std::numeric_limits<double>::max()) {
         return std::make_optional(std::make_tuple(closestAction, closestIdx + 1));
     }
     return std::optional<std::tuple<LuaFunscriptAction, lua_Integer>>();
@@ -185,21 +192,21 @@ std::optional<std::tuple<LuaFunscriptAction, lua_Integer>> LuaFunscript::Closest
 
 std::optional<std::tuple<LuaFunscriptAction, lua_Integer>> LuaFunscript::ClosestActionBefore(lua_Number time) noexcept
 {
-    float closestDelta = std::numeric_limits<float>::max();
+    double closestDelta = std::numeric_limits<double>::max();
     int closestIdx = -1;
     LuaFunscriptAction closestAction(FunscriptAction(0, 0), false);
 
     for(uint32_t i=0, size=actions.size(); i < size; i += 1) {
         auto a = actions[i];
         if(a.at() > time) continue;
-        float delta = std::abs(a.at() - time);
+        double delta = std::abs(a.at() - time);
         if(delta < closestDelta && delta != 0.f) {
             closestDelta = delta;
             closestIdx = i;
             closestAction = a;
         }
     }
-    if(closestDelta != std::numeric_limits<float>::max()) {
+    if(closestDelta != std::numeric_limits<double>::max()) {
         return std::make_optional(std::make_tuple(closestAction, closestIdx + 1));
     }
     return std::optional<std::tuple<LuaFunscriptAction, lua_Integer>>();
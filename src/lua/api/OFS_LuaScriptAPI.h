@@ -23,7 +23,7 @@ struct LuaFunscriptAction
     {}
     LuaFunscriptAction(lua_Number at, lua_Integer pos) noexcept
     {
-        o.atS = std::max(0.0, at);
+        o.setAtS(std::max(0.0, at));
         o.pos = Util::Clamp<lua_Integer>(pos, 0, 100);
     }
     LuaFunscriptAction(lua_Number at, lua_Integer pos, bool selected) 
@@ -34,12 +34,12 @@ struct LuaFunscriptAction
 
     inline lua_Number at() noexcept
     {
-        return o.atS;
+        return o.atS();
     }
 
     inline void set_at(lua_Number at) noexcept
     {
-        o.atS = std::max(0.0, at);
+        o.setAtS(std::max(0.0, at));
     }
 
     inline lua_Integer pos() noexcept
@@ -75,8 +75,8 @@ public:
             if(ref) {
                 auto size = ref->Actions().size();
                 actions.reserve(size);
-                for(auto action : ref->Actions()) {
-                    actions.emplace_back(action, ref->IsSelected(action));
+                for(uint32_t i=0; i < size; i += 1) {
+                    actions.emplace_back(ref->Actions()[i], ref->IsSelectedAt(i));
                 }
             }
         }
@@ -90,11 +90,13 @@ public:
         {
             std::stable_sort(actions.begin(), actions.end(),
                 [](auto a1, auto a2) {
-                    return a1.o.atS < a2.o.atS;
+                    return a1.o.at < a2.o.at;
                 });
         }
 
-        void Commit(/*sol::this_state L*/) noexcept;
+        // Returns false without raising a lua error when the script is gone or two actions share a timestamp,
+        // nothing is committed in that case and scripts have to check the result.
+        bool Commit(/*sol::this_state L*/) noexcept;
         bool HasSelection() const noexcept;
         std::vector<lua_Integer> SelectedIndices() const noexcept;
 
@@ -27,6 +27,8 @@ struct PreferenceState
 	bool forceHwDecoding = false;
 	bool showMetaOnNew = true;
 
+	int32_t undoMemoryBudgetMB = 256;
+
 	static inline PreferenceState& State(OFS::StateHandle stateHandle) noexcept {
 		return OFS::AppState<PreferenceState>(stateHandle).get();
 	}
@@ -42,4 +44,5 @@ struct PreferenceState
 //	REFL_FIELD(framerateLimit)
 //	REFL_FIELD(forceHwDecoding)
 //	REFL_FIELD(showMetaOnNew)
+//	REFL_FIELD(undoMemoryBudgetMB)
 //REFL_END
@@ -37,6 +37,8 @@ struct ProjectState
     float lastPlayerPosition = 0.f;
     uint32_t activeScriptIdx = 0;
     bool nudgeMetadata = true;
+    // identifies the edit journal started on top of this save
+    uint64_t journalId = 0;
 
     std::vector<uint8_t> binaryFunscriptData;
 
@@ -53,6 +55,7 @@ struct ProjectState
 //    REFL_FIELD(lastPlayerPosition)
 //    REFL_FIELD(activeScriptIdx)
 //    REFL_FIELD(nudgeMetadata)
+//    REFL_FIELD(journalId)
 //    REFL_FIELD(binaryFunscriptData)
 //REFL_END
 
@@ -13,6 +13,7 @@ struct BaseOverlayState
     bool ShowMaxSpeedHighlight = false;
     bool SyncLineEnable = false;
     bool SplineMode = false;
+    bool ShowSpeedStrip = false;
 
     inline static OFS::StateHandle RegisterStatic() noexcept
     {
@@ -31,4 +32,5 @@ struct BaseOverlayState
 //    REFL_FIELD(ShowMaxSpeedHighlight)
 //    REFL_FIELD(SyncLineEnable)
 //    REFL_FIELD(SplineMode)
+//    REFL_FIELD(ShowSpeedStrip)
 //REFL_END
@@ -228,7 +228,8 @@ void ScriptTimeline::ShowScriptPositions(
 	const OFS::VideoPlayer* player,
 	BaseOverlay* overlay,
 	const std::vector<std::shared_ptr<Funscript>>& scripts,
-	int activeScriptIdx) noexcept
+	int activeScriptIdx,
+	const OFS::funscript::SpeedPyramid* activeSpeeds) noexcept
 {
 	OFS_PROFILE(__FUNCTION__);
 
@@ -239,6 +240,7 @@ void ScriptTimeline::ShowScriptPositions(
 	drawingCtx.visibleTime = visibleTime;
 	drawingCtx.totalDuration = player->Duration();
 	drawingCtx.scripts = &scripts;
+	drawingCtx.activeSpeeds = activeSpeeds;
 	drawingCtx.hoveredScriptIdx = -1;
 	
 	if (drawingCtx.totalDuration == 0.f) return;
@@ -307,37 +309,18 @@ void ScriptTimeline::ShowScriptPositions(
 			);
 		}
 
-		auto startIt = script->Actions().lower_bound(FunscriptAction(drawingCtx.offsetTime, 0));
-		if (startIt != script->Actions().begin()) {
-		    startIt -= 1;
+		auto startIdx = script->LowerBoundIndex(FunscriptAction::ToMs(drawingCtx.offsetTime));
+		if (startIdx != 0) {
+		    startIdx -= 1;
 		}
 
-		auto endIt = script->Actions().lower_bound(FunscriptAction(drawingCtx.offsetTime + visibleTime, 0));
-		if (endIt != script->Actions().end()) {
-		    endIt += 1;
+		auto endIdx = script->LowerBoundIndex(FunscriptAction::ToMs(drawingCtx.offsetTime + visibleTime));
+		if (endIdx != script->Actions().size()) {
+		    endIdx += 1;
 		}
 
-		drawingCtx.actionFromIdx = std::distance(script->Actions().begin(), startIt);
-		drawingCtx.actionToIdx = std::distance(script->Actions().begin(), endIt);
-
-		if(script->HasSelection())
-		{
-			auto startIt = script->Selection().lower_bound(FunscriptAction(drawingCtx.offsetTime, 0));
-			if (startIt != script->Selection().begin())
-				startIt -= 1;
-
-			auto endIt = script->Selection().lower_bound(FunscriptAction(drawingCtx.offsetTime + drawingCtx.visibleTime, 0));
-			if (endIt != script->Selection().end())
-				endIt += 1;
-
-			drawingCtx.selectionFromIdx = std::distance(script->Selection().begin(), startIt);
-			drawingCtx.selectionToIdx = std::distance(script->Selection().begin(), endIt);
-		}
-		else 
-		{
-			drawingCtx.selectionFromIdx = 0;
-			drawingCtx.selectionToIdx = 0;
-		}
+		drawingCtx.actionFromIdx = startIdx;
+		drawingCtx.actionToIdx = endIdx;
 
 		// border
 		constexpr float borderThicknes = 1.f;
@@ -360,6 +343,9 @@ void ScriptTimeline::ShowScriptPositions(
 			OFS_PROFILE("overlay->DrawScriptPositionContent(drawingCtx)");
 			overlay->DrawScriptPositionContent(drawingCtx);
 		}
+		if (i == activeScriptIdx && BaseOverlayState::State(overlayStateHandle).ShowSpeedStrip) {
+			BaseOverlay::DrawSpeedStrip(drawingCtx);
+		}
 
 		// current position indicator -> |
 		drawingCtx.drawList->AddTriangleFilled(
@@ -457,6 +443,7 @@ void ScriptTimeline::ShowScriptPositions(
 				ImGui::MenuItem(TR(SPLINE_MODE), 0, &overlayState.SplineMode);
 				ImGui::MenuItem(TR(SHOW_VIDEO_POSITION), 0, &overlayState.SyncLineEnable);
 				OFS::Tooltip(TR(SHOW_VIDEO_POSITION_TOOLTIP));
+				ImGui::MenuItem(TR(SHOW_SPEED_STRIP), 0, &overlayState.ShowSpeedStrip);
 				ImGui::EndMenu();
 			}
 
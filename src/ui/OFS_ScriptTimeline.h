@@ -39,7 +39,8 @@ public:
 	inline void ClearAudioWaveform() noexcept { ShowAudioWaveform = false; Wave.data.Clear(); }
 	inline void setStartSelection(float time) noexcept { startSelectionTime = time; }
 	inline float selectionStart() const noexcept { return startSelectionTime; }
-	void ShowScriptPositions(const OFS::VideoPlayer* player, BaseOverlay* overlay, const std::vector<std::shared_ptr<Funscript>>& scripts, int activeScriptIdx) noexcept;
+	// activeSpeeds is the speed pyramid of the active script, drawn as a strip when enabled
+	void ShowScriptPositions(const OFS::VideoPlayer* player, BaseOverlay* overlay, const std::vector<std::shared_ptr<Funscript>>& scripts, int activeScriptIdx, const OFS::funscript::SpeedPyramid* activeSpeeds) noexcept;
 
 	void Update() noexcept;
 
@@ -48,6 +48,11 @@ public:
 		Heatmap->Update(totalDuration, actions);
 	}
 
+	inline void UpdateHeatmapRange(float totalDuration, const FunscriptArray& actions, uint32_t fromMs, uint32_t toMs) noexcept
+	{
+		Heatmap->UpdateRange(totalDuration, actions, fromMs, toMs);
+	}
+
 	void DrawTimeline() noexcept;
 	void DrawControls() noexcept;
 
@@ -69,7 +69,7 @@ inline static void getActionLineColor(
     FunscriptAction prevAction,
     const BaseOverlayState& overlay) noexcept
 {
-    float speed = std::abs(action.pos - prevAction.pos) / ((action.atS - prevAction.atS));
+    float speed = std::abs(action.pos - prevAction.pos) / ((action.atS() - prevAction.atS()));
     if(overlay.ShowMaxSpeedHighlight && speed >= overlay.MaxSpeedPerSecond) {
         *speedColor = overlay.MaxSpeedColor;
         return;
@@ -81,7 +81,7 @@ inline static void getActionLineColor(
 
 ImVec2 BaseOverlay::GetPointForAction(const OverlayDrawingCtx& ctx, FunscriptAction action) noexcept
 {
-    float relative_x = (float)(action.atS - ctx.offsetTime) / ctx.visibleTime;
+    float relative_x = (float)(action.atS() - ctx.offsetTime) / ctx.visibleTime;
     float x = (ctx.canvasSize.x) * relative_x;
     float y = (ctx.canvasSize.y) * (1 - (action.pos / 100.f));
     x += ctx.canvasPos.x;
@@ -113,28 +113,28 @@ void BaseOverlay::drawActionLinesSpline(const OverlayDrawingCtx& ctx, const Base
         float visibleDuration;
         float currentTime;
         float endTime;
-        if (startAction.atS >= ctx.offsetTime && endAction.atS <= (ctx.offsetTime + ctx.visibleTime)) {
-            currentTime = startAction.atS;
-            endTime = endAction.atS;
+        if (startAction.atS() >= ctx.offsetTime && endAction.atS() <= (ctx.offsetTime + ctx.visibleTime)) {
+            currentTime = startAction.atS();
+            endTime = endAction.atS();
             visibleDuration = endTime - currentTime;
         }
-        else if (startAction.atS < ctx.offsetTime && endAction.atS > (ctx.offsetTime + ctx.visibleTime)) {
+        else if (startAction.atS() < ctx.offsetTime && endAction.atS() > (ctx.offsetTime + ctx.visibleTime)) {
             // clip at the invisible area in both direction
             currentTime = ctx.offsetTime;
             endTime = (ctx.offsetTime + ctx.visibleTime);
             visibleDuration = ctx.visibleTime;
         }
-        else if (startAction.atS < ctx.offsetTime) {
+        else if (startAction.atS() < ctx.offsetTime) {
             // clip invisible area on the left
             currentTime = ctx.offsetTime;
-            endTime = endAction.atS;
-            visibleDuration = endAction.atS - ctx.offsetTime;
+            endTime = endAction.atS();
+            visibleDuration = endAction.atS() - ctx.offsetTime;
         }
-        else if (endAction.atS > (ctx.offsetTime + ctx.visibleTime)) {
+        else if (endAction.atS() > (ctx.offsetTime + ctx.visibleTime)) {
             // clip invisble area on the right
-            currentTime = startAction.atS;
+            currentTime = startAction.atS();
             endTime = (ctx.offsetTime + ctx.visibleTime) + 0.001f;
-            visibleDuration = endTime - startAction.atS;
+            visibleDuration = endTime - startAction.atS();
         }
 
         // detail gets dynamically reduced by increasing the timeStep,
@@ -161,7 +161,7 @@ void BaseOverlay::drawActionLinesSpline(const OverlayDrawingCtx& ctx, const Base
                 putPoint(ctx, currentTime);
                 currentTime += timeStep;
             }
-            putPoint(ctx, endAction.atS);
+            putPoint(ctx, endAction.atS());
             auto tmpSize = ctx.drawList->_Path.Size;
             ctx.drawList->PathStroke(IM_COL32_BLACK, false, 7.f);
             ctx.drawList->_Path.Size = tmpSize;
@@ -190,19 +190,18 @@ void BaseOverlay::drawActionLinesSpline(const OverlayDrawingCtx& ctx, const Base
 
     if(drawingScript->HasSelection())
     {
-        auto startIt = drawingScript->Selection().begin() + ctx.selectionFromIdx;
-        auto endIt = drawingScript->Selection().begin() + ctx.selectionToIdx;
         const FunscriptAction* prevAction = nullptr;
-        for (; startIt != endIt; ++startIt) {
-            auto&& action = *startIt;
+        drawingScript->Selection().forEachSet(ctx.actionFromIdx, ctx.actionToIdx,
+            [&](std::size_t idx) noexcept {
+                auto&& action = drawingScript->Actions()[idx];
 
-            if (prevAction != nullptr) {
-                // draw highlight line
-                drawSpline(ctx, *prevAction, action, SelectedLineColor, 3.f, false);
-            }
+                if (prevAction != nullptr) {
+                    // draw highlight line
+                    drawSpline(ctx, *prevAction, action, SelectedLineColor, 3.f, false);
+                }
 
-            prevAction = &action;
-        }
+                prevAction = &action;
+            });
     }
 }
 
@@ -239,27 +238,26 @@ void BaseOverlay::drawActionLinesLinear(const OverlayDrawingCtx& ctx, const Base
 
     if(drawingScript->HasSelection())
     {
-        auto startIt = drawingScript->Selection().begin() + ctx.selectionFromIdx;
-        auto endIt = drawingScript->Selection().begin() + ctx.selectionToIdx;
         const FunscriptAction* prevAction = nullptr;
-        for (; startIt != endIt; ++startIt) {
-            auto&& action = *startIt;
-            auto point = BaseOverlay::GetPointForAction(ctx, action);
-
-            if (prevAction != nullptr) {
-                // draw highlight line
-                ColoredLines.emplace_back(
-                    std::move(
-                        BaseOverlay::ColoredLine{ 
-                            BaseOverlay::GetPointForAction(ctx, *prevAction),
-                            point,
-                            SelectedLineColor
-                        })
-                );
-            }
-
-            prevAction = &action;
-        }
+        drawingScript->Selection().forEachSet(ctx.actionFromIdx, ctx.actionToIdx,
+            [&](std::size_t idx) noexcept {
+                auto&& action = drawingScript->Actions()[idx];
+                auto point = BaseOverlay::GetPointForAction(ctx, action);
+
+                if (prevAction != nullptr) {
+                    // draw highlight line
+                    ColoredLines.emplace_back(
+                        std::move(
+                            BaseOverlay::ColoredLine{ 
+                                BaseOverlay::GetPointForAction(ctx, *prevAction),
+                                point,
+                                SelectedLineColor
+                            })
+                    );
+                }
+
+                prevAction = &action;
+            });
     }
 }
 
@@ -324,14 +322,13 @@ void BaseOverlay::DrawActionPoints(const OverlayDrawingCtx& ctx) noexcept
 
         if(drawingScript->HasSelection())
         {
-            auto startIt = drawingScript->Selection().begin() + ctx.selectionFromIdx;
-            auto endIt = drawingScript->Selection().begin() + ctx.selectionToIdx;
-            for (; startIt != endIt; ++startIt) 
-            {
-                auto p = BaseOverlay::GetPointForAction(ctx, *startIt);
-                const auto selectedDots = IM_COL32(11, 252, 3, opcacityInt);
-			    ctx.drawList->AddCircleFilled(p, BaseOverlay::PointSize * 0.7f, selectedDots, 4);
-            }
+            drawingScript->Selection().forEachSet(ctx.actionFromIdx, ctx.actionToIdx,
+                [&](std::size_t idx) noexcept
+                {
+                    auto p = BaseOverlay::GetPointForAction(ctx, drawingScript->Actions()[idx]);
+                    const auto selectedDots = IM_COL32(11, 252, 3, opcacityInt);
+                    ctx.drawList->AddCircleFilled(p, BaseOverlay::PointSize * 0.7f, selectedDots, 4);
+                });
         }
     }
 }
@@ -367,6 +364,46 @@ void BaseOverlay::DrawHeightLines(const OverlayDrawingCtx& ctx) noexcept
     }
 }
 
+void BaseOverlay::DrawSpeedStrip(const OverlayDrawingCtx& ctx) noexcept
+{
+    OFS_PROFILE(__FUNCTION__);
+    if (ctx.activeSpeeds == nullptr || ctx.activeSpeeds->TotalDuration() <= 0.f || ctx.canvasSize.x <= 0.f) return;
+    auto& speeds = *ctx.activeSpeeds;
+    auto& state = State();
+
+    // about one sample per pixel no matter how far the timeline is zoomed
+    auto level = speeds.LevelForPixel(ctx.visibleTime / ctx.canvasSize.x);
+    auto means = speeds.Means(level);
+    auto maxima = speeds.Maxima(level);
+    float sampleDuration = speeds.SampleDuration(level);
+
+    auto firstIdx = (int64_t)std::floor(ctx.offsetTime / sampleDuration);
+    auto lastIdx = (int64_t)std::ceil((ctx.offsetTime + ctx.visibleTime) / sampleDuration);
+    firstIdx = Util::Clamp<int64_t>(firstIdx, 0, means.size());
+    lastIdx = Util::Clamp<int64_t>(lastIdx, 0, means.size());
+
+    const float stripHeight = ImGui::GetFontSize() / 2.f;
+    const float bottom = ctx.canvasPos.y + ctx.canvasSize.y;
+    auto timeToX = [&ctx](float time) noexcept {
+        float x = ctx.canvasPos.x + ((time - ctx.offsetTime) / ctx.visibleTime) * ctx.canvasSize.x;
+        return Util::Clamp(x, ctx.canvasPos.x, ctx.canvasPos.x + ctx.canvasSize.x);
+    };
+
+    for (auto i = firstIdx; i < lastIdx; i += 1) {
+        float x1 = timeToX(i * sampleDuration);
+        float x2 = timeToX((i + 1) * sampleDuration);
+        ImColor color;
+        FunscriptHeatmap::Colors.getColorAt(Util::Clamp(means[i] / FunscriptHeatmap::MaxSpeedPerSecond, 0.f, 1.f), &color.Value.x);
+        color.Value.w = 1.f;
+        ctx.drawList->AddRectFilled(ImVec2(x1, bottom - stripHeight), ImVec2(x2, bottom), ImGui::ColorConvertFloat4ToU32(color));
+
+        // the mean hides short bursts, the maximum still shows them
+        if (state.ShowMaxSpeedHighlight && maxima[i] >= state.MaxSpeedPerSecond) {
+            ctx.drawList->AddRectFilled(ImVec2(x1, bottom - stripHeight - 2.f), ImVec2(x2, bottom - stripHeight), state.MaxSpeedColor);
+        }
+    }
+}
+
 void BaseOverlay::DrawScriptLabel(const OverlayDrawingCtx& ctx) noexcept
 {
     OFS_PROFILE(__FUNCTION__);
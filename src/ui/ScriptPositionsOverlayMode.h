@@ -3,6 +3,7 @@
 #include "ui/OFS_ScriptTimeline.h"
 #include "Funscript/Funscript.h"
 #include "Funscript/FunscriptAction.h"
+#include "Funscript/FunscriptSpeedPyramid.h"
 #include "state/states/BaseOverlayState.h"
 
 #include <imgui.h>
@@ -32,9 +33,6 @@ struct OverlayDrawingCtx
 	std::int32_t actionFromIdx;
 	std::int32_t actionToIdx;
 
-	std::int32_t selectionFromIdx;
-	std::int32_t selectionToIdx;
-
 	ImDrawList* drawList;
 
 	ImVec2 canvasPos;
@@ -42,6 +40,9 @@ struct OverlayDrawingCtx
 	float visibleTime;
 	float offsetTime;
 	float totalDuration;
+
+	// speeds of the active script, may be null
+	const OFS::funscript::SpeedPyramid* activeSpeeds;
 };
 
 class BaseOverlay
@@ -88,6 +89,7 @@ public:
 	static void DrawSecondsLabel(const OverlayDrawingCtx& ctx) noexcept;
 	static void DrawHeightLines(const OverlayDrawingCtx& ctx) noexcept;
 	static void DrawScriptLabel(const OverlayDrawingCtx& ctx) noexcept;
+	static void DrawSpeedStrip(const OverlayDrawingCtx& ctx) noexcept;
 
 	static ImVec2 GetPointForAction(const OverlayDrawingCtx& ctx, FunscriptAction action) noexcept;
 };
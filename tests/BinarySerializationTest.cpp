@@ -0,0 +1,165 @@
+#include "OFS_Test.h"
+#include "Funscript/Funscript.h"
+#include "io/OFS_BinarySerialization.h"
+
+#include <vector>
+#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Round trips through OFS_Binary and the rejection of broken payloads.
+namespace
+{
+    struct ActionBlock
+    {
+        std::vector<FunscriptAction> actions;
+
+        constexpr static auto serialize(auto& archive, auto& self) noexcept
+        {
+            return OFS_Binary::Block(archive, self.actions);
+        }
+    };
+
+    // same layout as a block, but with any byte count
+    struct RawBlock
+    {
+        std::vector<std::byte> bytes;
+
+        constexpr static auto serialize(auto& archive, auto& self) noexcept
+        {
+            return archive(self.bytes);
+        }
+    };
+
+    FunscriptArray makeActions(std::size_t count) noexcept
+    {
+        std::mt19937 rng(1234);
+        FunscriptArray actions;
+        std::uint32_t at = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            at += 1 + rng() % 500;
+            actions.emplace_back_unsorted(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101), (std::uint8_t)(rng() % 4)));
+        }
+        return actions;
+    }
+
+    // the same as OFS_Project does it, the buffer is cut to the written size
+    template<typename T>
+    ByteBuffer save(T& obj) noexcept
+    {
+        ByteBuffer buffer;
+        auto written = OFS_Binary::Serialize(buffer, obj);
+        OFS_CHECK(written != 0 && written <= buffer.size());
+        buffer.resize(written);
+        return buffer;
+    }
+
+    bool sameActions(const FunscriptArray& a, const FunscriptArray& b) noexcept
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(FunscriptAction)) == 0);
+    }
+
+    void testBlock() noexcept
+    {
+        for (std::size_t size : { 0, 1, 1000 }) {
+            ActionBlock saved;
+            auto actions = makeActions(size);
+            saved.actions.assign(actions.begin(), actions.end());
+
+            auto buffer = save(saved);
+            ActionBlock loaded;
+            OFS_CHECK(OFS_Binary::Deserialize(buffer, loaded));
+            OFS_CHECK(loaded.actions.size() == saved.actions.size());
+            OFS_CHECK(loaded.actions.empty() || std::memcmp(loaded.actions.data(), saved.actions.data(), saved.actions.size() * sizeof(FunscriptAction)) == 0);
+        }
+
+        // a byte count which isn't a multiple of the action size can't be loaded
+        RawBlock odd;
+        odd.bytes.resize(3 * sizeof(FunscriptAction) + 3);
+        auto buffer = save(odd);
+        ActionBlock loaded;
+        OFS_CHECK(!OFS_Binary::Deserialize(buffer, loaded));
+
+        // neither can a block which is longer than the buffer
+        ActionBlock saved;
+        saved.actions.resize(10);
+        buffer = save(saved);
+        buffer.pop_back();
+        OFS_CHECK(!OFS_Binary::Deserialize(buffer, loaded));
+    }
+
+    void testHeader() noexcept
+    {
+        ActionBlock saved;
+        saved.actions.resize(4);
+        auto buffer = save(saved);
+
+        // magic then version, both little endian uint32
+        std::uint32_t magic, version;
+        std::memcpy(&magic, buffer.data(), sizeof(magic));
+        std::memcpy(&version, buffer.data() + sizeof(magic), sizeof(version));
+        OFS_CHECK(magic == OFS_Binary::Magic);
+        OFS_CHECK(version == OFS_Binary::Version);
+
+        ActionBlock loaded;
+        auto broken = buffer;
+        broken[0] ^= 0xff;
+        OFS_CHECK(!OFS_Binary::Deserialize(broken, loaded));
+
+        for (auto otherVersion : { OFS_Binary::Version - 1, OFS_Binary::Version + 1 }) {
+            broken = buffer;
+            std::memcpy(broken.data() + sizeof(magic), &otherVersion, sizeof(otherVersion));
+            OFS_CHECK(!OFS_Binary::Deserialize(broken, loaded));
+        }
+
+        ByteBuffer empty;
+        OFS_CHECK(!OFS_Binary::Deserialize(empty, loaded));
+        OFS_CHECK(OFS_Binary::Deserialize(buffer, loaded));
+    }
+
+    void testFunscript() noexcept
+    {
+        Funscript saved;
+        OFS_CHECK(saved.Deserialize(R"({"actions":[{"at":0,"pos":0}],"metadata":{"creator":"test","custom":[1,2]},"unknown":{"a":true}})", nullptr, false));
+        auto actions = makeActions(5000);
+        saved.SetActions(actions);
+        FunscriptArray selection;
+        for (std::size_t i = 0; i < actions.size(); i += 3) selection.emplace_back_unsorted(actions[i]);
+        saved.SetSelection(selection);
+        saved.UpdateRelativePath("scripts/test.funscript");
+        saved.Enabled = false;
+
+        auto buffer = save(saved);
+        Funscript loaded;
+        OFS_CHECK(OFS_Binary::Deserialize(buffer, loaded));
+
+        OFS_CHECK(sameActions(loaded.Actions(), saved.Actions()));
+        OFS_CHECK(loaded.Selection().size() == saved.Selection().size());
+        OFS_CHECK(loaded.Selection().words() == saved.Selection().words());
+        OFS_CHECK(loaded.RelativePath() == saved.RelativePath());
+        OFS_CHECK(loaded.Enabled == saved.Enabled);
+        auto savedSnapshot = saved.TakeSaveSnapshot();
+        auto loadedSnapshot = loaded.TakeSaveSnapshot();
+        OFS_CHECK(loadedSnapshot.UnknownFieldsJSON == savedSnapshot.UnknownFieldsJSON);
+        OFS_CHECK(loadedSnapshot.UnknownFieldsJSON.contains("unknown"));
+        OFS_CHECK(loadedSnapshot.UnknownMetadataFieldsJSON == savedSnapshot.UnknownMetadataFieldsJSON);
+        OFS_CHECK(loadedSnapshot.UnknownMetadataFieldsJSON.contains("custom"));
+
+        // an empty script
+        Funscript emptySaved;
+        buffer = save(emptySaved);
+        Funscript emptyLoaded;
+        OFS_CHECK(OFS_Binary::Deserialize(buffer, emptyLoaded));
+        OFS_CHECK(emptyLoaded.Actions().empty());
+        OFS_CHECK(emptyLoaded.Selection().size() == 0);
+    }
+}
+
+int main()
+{
+    testBlock();
+    testHeader();
+    testFunscript();
+    return OFS_TEST_RESULT();
+}
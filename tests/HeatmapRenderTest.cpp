@@ -0,0 +1,198 @@
+#include "OFS_Test.h"
+#include "Funscript/FunscriptHeatmapRender.h"
+#include "Funscript/FunscriptSpeedPyramid.h"
+
+#include <span>
+#include <array>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+// renderHeatmap against a double precision model of the heatmap shader, and the
+// incremental speed updates behind FunscriptHeatmap::UpdateRange against a full rebuild.
+// The GL path itself needs a context and isn't covered here.
+namespace
+{
+    // written from the fragment shader in src/funscript/FunscriptHeatmap.cpp, not from renderHeatmap
+    std::array<double, 3> shaderColor(std::span<const float> speeds, double u, double v) noexcept
+    {
+        static constexpr double Colors[6][3] = {
+            { 0.0, 0.0, 0.0 },
+            { 30.0 / 255.0, 144.0 / 255.0, 1.0 },
+            { 0.0, 1.0, 1.0 },
+            { 0.0, 1.0, 0.0 },
+            { 1.0, 1.0, 0.0 },
+            { 1.0, 0.0, 0.0 },
+        };
+        // texture() with GL_LINEAR and GL_CLAMP_TO_EDGE
+        double speed = 0.0;
+        if (!speeds.empty()) {
+            double texel = u * speeds.size() - 0.5;
+            double base = std::floor(texel);
+            auto at = [speeds](double i) noexcept { return (double)speeds[(std::size_t)std::clamp(i, 0.0, (double)speeds.size() - 1.0)]; };
+            speed = at(base) + (at(base + 1.0) - at(base)) * (texel - base);
+        }
+        // RAMP(), x == 1 would read colors[6] in the shader, the last color is what the texture clamp gives for it
+        double x = std::clamp(speed, 0.0, 1.0) * 5.0;
+        int idx = std::min((int)x, 4);
+        double t = x - idx;
+        double smooth = t * t * (3.0 - 2.0 * t);
+        std::array<double, 3> color;
+        for (int c = 0; c < 3; ++c) {
+            // the vertical fade, Frag_UV.y is 0 at the top
+            color[c] = (Colors[idx][c] + (Colors[idx + 1][c] - Colors[idx][c]) * smooth) * v;
+        }
+        return color;
+    }
+
+    void checkPixels(std::span<const float> speeds, std::uint32_t width, std::uint32_t height) noexcept
+    {
+        std::vector<std::uint8_t> bitmap;
+        OFS::funscript::renderHeatmap(speeds, width, height, bitmap);
+        OFS_CHECK(bitmap.size() == (std::size_t)width * height * 4);
+        if (bitmap.size() != (std::size_t)width * height * 4) return;
+
+        int worst = 0;
+        for (std::uint32_t y = 0; y < height; ++y) {
+            for (std::uint32_t x = 0; x < width; ++x) {
+                auto expected = shaderColor(speeds, (x + 0.5) / width, (y + 0.5) / height);
+                auto pixel = bitmap.data() + ((std::size_t)y * width + x) * 4;
+                for (int c = 0; c < 3; ++c) {
+                    worst = std::max(worst, std::abs((int)pixel[c] - (int)std::lround(expected[c] * 255.0)));
+                }
+                OFS_CHECK(pixel[3] == 255);
+            }
+        }
+        // float against double rounding may land on the neighbouring value, nothing more
+        OFS_CHECK(worst <= 1);
+    }
+
+    void testRender() noexcept
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        std::vector<float> random(OFS::funscript::HeatmapSpeedResolution);
+        for (auto& speed : random) speed = unit(rng);
+        // the ramp knots, both ends and values outside of 0..1
+        std::vector<float> edges{ 0.f, 0.2f, 0.4f, 0.6f, 0.8f, 1.f, -0.5f, 1.5f, 0.5f, 0.9999f };
+        std::vector<float> single{ 0.7f };
+        std::vector<float> none;
+
+        // widths which aren't a multiple of the 4 columns the AVX2 path handles at once
+        for (auto size : { std::pair{ 2000u, 50u }, std::pair{ 1u, 1u }, std::pair{ 7u, 3u }, std::pair{ 4097u, 2u } }) {
+            checkPixels(random, size.first, size.second);
+            checkPixels(edges, size.first, size.second);
+            checkPixels(single, size.first, size.second);
+            checkPixels(none, size.first, size.second);
+        }
+
+        std::vector<std::uint8_t> bitmap{ 1, 2, 3 };
+        OFS::funscript::renderHeatmap(random, 0, 10, bitmap);
+        OFS_CHECK(bitmap.empty());
+    }
+
+    bool near(double a, double b) noexcept
+    {
+        return std::abs(a - b) <= 1e-4 * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+    }
+
+    void checkSame(const OFS::funscript::SpeedPyramid& updated, const OFS::funscript::SpeedPyramid& rebuilt) noexcept
+    {
+        OFS_CHECK(updated.LevelCount() == rebuilt.LevelCount());
+        for (std::uint32_t level = 0; level < std::min(updated.LevelCount(), rebuilt.LevelCount()); ++level) {
+            auto means = updated.Means(level), expectedMeans = rebuilt.Means(level);
+            auto maxima = updated.Maxima(level), expectedMaxima = rebuilt.Maxima(level);
+            OFS_CHECK(means.size() == expectedMeans.size());
+            bool same = true;
+            for (std::size_t i = 0; i < std::min(means.size(), expectedMeans.size()); ++i) {
+                same = same && near(means[i], expectedMeans[i]) && near(maxima[i], expectedMaxima[i]);
+            }
+            OFS_CHECK(same);
+        }
+    }
+
+    // FunscriptHeatmap::updateTextureSpeeds, only the samples in the returned range are written
+    void updateTexture(const OFS::funscript::SpeedPyramid& speeds, OFS::funscript::SpeedProfile::SampleRange range, std::vector<float>& texture) noexcept
+    {
+        auto level = speeds.LevelForResolution(OFS::funscript::HeatmapSpeedResolution);
+        auto means = speeds.Means(level);
+        auto [first, last] = speeds.LevelRange(level, range);
+        for (auto i = first; i < last && i < texture.size(); i += 1) {
+            texture[i] = std::clamp(means[i] / OFS::funscript::HeatmapMaxSpeedPerSecond, 0.f, 1.f);
+        }
+    }
+
+    void testIncremental() noexcept
+    {
+        using OFS::funscript::SpeedPyramid;
+        std::mt19937 rng(4321);
+        for (float duration : { 60.f, 1800.f, 7.5f * 3600.f }) {
+            auto durationMs = (std::uint32_t)(duration * 1000.f);
+            FunscriptArray actions;
+            for (std::uint32_t at = 0; at < durationMs; at += 50 + rng() % 2000) {
+                actions.emplace_back_unsorted(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101)));
+            }
+
+            SpeedPyramid updated(OFS::funscript::HeatmapSpeedResolution, OFS::funscript::HeatmapMaxSpeedPerSecond);
+            std::vector<float> texture(OFS::funscript::HeatmapSpeedResolution, 0.f);
+            updateTexture(updated, updated.Rebuild(duration, actions), texture);
+
+            for (int edit = 0; edit < 300; ++edit) {
+                std::uint32_t fromMs, toMs;
+                auto at = (std::uint32_t)(rng() % durationMs);
+                switch (rng() % 3) {
+                case 0: {
+                    fromMs = toMs = at;
+                    actions.emplace(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101)));
+                    break;
+                }
+                case 1: {
+                    if (actions.empty()) continue;
+                    auto it = actions.begin() + rng() % actions.size();
+                    fromMs = toMs = it->at;
+                    actions.erase(it);
+                    break;
+                }
+                default: {
+                    if (actions.empty()) continue;
+                    // moves a block of actions, like dragging a selection
+                    auto first = rng() % actions.size();
+                    auto last = std::min<std::size_t>(actions.size(), first + 1 + rng() % 20);
+                    auto offset = (std::int64_t)(rng() % 20000) - 10000;
+                    std::vector<FunscriptAction> moved(actions.begin() + first, actions.begin() + last);
+                    fromMs = moved.front().at;
+                    toMs = moved.back().at;
+                    actions.erase(actions.begin() + first, actions.begin() + last);
+                    for (auto action : moved) {
+                        action.at = FunscriptAction::OffsetMs(action.at, offset);
+                        fromMs = std::min(fromMs, action.at);
+                        toMs = std::max(toMs, action.at);
+                        actions.emplace(action);
+                    }
+                    break;
+                }
+                }
+                updateTexture(updated, updated.Update(actions, fromMs, toMs), texture);
+            }
+
+            SpeedPyramid rebuilt(OFS::funscript::HeatmapSpeedResolution, OFS::funscript::HeatmapMaxSpeedPerSecond);
+            std::vector<float> expectedTexture(OFS::funscript::HeatmapSpeedResolution, 0.f);
+            updateTexture(rebuilt, rebuilt.Rebuild(duration, actions), expectedTexture);
+            checkSame(updated, rebuilt);
+            bool same = true;
+            for (std::size_t i = 0; i < texture.size(); ++i) same = same && near(texture[i], expectedTexture[i]);
+            OFS_CHECK(same);
+        }
+    }
+}
+
+int main()
+{
+    testRender();
+    testIncremental();
+    return OFS_TEST_RESULT();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+
+// Minimal checks for the test executables, failed checks are printed and make OFS_TEST_RESULT() non zero.
+namespace OFS::test
+{
+    inline int failures = 0;
+
+    // set by ctest, benchmarks only check their results on small inputs then
+    inline bool quick() noexcept
+    {
+        return std::getenv("OFS_BENCHMARK_QUICK") != nullptr;
+    }
+
+    // keeps the optimizer from dropping the benchmarked work
+    inline volatile std::size_t sink = 0;
+    inline void keep(std::size_t value) noexcept { sink = value; }
+
+    // milliseconds per call, fn is called iterations times
+    template<typename Fn>
+    inline double measureMs(int iterations, Fn&& fn) noexcept
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) fn();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+}
+
+#define OFS_CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+            OFS::test::failures += 1; \
+        } \
+    } while (0)
+
+#define OFS_TEST_RESULT() (OFS::test::failures == 0 ? 0 : 1)
@@ -0,0 +1,124 @@
+#include "OFS_Test.h"
+#include "Funscript/Funscript.h"
+#include "io/OFS_BinarySerialization.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+// The binary project payload against the json and cbor files for a 10 axis project.
+namespace
+{
+    constexpr std::size_t AxisCount = 10;
+
+    struct Scripts
+    {
+        std::vector<std::unique_ptr<Funscript>> scripts;
+
+        constexpr static auto serialize(auto& archive, auto& self) noexcept
+        {
+            for (auto& script : self.scripts) {
+                if (auto result = archive(*script); zpp::bits::failure(result)) return result;
+            }
+            return zpp::bits::errc{};
+        }
+    };
+
+    Scripts makeScripts(std::size_t actionsPerAxis) noexcept
+    {
+        std::mt19937 rng(1234);
+        Scripts project;
+        for (std::size_t axis = 0; axis < AxisCount; ++axis) {
+            FunscriptArray actions;
+            actions.reserve(actionsPerAxis);
+            std::uint32_t at = 0;
+            for (std::size_t i = 0; i < actionsPerAxis; ++i) {
+                at += 50 + rng() % 500;
+                actions.emplace_back_unsorted(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101)));
+            }
+            auto& script = project.scripts.emplace_back(std::make_unique<Funscript>());
+            script->SetActions(actions);
+        }
+        return project;
+    }
+
+    Scripts emptyScripts() noexcept
+    {
+        Scripts project;
+        for (std::size_t axis = 0; axis < AxisCount; ++axis) project.scripts.emplace_back(std::make_unique<Funscript>());
+        return project;
+    }
+
+    bool sameActions(const Scripts& a, const Scripts& b) noexcept
+    {
+        for (std::size_t axis = 0; axis < AxisCount; ++axis) {
+            auto& x = a.scripts[axis]->Actions();
+            auto& y = b.scripts[axis]->Actions();
+            if (x.size() != y.size() || (!x.empty() && std::memcmp(x.data(), y.data(), x.size() * sizeof(FunscriptAction)) != 0)) return false;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    bool quick = OFS::test::quick();
+    std::size_t actionsPerAxis = quick ? 1000 : 50'000;
+    int iterations = quick ? 1 : 10;
+    auto project = makeScripts(actionsPerAxis);
+    Funscript::Metadata metadata;
+
+    ByteBuffer binary;
+    auto binaryLoaded = emptyScripts();
+    double binaryWriteMs = OFS::test::measureMs(iterations, [&]() noexcept {
+        binary.clear();
+        binary.resize(OFS_Binary::Serialize(binary, project));
+    });
+    double binaryReadMs = OFS::test::measureMs(iterations, [&]() noexcept {
+        OFS_CHECK(OFS_Binary::Deserialize(binary, binaryLoaded));
+    });
+    OFS_CHECK(sameActions(project, binaryLoaded));
+
+    std::vector<std::string> json(AxisCount);
+    auto jsonLoaded = emptyScripts();
+    double jsonWriteMs = OFS::test::measureMs(iterations, [&]() noexcept {
+        for (std::size_t axis = 0; axis < AxisCount; ++axis) Funscript::Serialize(json[axis], project.scripts[axis]->TakeSaveSnapshot(), metadata);
+    });
+    double jsonReadMs = OFS::test::measureMs(iterations, [&]() noexcept {
+        for (std::size_t axis = 0; axis < AxisCount; ++axis) OFS_CHECK(jsonLoaded.scripts[axis]->Deserialize(json[axis], nullptr, false));
+    });
+    OFS_CHECK(sameActions(project, jsonLoaded));
+
+    // the old project files went through json on both ends
+    std::vector<std::vector<char>> cbor(AxisCount);
+    auto cborLoaded = emptyScripts();
+    double cborWriteMs = OFS::test::measureMs(iterations, [&]() noexcept {
+        for (std::size_t axis = 0; axis < AxisCount; ++axis) {
+            Funscript::Serialize(json[axis], project.scripts[axis]->TakeSaveSnapshot(), metadata);
+            cbor[axis] = OFS::util::convertJSONtoCBOR(json[axis]);
+        }
+    });
+    double cborReadMs = OFS::test::measureMs(iterations, [&]() noexcept {
+        for (std::size_t axis = 0; axis < AxisCount; ++axis) {
+            auto converted = OFS::util::convertCBORtoJSON(cbor[axis]);
+            OFS_CHECK(cborLoaded.scripts[axis]->Deserialize(converted, nullptr, false));
+        }
+    });
+    OFS_CHECK(sameActions(project, cborLoaded));
+
+    std::size_t jsonBytes = 0, cborBytes = 0;
+    for (std::size_t axis = 0; axis < AxisCount; ++axis) {
+        jsonBytes += json[axis].size();
+        cborBytes += cbor[axis].size();
+    }
+    std::printf("%zu axes, %zu actions\n", AxisCount, AxisCount * actionsPerAxis);
+    std::printf("%8s %12s %12s %12s\n", "format", "bytes", "write (ms)", "read (ms)");
+    std::printf("%8s %12zu %12.2f %12.2f\n", "binary", binary.size(), binaryWriteMs, binaryReadMs);
+    std::printf("%8s %12zu %12.2f %12.2f\n", "json", jsonBytes, jsonWriteMs, jsonReadMs);
+    std::printf("%8s %12zu %12.2f %12.2f\n", "cbor", cborBytes, cborWriteMs, cborReadMs);
+    return OFS_TEST_RESULT();
+}
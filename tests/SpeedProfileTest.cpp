@@ -0,0 +1,187 @@
+#include "OFS_Test.h"
+#include "Funscript/FunscriptSpeedProfile.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+
+// SpeedProfile against the per sample, per stroke sums it replaced.
+namespace
+{
+    using OFS::funscript::SpeedProfile;
+
+    // every sample is compared with every stroke, O(samples * actions)
+    std::vector<double> bruteForce(float duration, std::uint32_t resolution, const FunscriptArray& actions) noexcept
+    {
+        std::vector<double> averages(resolution, 0.0);
+        if (duration <= 0.f) return averages;
+        double sampleMs = duration * 1000.0 / resolution;
+        for (std::uint32_t x = 0; x < resolution; ++x) {
+            double sampleStart = x * sampleMs;
+            double sampleEnd = (x + 1) * sampleMs;
+            double speedSum = 0.0;
+            double coverage = 0.0;
+            for (std::size_t i = 0; i + 1 < actions.size(); ++i) {
+                double covered = std::min<double>(sampleEnd, actions[i + 1].at) - std::max<double>(sampleStart, actions[i].at);
+                if (covered <= 0.0) continue;
+                double speed = std::abs(actions[i].pos - actions[i + 1].pos) / ((actions[i + 1].at - actions[i].at) / 1000.0);
+                speedSum += speed * covered;
+                coverage += covered;
+            }
+            averages[x] = coverage > 0.0 ? speedSum / coverage : 0.0;
+        }
+        return averages;
+    }
+
+    bool near(double a, double b) noexcept
+    {
+        return std::abs(a - b) <= 1e-4 * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+    }
+
+    void checkProfile(const SpeedProfile& profile, float duration, const FunscriptArray& actions, float maxSpeed) noexcept
+    {
+        auto expected = bruteForce(duration, profile.Resolution(), actions);
+        auto averages = profile.Averages();
+        auto speeds = profile.Speeds();
+        bool same = averages.size() == expected.size();
+        for (std::size_t x = 0; same && x < expected.size(); ++x) {
+            same = near(averages[x], expected[x])
+                && near(speeds[x], std::clamp(expected[x] / maxSpeed, 0.0, 1.0));
+        }
+        OFS_CHECK(same);
+    }
+
+    FunscriptArray makeActions(std::mt19937& rng, std::uint32_t fromMs, std::uint32_t toMs, std::uint32_t maxGapMs) noexcept
+    {
+        FunscriptArray actions;
+        for (std::uint32_t at = fromMs; at < toMs; at += 1 + rng() % maxGapMs) {
+            actions.emplace_back_unsorted(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101)));
+        }
+        return actions;
+    }
+
+    void testEdgeCases() noexcept
+    {
+        constexpr float MaxSpeed = 400.f;
+        SpeedProfile profile(64, MaxSpeed);
+
+        FunscriptArray empty;
+        profile.Rebuild(10.f, empty);
+        checkProfile(profile, 10.f, empty, MaxSpeed);
+
+        FunscriptArray single;
+        single.emplace_back_unsorted(FunscriptAction::FromMs(5000, 50));
+        profile.Rebuild(10.f, single);
+        checkProfile(profile, 10.f, single, MaxSpeed);
+
+        // a stroke inside one sample, one across sample borders and one ending exactly on a border
+        FunscriptArray inside;
+        for (auto [at, pos] : { std::pair{ 100u, 0 }, std::pair{ 120u, 100 }, std::pair{ 1700u, 0 }, std::pair{ 2500u, 100 } }) {
+            inside.emplace_back_unsorted(FunscriptAction::FromMs(at, pos));
+        }
+        profile.Rebuild(10.f, inside);
+        checkProfile(profile, 10.f, inside, MaxSpeed);
+
+        // strokes reaching past either end are clipped, strokes past the end are ignored
+        FunscriptArray outside;
+        for (auto [at, pos] : { std::pair{ 0u, 0 }, std::pair{ 2000u, 100 }, std::pair{ 9000u, 0 }, std::pair{ 12000u, 100 }, std::pair{ 15000u, 0 } }) {
+            outside.emplace_back_unsorted(FunscriptAction::FromMs(at, pos));
+        }
+        profile.Rebuild(10.f, outside);
+        checkProfile(profile, 10.f, outside, MaxSpeed);
+
+        // every action past the end
+        FunscriptArray after;
+        after.emplace_back_unsorted(FunscriptAction::FromMs(20000, 0));
+        after.emplace_back_unsorted(FunscriptAction::FromMs(21000, 100));
+        profile.Rebuild(10.f, after);
+        checkProfile(profile, 10.f, after, MaxSpeed);
+
+        // no duration, every sample stays empty
+        auto range = profile.Rebuild(0.f, inside);
+        OFS_CHECK(range.first == 0 && range.second == profile.Resolution());
+        checkProfile(profile, 0.f, inside, MaxSpeed);
+        OFS_CHECK((profile.Update(inside, 0, 1000) == SpeedProfile::SampleRange{ 0, 0 }));
+
+        // faster than maxSpeed is clamped to 1
+        FunscriptArray fast;
+        fast.emplace_back_unsorted(FunscriptAction::FromMs(1000, 0));
+        fast.emplace_back_unsorted(FunscriptAction::FromMs(1010, 100));
+        profile.Rebuild(10.f, fast);
+        checkProfile(profile, 10.f, fast, MaxSpeed);
+        OFS_CHECK(*std::max_element(profile.Speeds().begin(), profile.Speeds().end()) == 1.f);
+
+        // a single sample
+        SpeedProfile coarse(1, MaxSpeed);
+        coarse.Rebuild(10.f, outside);
+        checkProfile(coarse, 10.f, outside, MaxSpeed);
+    }
+
+    void testRandom() noexcept
+    {
+        std::mt19937 rng(1234);
+        for (auto resolution : { 7u, 2048u }) {
+            for (float duration : { 1.f, 60.f, 3600.f }) {
+                auto durationMs = (std::uint32_t)(duration * 1000.f);
+                // some actions before the start can't exist, but some after the end do
+                auto actions = makeActions(rng, 0, durationMs + durationMs / 4, std::max(2u, durationMs / 500));
+                SpeedProfile profile(resolution, 400.f);
+                profile.Rebuild(duration, actions);
+                checkProfile(profile, duration, actions, 400.f);
+            }
+        }
+    }
+
+    void testUpdate() noexcept
+    {
+        std::mt19937 rng(4321);
+        constexpr float Duration = 120.f;
+        constexpr std::uint32_t DurationMs = 120'000;
+        auto actions = makeActions(rng, 0, DurationMs + 5000, 3000);
+        SpeedProfile profile(2048, 400.f);
+        profile.Rebuild(Duration, actions);
+
+        for (int edit = 0; edit < 500; ++edit) {
+            // edits past the end have to leave the profile alone
+            auto at = (std::uint32_t)(rng() % (DurationMs + 10000));
+            std::uint32_t fromMs = at, toMs = at;
+            if (rng() % 2 == 0 || actions.empty()) {
+                actions.emplace(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101)));
+            }
+            else {
+                auto it = actions.begin() + rng() % actions.size();
+                fromMs = toMs = it->at;
+                if (rng() % 2 == 0) {
+                    actions.erase(it);
+                }
+                else {
+                    auto moved = FunscriptAction::FromMs(FunscriptAction::OffsetMs(it->at, (std::int64_t)(rng() % 6000) - 3000), it->pos);
+                    actions.erase(it);
+                    actions.emplace(moved);
+                    fromMs = std::min(fromMs, moved.at);
+                    toMs = std::max(toMs, moved.at);
+                }
+            }
+            auto [first, last] = profile.Update(actions, fromMs, toMs);
+            OFS_CHECK(first <= last && last <= profile.Resolution());
+        }
+        checkProfile(profile, Duration, actions, 400.f);
+
+        SpeedProfile rebuilt(2048, 400.f);
+        rebuilt.Rebuild(Duration, actions);
+        bool same = true;
+        for (std::size_t x = 0; x < rebuilt.Averages().size(); ++x) same = same && near(profile.Averages()[x], rebuilt.Averages()[x]);
+        OFS_CHECK(same);
+    }
+}
+
+int main()
+{
+    testEdgeCases();
+    testRandom();
+    testUpdate();
+    return OFS_TEST_RESULT();
+}
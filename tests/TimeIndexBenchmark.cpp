@@ -0,0 +1,91 @@
+#include "OFS_Test.h"
+#include "Funscript/FunscriptTimeIndex.h"
+
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+
+// FunscriptTimeIndex against the std::lower_bound search of vector_set it sits in front of.
+namespace
+{
+    FunscriptArray makeActions(std::size_t count, std::mt19937& rng) noexcept
+    {
+        FunscriptArray actions;
+        actions.reserve(count);
+        std::uint32_t at = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            at += 1 + rng() % 200;
+            actions.emplace_back_unsorted(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101)));
+        }
+        return actions;
+    }
+
+    std::size_t referenceLowerBound(const FunscriptArray& actions, std::uint32_t atMs) noexcept
+    {
+        return std::distance(actions.begin(), actions.lower_bound(FunscriptAction::FromMs(atMs, 0)));
+    }
+
+    void checkQueries(const FunscriptArray& actions, FunscriptTimeIndex& index, std::mt19937& rng) noexcept
+    {
+        std::vector<std::uint32_t> queries{ 0, 1, UINT32_MAX - 1, UINT32_MAX };
+        for (auto action : actions) {
+            queries.emplace_back(action.at - 1);
+            queries.emplace_back(action.at);
+            queries.emplace_back(action.at + 1);
+        }
+        std::uint32_t end = actions.empty() ? 1000 : actions.back().at + 1000;
+        for (int i = 0; i < 1000; ++i) queries.emplace_back(rng() % end);
+
+        for (auto query : queries) {
+            auto expected = referenceLowerBound(actions, query);
+            OFS_CHECK(index.LowerBound(actions, query) == expected);
+            auto expectedUpper = std::distance(actions.begin(), std::upper_bound(actions.begin(), actions.end(), query,
+                [](std::uint32_t ms, auto action) noexcept { return ms < action.at; }));
+            OFS_CHECK(index.UpperBound(actions, query) == (std::size_t)expectedUpper);
+        }
+    }
+}
+
+int main()
+{
+    bool quick = OFS::test::quick();
+    std::mt19937 rng(1234);
+
+    // both sides of the size below which the index isn't used, and the complete and partial last levels of the tree
+    for (std::size_t size : { 0, 1, 2, 3, 100, 4095, 4096, 4097, 8191, 8192, 10'000 }) {
+        auto actions = makeActions(size, rng);
+        FunscriptTimeIndex index;
+        checkQueries(actions, index, rng);
+
+        // a stale index must not be used after Invalidate
+        actions.emplace_back_unsorted(FunscriptAction::FromMs(actions.empty() ? 10 : actions.back().at + 10, 0));
+        index.Invalidate();
+        checkQueries(actions, index, rng);
+    }
+    if (quick) return OFS_TEST_RESULT();
+
+    constexpr int QueryCount = 1'000'000;
+    std::printf("%10s %22s %16s\n", "actions", "std::lower_bound (ns)", "eytzinger (ns)");
+    for (std::size_t size : { 10'000, 100'000, 1'000'000, 10'000'000 }) {
+        auto actions = makeActions(size, rng);
+        std::vector<std::uint32_t> queries(QueryCount);
+        for (auto& query : queries) query = rng() % (actions.back().at + 1);
+
+        FunscriptTimeIndex index;
+        index.LowerBound(actions, 0);
+        double referenceMs = OFS::test::measureMs(1, [&]() noexcept {
+            std::size_t sum = 0;
+            for (auto query : queries) sum += referenceLowerBound(actions, query);
+            OFS::test::keep(sum);
+        });
+        double indexMs = OFS::test::measureMs(1, [&]() noexcept {
+            std::size_t sum = 0;
+            for (auto query : queries) sum += index.LowerBound(actions, query);
+            OFS::test::keep(sum);
+        });
+        std::printf("%10zu %22.1f %16.1f\n", size, referenceMs * 1e6 / QueryCount, indexMs * 1e6 / QueryCount);
+    }
+    return OFS_TEST_RESULT();
+}
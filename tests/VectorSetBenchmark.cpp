@@ -0,0 +1,92 @@
+#include "OFS_Test.h"
+#include "OFS_BitSet.h"
+#include "Funscript/FunscriptAction.h"
+
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdint>
+
+// vector_set::for_each_match against the per element lookups it replaced in
+// Funscript::RemoveActions and Funscript::SetSelection.
+namespace
+{
+    struct Input
+    {
+        FunscriptArray actions;
+        // every action with probability 1/2, some with a different pos which must not match
+        FunscriptArray subset;
+    };
+
+    Input makeInput(std::size_t count) noexcept
+    {
+        Input input;
+        std::mt19937 rng(1234);
+        std::uint32_t at = 0;
+        input.actions.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            at += 1 + rng() % 200;
+            input.actions.emplace_back_unsorted(FunscriptAction::FromMs(at, (std::int32_t)(rng() % 101)));
+            if (rng() % 2 == 0) {
+                auto action = input.actions.back();
+                if (rng() % 16 == 0) action.pos = (std::uint8_t)((action.pos + 1) % 101);
+                input.subset.emplace_back_unsorted(action);
+            }
+        }
+        return input;
+    }
+
+    // the old RemoveActions, one binary search into the subset per action
+    void findEach(Input const& input, bit_set& out) noexcept
+    {
+        out.assign(input.actions.size(), false);
+        for (std::size_t i = 0; i < input.actions.size(); ++i) {
+            if (input.subset.find(input.actions[i]) != input.subset.end()) out.set(i);
+        }
+    }
+
+    void mergeMatch(Input const& input, bit_set& out) noexcept
+    {
+        out.assign(input.actions.size(), false);
+        input.actions.for_each_match(input.subset.begin(), input.subset.end(),
+            [&out](std::size_t idx) noexcept { out.set(idx); });
+    }
+
+    // the old SetSelection, a vector_set built with one emplace per element
+    std::size_t emplaceEach(Input const& input) noexcept
+    {
+        FunscriptArray selection;
+        for (auto it = input.subset.rbegin(); it != input.subset.rend(); ++it) selection.emplace(*it);
+        return selection.size();
+    }
+}
+
+int main()
+{
+    bool quick = OFS::test::quick();
+    std::vector<std::size_t> sizes = quick ? std::vector<std::size_t>{ 0, 1, 1000 } : std::vector<std::size_t>{ 10'000, 100'000, 1'000'000 };
+
+    std::printf("%10s %16s %16s %20s\n", "actions", "find each (ms)", "merge (ms)", "emplace each (ms)");
+    for (auto size : sizes) {
+        auto input = makeInput(size);
+        bit_set expected, merged;
+        findEach(input, expected);
+        mergeMatch(input, merged);
+        OFS_CHECK(expected.size() == merged.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) OFS_CHECK(expected.test(i) == merged.test(i));
+        if (quick) continue;
+
+        int iterations = (int)(10'000'000 / size);
+        double findMs = OFS::test::measureMs(iterations, [&]() noexcept { findEach(input, expected); OFS::test::keep(expected.count()); });
+        double mergeMs = OFS::test::measureMs(iterations, [&]() noexcept { mergeMatch(input, merged); OFS::test::keep(merged.count()); });
+        // quadratic, a million elements would take minutes
+        if (size <= 100'000) {
+            double emplaceMs = OFS::test::measureMs(1, [&]() noexcept { OFS::test::keep(emplaceEach(input)); });
+            std::printf("%10zu %16.3f %16.3f %20.3f\n", size, findMs, mergeMs, emplaceMs);
+        }
+        else {
+            std::printf("%10zu %16.3f %16.3f %20s\n", size, findMs, mergeMs, "-");
+        }
+    }
+    return OFS_TEST_RESULT();
+}